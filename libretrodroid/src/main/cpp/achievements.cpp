@@ -16,20 +16,25 @@
  */
 
 #include "achievements.h"
-#include "libretrodroid.h"
+#include "core.h"
 #include "log.h"
 
+#include <algorithm>
+
 #include <rc_runtime.h>
 #include <rc_runtime_types.h>
 
 namespace libretrodroid {
 
-static Core* g_core = nullptr;
+// rc_runtime_do_frame and rc_libretro_memory_init give their callbacks no user data, so these reach
+// the instance making the call. Thread local, as sessions on other threads may be evaluating too.
+static thread_local Achievements* g_evaluating = nullptr;
+static thread_local Core* g_initializingCore = nullptr;
 
 static void getCoreMemoryInfo(uint32_t id, rc_libretro_core_memory_info_t* info) {
-    if (!g_core || !info) return;
-    info->data = static_cast<uint8_t*>(g_core->retro_get_memory_data(id));
-    info->size = g_core->retro_get_memory_size(id);
+    if (!g_initializingCore || !info) return;
+    info->data = static_cast<uint8_t*>(g_initializingCore->retro_get_memory_data(id));
+    info->size = g_initializingCore->retro_get_memory_size(id);
 }
 
 void Achievements::init(const std::vector<AchievementDef>& achievements) {
@@ -82,12 +87,14 @@ void Achievements::initMemory(uint32_t consoleId, const struct retro_memory_map*
         memoryInitialized = false;
     }
 
+    g_initializingCore = core;
     int result = rc_libretro_memory_init(
         &memoryRegions,
         mmap,
         getCoreMemoryInfo,
         consoleId
     );
+    g_initializingCore = nullptr;
 
     memoryInitialized = (result == 1);
 
@@ -99,11 +106,8 @@ void Achievements::initMemory(uint32_t consoleId, const struct retro_memory_map*
     }
 }
 
-static int frameCounter = 0;
-static bool firstEvalLogged = false;
-
 void Achievements::evaluateFrame() {
-    if (!active || !runtime || !g_core) return;
+    if (!active || !runtime || !core) return;
 
     auto* rt = static_cast<rc_runtime_t*>(runtime);
 
@@ -123,15 +127,15 @@ void Achievements::evaluateFrame() {
 
     triggeredIds.clear();
 
+    g_evaluating = this;
     rc_runtime_do_frame(
         static_cast<rc_runtime_t*>(runtime),
         [](const rc_runtime_event_t* event) {
             // Log all event types for debugging
             if (event->type == RC_RUNTIME_EVENT_ACHIEVEMENT_TRIGGERED) {
                 LOGI("Achievement TRIGGERED: %u", event->id);
-                auto& ach = LibretroDroid::getInstance().getAchievements();
-                ach.queueUnlock(event->id);
-                ach.markTriggered(event->id);
+                g_evaluating->queueUnlock(event->id);
+                g_evaluating->markTriggered(event->id);
             } else if (event->type == RC_RUNTIME_EVENT_ACHIEVEMENT_ACTIVATED) {
                 LOGI("Achievement activated: %u", event->id);
             } else if (event->type == RC_RUNTIME_EVENT_ACHIEVEMENT_PAUSED) {
@@ -145,9 +149,10 @@ void Achievements::evaluateFrame() {
             }
         },
         &Achievements::peekMemory,
-        nullptr,
+        this,
         nullptr
     );
+    g_evaluating = nullptr;
 
     for (uint32_t id : triggeredIds) {
         rc_runtime_deactivate_achievement(rt, id);
@@ -155,18 +160,16 @@ void Achievements::evaluateFrame() {
     }
 }
 
-static int peekLogCounter = 0;
-
 uint32_t Achievements::peekMemory(uint32_t address, uint32_t numBytes, void* userData) {
-    auto& ach = LibretroDroid::getInstance().getAchievements();
+    auto& ach = *static_cast<Achievements*>(userData);
 
     if (ach.memoryInitialized) {
         uint8_t buffer[4] = {0};
         uint32_t bytesRead = rc_libretro_memory_read(&ach.memoryRegions, address, buffer, numBytes);
 
         // Log first few peeks to verify memory reading works
-        if (peekLogCounter < 5) {
-            peekLogCounter++;
+        if (ach.peekLogCounter < 5) {
+            ach.peekLogCounter++;
             uint32_t value = 0;
             for (uint32_t i = 0; i < bytesRead; i++) {
                 value |= static_cast<uint32_t>(buffer[i]) << (i * 8);
@@ -183,10 +186,10 @@ uint32_t Achievements::peekMemory(uint32_t address, uint32_t numBytes, void* use
         return value;
     }
 
-    if (!g_core) return 0;
+    if (!ach.core) return 0;
 
-    void* memPtr = g_core->retro_get_memory_data(RETRO_MEMORY_SYSTEM_RAM);
-    size_t memSize = g_core->retro_get_memory_size(RETRO_MEMORY_SYSTEM_RAM);
+    void* memPtr = ach.core->retro_get_memory_data(RETRO_MEMORY_SYSTEM_RAM);
+    size_t memSize = ach.core->retro_get_memory_size(RETRO_MEMORY_SYSTEM_RAM);
 
     if (!memPtr || address + numBytes > memSize) {
         return 0;
@@ -244,8 +247,4 @@ void Achievements::clear() {
     LOGD("Achievements cleared");
 }
 
-void Achievements::setCore(Core* core) {
-    g_core = core;
-}
-
 }
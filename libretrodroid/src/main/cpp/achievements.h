@@ -47,11 +47,12 @@ public:
     void markTriggered(uint32_t id);
     bool isActive() const { return active; }
 
-    static void setCore(Core* core);
+    void setCore(Core* core) { this->core = core; }
 
 private:
     static uint32_t peekMemory(uint32_t address, uint32_t numBytes, void* userData);
 
+    Core* core = nullptr;
     void* runtime = nullptr;
     bool active = false;
     std::queue<uint32_t> pendingUnlocks;
@@ -61,6 +62,10 @@ private:
     rc_libretro_memory_regions_t memoryRegions = {};
     bool memoryInitialized = false;
     uint32_t consoleId = 0;
+
+    int frameCounter = 0;
+    bool firstEvalLogged = false;
+    int peekLogCounter = 0;
 };
 
 }
@@ -108,22 +108,60 @@ int32_t Audio::computeAudioBufferSize() {
 
 double Audio::computeMaximumLatency() const {
     double maxLatency = (audioLatencySettings->bufferSizeInVideoFrames / contentRefreshRate) * 1000;
-    return std::max(maxLatency, 32.0);
+    // The controller keeps the buffer half full, so the average latency is half the maximum.
+    return std::max({maxLatency, 32.0, 2.0 * minimumLatencyMs});
+}
+
+void Audio::setMinimumLatency(unsigned milliseconds) {
+    unsigned clamped = std::min(milliseconds, MAX_MINIMUM_LATENCY_MS);
+    if (clamped == minimumLatencyMs) return;
+
+    int32_t previousSize = computeAudioBufferSize();
+    minimumLatencyMs = clamped;
+    if (computeAudioBufferSize() == previousSize) return;
+
+    // The buffers are sized when the stream opens, so reopen it with the new size.
+    LOGI("Reopening audio stream for a minimum latency of %u ms", minimumLatencyMs);
+    std::lock_guard<std::mutex> lock(streamMutex);
+    if (stream != nullptr) {
+        stream->stop();
+        stream->close();
+    }
+    initializeStream();
+    errorIntegral = 0.0;
+    framesToSubmit = 0.0;
+    if (startRequested && stream != nullptr) {
+        stream->requestStart();
+    }
+}
+
+unsigned Audio::getBufferOccupancy() const {
+    if (!fifoBuffer) return 0;
+    uint32_t capacity = fifoBuffer->getBufferCapacityInFrames();
+    uint32_t available = std::min(fifoBuffer->getFullFramesAvailable(), capacity);
+    return capacity > 0 ? available * 100 / capacity : 0;
+}
+
+bool Audio::consumeUnderrun() {
+    return underrun.exchange(false, std::memory_order_relaxed);
 }
 
 void Audio::start() {
+    std::lock_guard<std::mutex> lock(streamMutex);
     startRequested = true;
     if (stream != nullptr)
         stream->requestStart();
 }
 
 void Audio::stop() {
+    std::lock_guard<std::mutex> lock(streamMutex);
     startRequested = false;
     if (stream != nullptr)
         stream->requestStop();
 }
 
 Audio::~Audio() {
+    std::lock_guard<std::mutex> lock(streamMutex);
     if (stream != nullptr) {
         stream->stop();
         stream->close();
@@ -166,6 +204,7 @@ void Audio::updateTiming(int32_t newSampleRate, double newRefreshRate) {
          inputSampleRate, newSampleRate, contentRefreshRate, newRefreshRate);
     inputSampleRate = newSampleRate;
     contentRefreshRate = newRefreshRate;
+    std::lock_guard<std::mutex> lock(streamMutex);
     if (stream != nullptr) {
         baseConversionFactor = (double) inputSampleRate / stream->getSampleRate();
     }
@@ -198,6 +237,10 @@ oboe::DataCallbackResult Audio::onAudioReady(oboe::AudioStream *oboeStream, void
         currentFramesToSubmit = stretchBufferFrameCapacity;
     }
 
+    if (fifoBuffer->getFullFramesAvailable() < (uint32_t) currentFramesToSubmit * 2) {
+        underrun.store(true, std::memory_order_relaxed);
+    }
+
     fifoBuffer->readNow(temporaryAudioBuffer.get(), currentFramesToSubmit * 2);
 
     auto outputArray = reinterpret_cast<int16_t *>(audioData);
@@ -292,9 +335,10 @@ void Audio::onErrorAfterClose(oboe::AudioStream* oldStream, oboe::Result result)
     if (result != oboe::Result::ErrorDisconnected)
         return;
 
+    std::lock_guard<std::mutex> lock(streamMutex);
     initializeStream();
-    if (startRequested) {
-        start();
+    if (startRequested && stream != nullptr) {
+        stream->requestStart();
     }
 }
 
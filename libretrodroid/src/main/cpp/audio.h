@@ -19,6 +19,8 @@
 #define LIBRETRODROID_AUDIO_H
 
 #include <array>
+#include <atomic>
+#include <mutex>
 #include <unistd.h>
 #include <oboe/Oboe.h>
 #include <oboe/FifoBuffer.h>
@@ -38,6 +40,9 @@ private:
     const AudioLatencySettings DEFAULT_LATENCY_SETTINGS { 8, false };
     const AudioLatencySettings LOW_LATENCY_SETTINGS { 4, true };
 
+    // Cores may ask for more latency; the API only expects requests up to this to be honoured.
+    static constexpr unsigned MAX_MINIMUM_LATENCY_MS = 512;
+
 public:
     Audio(int32_t sampleRate, double refreshRate, bool preferLowLatencyAudio);
     ~Audio() override;
@@ -61,6 +66,15 @@ public:
     void resetBufferState();
     void updateTiming(int32_t newSampleRate, double newRefreshRate);
 
+    /** Grows the buffer so the average latency is at least the given amount. Zero restores the default. */
+    void setMinimumLatency(unsigned milliseconds);
+
+    /** Buffer fill level in percent, as cores doing audio based frameskip expect it. */
+    unsigned getBufferOccupancy() const;
+
+    /** Whether playback ran out of samples since the last call. */
+    bool consumeUnderrun();
+
 private:
     static int32_t roundToEven(int32_t x);
     double computeDynamicBufferConversionFactor(double dt);
@@ -79,6 +93,9 @@ private:
     std::unique_ptr<oboe::FifoBuffer> fifoBuffer = nullptr;
     std::unique_ptr<int16_t[]> temporaryAudioBuffer = nullptr;
 
+    // Latency changes reopen the stream on the thread running the core, pause and resume start
+    // and stop it from the GL or UI thread, and Oboe reopens it after a disconnect on its own.
+    std::mutex streamMutex;
     oboe::ManagedStream stream = nullptr;
     std::unique_ptr<oboe::LatencyTuner> latencyTuner = nullptr;
 
@@ -96,6 +113,8 @@ private:
     float outputVolume = 1.0f;
 
     std::unique_ptr<AudioLatencySettings> audioLatencySettings;
+    unsigned minimumLatencyMs = 0;
+    std::atomic<bool> underrun{false};
 
     // SoundTouch time-stretcher: preserves pitch when playbackSpeed != 1.0.
     // Activated only when pitchPreservationEnabled is set AND the tempo actually
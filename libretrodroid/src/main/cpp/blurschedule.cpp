@@ -0,0 +1,51 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "blurschedule.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace libretrodroid {
+
+BlurSchedule::BlurSchedule(int skipUpdate, float blendFactor) : skipUpdate(std::max(skipUpdate, 1)) {
+    // Passes until the weight left on older frames drops below one 8 bit step.
+    float retained = 1.0F - std::clamp(blendFactor, 0.01F, 1.0F);
+    convergedPasses = retained > 0.0F
+        ? (int) std::ceil(std::log(1.0F / 255.0F) / std::log(retained))
+        : 1;
+}
+
+bool BlurSchedule::advance(bool frameChanged) {
+    pendingFrameChange |= frameChanged;
+
+    bool updateSlot = slot == 0;
+    slot = (slot + 1) % skipUpdate;
+    if (!updateSlot) return false;
+
+    if (pendingFrameChange) {
+        staticPasses = 0;
+        pendingFrameChange = false;
+    }
+    if (staticPasses >= convergedPasses) {
+        return false;
+    }
+    staticPasses++;
+    return true;
+}
+
+} //namespace libretrodroid
@@ -0,0 +1,51 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_BLURSCHEDULE_H
+#define LIBRETRODROID_BLURSCHEDULE_H
+
+namespace libretrodroid {
+
+/**
+ * Decides on which displayed frames the immersive background blur is refreshed. Updates happen
+ * every skipUpdate frames, and stop once the running blend has converged onto a still game
+ * frame. Changes arriving on skipped frames are remembered until the next update slot, so a game
+ * running slower than the display never leaves the background frozen.
+ */
+class BlurSchedule {
+public:
+    BlurSchedule(int skipUpdate, float blendFactor);
+
+    /** Called once per displayed frame. Returns true when the blur should be refreshed on it. */
+    bool advance(bool frameChanged);
+
+    int getConvergedPasses() const { return convergedPasses; }
+
+private:
+    int skipUpdate;
+    int convergedPasses;
+    int slot = 0;
+
+    // Blend passes run since the game frame last changed. Once the running blend has converged
+    // onto a still frame, further passes would produce the same texture.
+    int staticPasses = 0;
+    bool pendingFrameChange = false;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_BLURSCHEDULE_H
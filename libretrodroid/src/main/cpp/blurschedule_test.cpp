@@ -0,0 +1,58 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ */
+
+#include "blurschedule_test.h"
+#include "blurschedule.h"
+
+namespace libretrodroid::test {
+
+int runBlurScheduleTests() {
+    int passed = 0;
+
+    // A still frame gets blended until it converges and then no more, until the game changes.
+    {
+        BlurSchedule schedule(1, 0.1F);
+        int updates = 0;
+        for (int frame = 0; frame < 200; frame++) {
+            if (schedule.advance(frame == 0)) updates++;
+        }
+        if (updates == schedule.getConvergedPasses() && schedule.advance(true)) {
+            ++passed;
+        }
+    }
+
+    // Updates only land on every skipUpdate-th frame.
+    {
+        BlurSchedule schedule(2, 0.1F);
+        bool ok = true;
+        for (int frame = 0; frame < 20; frame++) {
+            if (schedule.advance(true) != (frame % 2 == 0)) ok = false;
+        }
+        if (ok) ++passed;
+    }
+
+    // A 30 fps game on a 60 Hz display whose changes all arrive on skipped frames keeps the
+    // background animating instead of freezing once the first blend converges.
+    {
+        BlurSchedule schedule(2, 0.1F);
+        int lateUpdates = 0;
+        int frames = schedule.getConvergedPasses() * 8;
+        for (int frame = 0; frame < frames; frame++) {
+            bool updated = schedule.advance(frame % 2 == 1);
+            if (updated && frame >= frames / 2) lateUpdates++;
+        }
+        if (lateUpdates == frames / 4) {
+            ++passed;
+        }
+    }
+
+    return passed;
+}
+
+} // namespace libretrodroid::test
@@ -16,6 +16,7 @@
  */
 
 #include <dlfcn.h>
+#include <stdexcept>
 #include "core.h"
 
 #include "log.h"
@@ -0,0 +1,73 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "corebenchmark.h"
+
+#include <algorithm>
+
+#include <sys/resource.h>
+
+namespace libretrodroid {
+
+CoreBenchmark::CoreBenchmark(uint32_t frames) {
+    frameTimes.reserve(frames);
+}
+
+void CoreBenchmark::recordFrame(double micros) {
+    frameTimes.push_back(micros);
+}
+
+CoreBenchmark::Result CoreBenchmark::finish() const {
+    Result result;
+    result.frames = static_cast<uint32_t>(frameTimes.size());
+    if (frameTimes.empty()) return result;
+
+    double total = 0;
+    for (double time : frameTimes) total += time;
+    result.elapsedMs = total / 1000.0;
+    result.emulatedFps = total > 0 ? frameTimes.size() * 1000000.0 / total : 0;
+
+    size_t windowSize = std::max<size_t>(frameTimes.size() / WINDOWS, 1);
+    for (size_t window = 0; window < WINDOWS; window++) {
+        size_t begin = std::min(window * windowSize, frameTimes.size());
+        size_t end = window + 1 == WINDOWS ? frameTimes.size() : std::min(begin + windowSize, frameTimes.size());
+        double windowTotal = 0;
+        for (size_t i = begin; i < end; i++) windowTotal += frameTimes[i];
+        result.windowFps[window] = windowTotal > 0 ? (end - begin) * 1000000.0 / windowTotal : 0;
+    }
+    double first = result.windowFps.front();
+    double last = result.windowFps.back();
+    result.driftPercent = first > 0 && last > 0 ? (last - first) * 100.0 / first : 0;
+
+    std::vector<double> sorted(frameTimes);
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](double fraction) {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+    };
+    result.frameP50Us = at(0.50);
+    result.frameP95Us = at(0.95);
+    result.frameP99Us = at(0.99);
+    result.frameMaxUs = sorted.back();
+
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        result.peakRssKb = usage.ru_maxrss;
+    }
+    return result;
+}
+
+} //namespace libretrodroid
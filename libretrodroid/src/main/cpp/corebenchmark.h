@@ -0,0 +1,62 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_COREBENCHMARK_H
+#define LIBRETRODROID_COREBENCHMARK_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Collects the cost of back-to-back retro_run calls for device qualification. Beyond the
+ * averages it splits the run into equal windows, since a device that throttles once it heats up
+ * shows up as a falling frame rate from the first window to the last.
+ */
+class CoreBenchmark {
+public:
+    static constexpr size_t WINDOWS = 10;
+
+    struct Result {
+        uint32_t frames = 0;
+        double elapsedMs = 0;
+        double emulatedFps = 0;
+        double frameP50Us = 0;
+        double frameP95Us = 0;
+        double frameP99Us = 0;
+        double frameMaxUs = 0;
+        long peakRssKb = 0;
+        std::array<double, WINDOWS> windowFps {};
+        // Change from the first window's frame rate to the last one's, in percent.
+        double driftPercent = 0;
+    };
+
+    explicit CoreBenchmark(uint32_t frames);
+
+    void recordFrame(double micros);
+    Result finish() const;
+
+private:
+    std::vector<double> frameTimes;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_COREBENCHMARK_H
@@ -0,0 +1,125 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "corethread.h"
+
+#include <utility>
+
+#include <pthread.h>
+
+#include "log.h"
+
+namespace libretrodroid {
+
+CoreThread::CoreThread() {
+    thread = std::thread(&CoreThread::threadLoop, this);
+}
+
+CoreThread::~CoreThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_one();
+    thread.join();
+
+    if (pendingError) {
+        LOGW("Core thread stopped with an unreported task failure");
+    }
+}
+
+void CoreThread::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void CoreThread::runSync(const Task& task) {
+    if (isCurrentThread()) {
+        task();
+        return;
+    }
+
+    std::exception_ptr error;
+    bool done = false;
+
+    post([&]() {
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    taskFinished.wait(lock, [&]() { return done; });
+    lock.unlock();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void CoreThread::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    taskFinished.wait(lock, [&]() { return tasks.empty() && !busy; });
+
+    if (pendingError) {
+        std::exception_ptr error = pendingError;
+        pendingError = nullptr;
+        lock.unlock();
+        std::rethrow_exception(error);
+    }
+}
+
+bool CoreThread::isCurrentThread() const {
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+void CoreThread::threadLoop() {
+    pthread_setname_np(pthread_self(), "LibretroCore");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        taskAvailable.wait(lock, [&]() { return stopping || !tasks.empty(); });
+        if (tasks.empty()) break;
+
+        Task task = std::move(tasks.front());
+        tasks.pop_front();
+        busy = true;
+        lock.unlock();
+
+        try {
+            task();
+        } catch (...) {
+            LOGE("Core thread task failed");
+            lock.lock();
+            pendingError = std::current_exception();
+            lock.unlock();
+        }
+
+        lock.lock();
+        busy = false;
+        taskFinished.notify_all();
+    }
+}
+
+} //namespace libretrodroid
@@ -0,0 +1,67 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_CORETHREAD_H
+#define LIBRETRODROID_CORETHREAD_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace libretrodroid {
+
+/**
+ * A single thread that owns every call into the core while it is alive. Tasks run in submission
+ * order, so a synchronous call queued behind an in-flight frame naturally waits for that frame.
+ * An exception thrown by a posted task is held and rethrown from the next waitIdle().
+ */
+class CoreThread {
+public:
+    typedef std::function<void()> Task;
+
+    CoreThread();
+    ~CoreThread();
+
+    CoreThread(const CoreThread&) = delete;
+    CoreThread& operator=(const CoreThread&) = delete;
+
+    void post(Task task);
+    void runSync(const Task& task);
+    void waitIdle();
+
+    bool isCurrentThread() const;
+
+private:
+    void threadLoop();
+
+private:
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable taskFinished;
+    std::deque<Task> tasks;
+    bool busy = false;
+    bool stopping = false;
+    std::exception_ptr pendingError;
+    std::thread thread;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_CORETHREAD_H
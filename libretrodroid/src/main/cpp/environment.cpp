@@ -17,6 +17,7 @@
 
 #define MODULE_NAME_CORE "Libretro Core"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include <string>
@@ -31,6 +32,31 @@
 #include "vfs/vfs.h"
 #include "microphone/microphoneinterface.h"
 
+namespace {
+
+thread_local Environment* currentEnvironment = nullptr;
+std::atomic<Environment*> defaultEnvironment { nullptr };
+
+}
+
+Environment& Environment::getInstance() {
+    if (currentEnvironment != nullptr) return *currentEnvironment;
+
+    Environment* fallback = defaultEnvironment.load(std::memory_order_acquire);
+    if (fallback != nullptr) return *fallback;
+
+    static Environment instance;
+    return instance;
+}
+
+Environment* Environment::bindToCurrentThread(Environment* environment) {
+    return std::exchange(currentEnvironment, environment);
+}
+
+void Environment::setDefault(Environment* environment) {
+    defaultEnvironment.store(environment, std::memory_order_release);
+}
+
 void Environment::initialize(
     const std::string &requiredSystemDirectory,
     const std::string &requiredSavesDirectory,
@@ -51,6 +77,13 @@ void Environment::deinitialize() {
     savesDirectory = std::string();
     systemDirectory = std::string();
     language = RETRO_LANGUAGE_ENGLISH;
+    audioVideoEnable = AV_ENABLE_VIDEO | AV_ENABLE_AUDIO;
+    throttleState = {RETRO_THROTTLE_NONE, 0.0f};
+    targetRefreshRate = 60.0f;
+    frameTimeCallback = {nullptr, 0};
+    audioBufferStatusCallback = nullptr;
+    minimumAudioLatency = 0;
+    minimumAudioLatencyUpdated = false;
 
     pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
     useHWAcceleration = false;
@@ -74,58 +107,132 @@ void Environment::deinitialize() {
     hasMemoryMap = false;
 
     rumbleStates.fill(libretrodroid::RumbleState());
+
+    // The core is unloaded by now, so nothing can still point into earlier registrations.
+    std::lock_guard<std::mutex> lock(variablesMutex);
+    retiredVariableSlots.clear();
 }
 
 void Environment::updateVariable(const std::string& key, const std::string& value) {
-    auto current = variables[key];
-    current.key = key;
+    std::lock_guard<std::mutex> lock(variablesMutex);
+
+    auto found = variableIndex.find(key);
+    if (found == variableIndex.end()) {
+        // Not registered yet: the value wins over the default once the core declares it.
+        auto& pending = pendingVariables[key];
+        if (pending != value) {
+            pending = value;
+            dirtyVariables.store(true, std::memory_order_release);
+        }
+        return;
+    }
 
-    if (value != current.value) {
-        current.value = value;
-        variables[key] = current;
-        dirtyVariables = true;
+    VariableSlot& slot = *found->second;
+    const std::string* current = slot.current.load(std::memory_order_relaxed);
+    if (current != nullptr && *current == value) return;
+
+    slot.current.store(internVariableValue(slot, value), std::memory_order_release);
+    dirtyVariables.store(true, std::memory_order_release);
+}
+
+const std::string* Environment::internVariableValue(VariableSlot& slot, std::string_view value) {
+    for (const auto& interned : slot.values) {
+        if (*interned == value) return interned.get();
     }
+    slot.values.push_back(std::make_unique<const std::string>(value));
+    return slot.values.back().get();
 }
 
 bool Environment::environment_handle_set_variables(const struct retro_variable* received) {
-    unsigned count = 0;
-    while (received[count].key != nullptr) {
+    std::lock_guard<std::mutex> lock(variablesMutex);
+
+    // Options dropped by this registration keep their values, as if set before registering.
+    for (const auto& slot : variableSlots) {
+        pendingVariables[slot->key] = *slot->current.load(std::memory_order_relaxed);
+    }
+
+    std::vector<std::unique_ptr<VariableSlot>> slots;
+    for (unsigned count = 0; received[count].key != nullptr; count++) {
         LOGD("Core registered variable: %s = %s", received[count].key, received[count].value);
 
-        std::string key(received[count].key);
-        std::string description(received[count].value);
-        std::string value(received[count].value);
+        auto slot = std::make_unique<VariableSlot>();
+        slot->key = received[count].key;
+        slot->description = received[count].value != nullptr ? received[count].value : "";
 
-        auto firstValueStart = value.find(';') + 2;
-        auto firstValueEnd = value.find('|', firstValueStart);
-        value = value.substr(firstValueStart, firstValueEnd - firstValueStart);
+        // "Description; first|second|third", where the first value is the default.
+        std::string_view options(slot->description);
+        size_t separator = options.find(';');
+        options = separator == std::string_view::npos ? std::string_view() : options.substr(separator + 1);
+        while (!options.empty() && options.front() == ' ') {
+            options.remove_prefix(1);
+        }
 
-        auto currentVariable = variables[key];
-        currentVariable.key = key;
-        currentVariable.description = description;
+        const std::string* defaultValue = nullptr;
+        while (!options.empty()) {
+            size_t end = options.find('|');
+            const std::string* value = internVariableValue(*slot, options.substr(0, end));
+            if (defaultValue == nullptr) defaultValue = value;
+            options = end == std::string_view::npos ? std::string_view() : options.substr(end + 1);
+        }
 
-        if (currentVariable.value.empty()) {
-            currentVariable.value = value;
+        auto pending = pendingVariables.find(slot->key);
+        if (pending != pendingVariables.end() && !pending->second.empty()) {
+            slot->current.store(internVariableValue(*slot, pending->second), std::memory_order_relaxed);
+        } else {
+            slot->current.store(defaultValue ? defaultValue : internVariableValue(*slot, ""), std::memory_order_relaxed);
         }
+        if (pending != pendingVariables.end()) {
+            pendingVariables.erase(pending);
+        }
+
+        LOGD("Assigning variable %s: %s", slot->key.c_str(), slot->current.load()->c_str());
+        slots.push_back(std::move(slot));
+    }
 
-        variables[key] = currentVariable;
-        LOGD("Assigning variable %s: %s", currentVariable.key.c_str(), currentVariable.value.c_str());
+    // The core may still hold value pointers from the previous registration.
+    for (auto& slot : variableSlots) {
+        retiredVariableSlots.push_back(std::move(slot));
+    }
+    variableSlots = std::move(slots);
 
-        count++;
+    variableIndex.clear();
+    for (const auto& slot : variableSlots) {
+        variableIndex.emplace(slot->key, slot.get());
     }
+    variableCache.fill(VariableCacheEntry());
 
     return true;
 }
 
+Environment::VariableSlot* Environment::findVariableSlot(const char* key) {
+    VariableCacheEntry& entry = variableCache[(reinterpret_cast<uintptr_t>(key) >> 3) % VARIABLE_CACHE_SIZE];
+    // The address may be a reused buffer holding another key, so confirm before trusting it.
+    if (entry.key == key && entry.slot->key == key) {
+        return entry.slot;
+    }
+
+    auto found = variableIndex.find(std::string_view(key));
+    if (found == variableIndex.end()) {
+        return nullptr;
+    }
+
+    entry.key = key;
+    entry.slot = found->second;
+    return found->second;
+}
+
 bool Environment::environment_handle_get_variable(struct retro_variable* requested) {
-    auto foundVariable = variables.find(std::string(requested->key));
+    if (requested == nullptr || requested->key == nullptr) {
+        return false;
+    }
 
-    if (foundVariable == variables.end()) {
+    VariableSlot* slot = findVariableSlot(requested->key);
+    if (slot == nullptr) {
         LOGD("Variable GET miss: %s (not found)", requested->key);
         return false;
     }
 
-    requested->value = foundVariable->second.value.c_str();
+    requested->value = slot->current.load(std::memory_order_acquire)->c_str();
     return true;
 }
 
@@ -258,9 +365,9 @@ bool Environment::handle_callback_environment(unsigned cmd, void *data) {
             return environment_handle_set_variables(static_cast<const struct retro_variable*>(data));
 
         case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE: {
-            LOGD("Called RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE. Is dirty?: %d", dirtyVariables);
-            *((bool*) data) = dirtyVariables;
-            dirtyVariables = false;
+            bool dirty = dirtyVariables.exchange(false, std::memory_order_acq_rel);
+            LOGD("Called RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE. Is dirty?: %d", dirty);
+            *((bool*) data) = dirty;
             return true;
         }
 
@@ -357,7 +464,50 @@ bool Environment::handle_callback_environment(unsigned cmd, void *data) {
 
         case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
             LOGD("Called RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE");
-            return false;
+            if (data != nullptr) {
+                *((int*) data) = static_cast<int>(audioVideoEnable);
+            }
+            return true;
+
+        case RETRO_ENVIRONMENT_SET_FRAME_TIME_CALLBACK:
+            LOGD("Called RETRO_ENVIRONMENT_SET_FRAME_TIME_CALLBACK");
+            frameTimeCallback = *static_cast<const struct retro_frame_time_callback*>(data);
+            return true;
+
+        case RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK: {
+            LOGD("Called RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK");
+            auto* statusCallback = static_cast<const struct retro_audio_buffer_status_callback*>(data);
+            audioBufferStatusCallback = statusCallback != nullptr ? statusCallback->callback : nullptr;
+            return true;
+        }
+
+        case RETRO_ENVIRONMENT_SET_MINIMUM_AUDIO_LATENCY:
+            LOGD("Called RETRO_ENVIRONMENT_SET_MINIMUM_AUDIO_LATENCY");
+            if (data == nullptr) return false;
+            minimumAudioLatency = *static_cast<const unsigned*>(data);
+            minimumAudioLatencyUpdated = true;
+            return true;
+
+        case RETRO_ENVIRONMENT_GET_FASTFORWARDING:
+            LOGD("Called RETRO_ENVIRONMENT_GET_FASTFORWARDING");
+            if (data != nullptr) {
+                *((bool*) data) = throttleState.mode == RETRO_THROTTLE_FAST_FORWARD;
+            }
+            return true;
+
+        case RETRO_ENVIRONMENT_GET_TARGET_REFRESH_RATE:
+            LOGD("Called RETRO_ENVIRONMENT_GET_TARGET_REFRESH_RATE");
+            if (data != nullptr) {
+                *((float*) data) = targetRefreshRate;
+            }
+            return true;
+
+        case RETRO_ENVIRONMENT_GET_THROTTLE_STATE:
+            LOGD("Called RETRO_ENVIRONMENT_GET_THROTTLE_STATE");
+            if (data != nullptr) {
+                *static_cast<struct retro_throttle_state*>(data) = throttleState;
+            }
+            return true;
 
         case RETRO_ENVIRONMENT_GET_LANGUAGE:
             LOGD("Called RETRO_ENVIRONMENT_GET_LANGUAGE");
@@ -399,6 +549,42 @@ bool Environment::handle_callback_environment(unsigned cmd, void *data) {
     }
 }
 
+void Environment::setAudioVideoEnable(unsigned flags) {
+    audioVideoEnable = flags;
+}
+
+unsigned Environment::getAudioVideoEnable() const {
+    return audioVideoEnable;
+}
+
+void Environment::setThrottleState(const struct retro_throttle_state& state) {
+    throttleState = state;
+}
+
+void Environment::setTargetRefreshRate(float rate) {
+    targetRefreshRate = rate;
+}
+
+const struct retro_frame_time_callback& Environment::getFrameTimeCallback() const {
+    return frameTimeCallback;
+}
+
+retro_audio_buffer_status_callback_t Environment::getAudioBufferStatusCallback() const {
+    return audioBufferStatusCallback;
+}
+
+unsigned Environment::getMinimumAudioLatency() const {
+    return minimumAudioLatency;
+}
+
+bool Environment::isMinimumAudioLatencyUpdated() const {
+    return minimumAudioLatencyUpdated;
+}
+
+void Environment::clearMinimumAudioLatencyUpdated() {
+    minimumAudioLatencyUpdated = false;
+}
+
 void Environment::setLanguage(const std::string& androidLanguage) {
     std::unordered_map<std::string, unsigned> languages {
             { "en", RETRO_LANGUAGE_ENGLISH },
@@ -526,20 +712,20 @@ void Environment::clearGameTimingUpdated() {
 }
 
 const std::vector<struct Variable> Environment::getVariables() const {
-    std::vector<struct Variable> result;
+    std::lock_guard<std::mutex> lock(variablesMutex);
 
-    std::for_each(
-        variables.begin(),
-        variables.end(),
-        [&](std::pair<std::string, struct Variable> item) {
-            result.push_back(item.second);
-        }
-    );
+    std::vector<struct Variable> result;
+    for (const auto& slot : variableSlots) {
+        result.push_back(Variable { slot->key, *slot->current.load(std::memory_order_acquire), slot->description });
+    }
+    for (const auto& pending : pendingVariables) {
+        result.push_back(Variable { pending.first, pending.second, std::string() });
+    }
 
     std::sort(
         result.begin(),
         result.end(),
-        [](struct Variable v1, struct Variable v2) {
+        [](const struct Variable& v1, const struct Variable& v2) {
             return v1.key < v2.key;
         }
     );
@@ -27,21 +27,34 @@
 #include <EGL/egl.h>
 #include <unordered_map>
 #include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string_view>
 
 #include "../../libretro-common/include/libretro.h"
 #include "log.h"
 #include "rumblestate.h"
 
+/**
+ * Per session state behind the libretro environment callback. Cores call back through static
+ * functions, so each thread is bound to the environment of the session it is driving.
+ */
 class Environment {
 public:
-    static Environment& getInstance()
-    {
-        static Environment instance;
-        return instance;
-    }
+    Environment() {}
     Environment(Environment const&) = delete;
     void operator=(Environment const&) = delete;
 
+    /** The environment bound to the calling thread, else the process default. */
+    static Environment& getInstance();
+
+    /** Routes callbacks on the calling thread to environment. Returns the previous binding. */
+    static Environment* bindToCurrentThread(Environment* environment);
+
+    /** Serves threads with no binding of their own, such as the ones a core spawns. */
+    static void setDefault(Environment* environment);
+
     static void callback_retro_log(enum retro_log_level level, const char *fmt, ...);
 
     static bool callback_set_rumble_state(
@@ -55,10 +68,6 @@ public:
     void setEnableVirtualFileSystem(bool value);
     void setEnableMicrophone(bool value);
 
-private:
-    Environment() {}
-
-public:
     void initialize(
         const std::string &requiredSystemDirectory,
         const std::string &requiredSavesDirectory,
@@ -71,6 +80,24 @@ public:
 
     void setLanguage(const std::string &androidLanguage);
 
+    // GET_AUDIO_VIDEO_ENABLE bits. The bundled libretro.h predates the named constants.
+    static constexpr unsigned AV_ENABLE_VIDEO = 1 << 0;
+    static constexpr unsigned AV_ENABLE_AUDIO = 1 << 1;
+
+    /** Flags answered to GET_AUDIO_VIDEO_ENABLE for the frame about to run. */
+    void setAudioVideoEnable(unsigned flags);
+    unsigned getAudioVideoEnable() const;
+
+    /** Timing the frontend reports through GET_THROTTLE_STATE and GET_FASTFORWARDING. */
+    void setThrottleState(const struct retro_throttle_state& state);
+    void setTargetRefreshRate(float rate);
+    const struct retro_frame_time_callback& getFrameTimeCallback() const;
+
+    retro_audio_buffer_status_callback_t getAudioBufferStatusCallback() const;
+    unsigned getMinimumAudioLatency() const;
+    bool isMinimumAudioLatencyUpdated() const;
+    void clearMinimumAudioLatencyUpdated();
+
     float retrieveGameSpecificAspectRatio();
     void setAspectRatioOverride(float ratio);
     void clearAspectRatioOverride();
@@ -130,6 +157,28 @@ private:
     bool environment_handle_get_vfs_interface(struct retro_vfs_interface_info* vfs_interface_info);
     bool environment_handle_get_microphone_interface(struct retro_microphone_interface* microphone_interface);
 
+private:
+    // A registered core option. Every value it takes is interned in the slot and never freed while
+    // the slot lives, so the core can keep the pointer GET_VARIABLE gave it and an update from the
+    // UI thread is a single atomic store.
+    struct VariableSlot {
+        std::string key;
+        std::string description;
+        std::vector<std::unique_ptr<const std::string>> values;
+        std::atomic<const std::string*> current{nullptr};
+    };
+
+    // Cores mostly pass string literals, so the key's address finds its slot without hashing.
+    struct VariableCacheEntry {
+        const char* key = nullptr;
+        VariableSlot* slot = nullptr;
+    };
+
+    static constexpr size_t VARIABLE_CACHE_SIZE = 64;
+
+    VariableSlot* findVariableSlot(const char* key);
+    static const std::string* internVariableValue(VariableSlot& slot, std::string_view value);
+
 private:
     retro_hw_context_reset_t hw_context_reset = nullptr;
     retro_hw_context_reset_t hw_context_destroy = nullptr;
@@ -139,6 +188,13 @@ private:
     std::string systemDirectory;
     retro_hw_get_current_framebuffer_t callback_get_current_framebuffer = nullptr;
     unsigned language = RETRO_LANGUAGE_ENGLISH;
+    unsigned audioVideoEnable = AV_ENABLE_VIDEO | AV_ENABLE_AUDIO;
+    struct retro_throttle_state throttleState = {RETRO_THROTTLE_NONE, 0.0f};
+    float targetRefreshRate = 60.0f;
+    struct retro_frame_time_callback frameTimeCallback = {nullptr, 0};
+    retro_audio_buffer_status_callback_t audioBufferStatusCallback = nullptr;
+    unsigned minimumAudioLatency = 0;
+    bool minimumAudioLatencyUpdated = false;
     bool useVirtualFileSystem = false;
     bool enableMicrophone = false;
 
@@ -167,8 +223,15 @@ private:
 
     std::array<libretrodroid::RumbleState, 4> rumbleStates;
 
-    std::unordered_map<std::string, struct Variable> variables;
-    bool dirtyVariables = false;
+    // Slots and the index only change in SET_VARIABLES, on the core thread, so GET_VARIABLE reads
+    // them without locking. The mutex orders that against updates and listings from other threads.
+    mutable std::mutex variablesMutex;
+    std::vector<std::unique_ptr<VariableSlot>> variableSlots;
+    std::vector<std::unique_ptr<VariableSlot>> retiredVariableSlots;
+    std::unordered_map<std::string_view, VariableSlot*> variableIndex;
+    std::unordered_map<std::string, std::string> pendingVariables;
+    std::array<VariableCacheEntry, VARIABLE_CACHE_SIZE> variableCache {};
+    std::atomic<bool> dirtyVariables{false};
 
     std::vector<std::vector<struct Controller>> controllers;
 
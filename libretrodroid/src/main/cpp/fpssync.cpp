@@ -63,6 +63,10 @@ double FPSSync::getTimeStretchFactor() {
     return useVSync ? contentRefreshRate / screenRefreshRate : 1.0;
 }
 
+bool FPSSync::isUsingVSync() const {
+    return useVSync;
+}
+
 void FPSSync::wait() {
     auto now = std::chrono::steady_clock::now();
     auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(lastFrame - now).count();
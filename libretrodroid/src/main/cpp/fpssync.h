@@ -35,6 +35,7 @@ public:
     unsigned advanceFrames();
     void wait();
     double getTimeStretchFactor();
+    bool isUsingVSync() const;
     void setExternalTimingControl(bool enabled);
     void updateContentRefreshRate(double newContentRefreshRate);
 private:
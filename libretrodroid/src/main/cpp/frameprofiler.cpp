@@ -0,0 +1,239 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameprofiler.h"
+
+#include <algorithm>
+#include <sstream>
+
+#ifdef __ANDROID__
+#include <android/trace.h>
+#endif
+
+namespace libretrodroid {
+
+namespace {
+
+const char* STAGE_NAMES[] = {
+    "frame",
+    "core_wait",
+    "core_run",
+    "rewind",
+    "achievements",
+    "render",
+    "fps_sync",
+    "environment",
+};
+
+const int STAGE_BITS = 4;
+const int START_BITS = 36;
+const int DURATION_BITS = 24;
+const uint64_t START_MASK = (1ULL << START_BITS) - 1;
+const uint64_t DURATION_MASK = (1ULL << DURATION_BITS) - 1;
+
+bool traceEnabled() {
+#ifdef __ANDROID__
+    return ATrace_isEnabled();
+#else
+    return false;
+#endif
+}
+
+}
+
+FrameProfiler::Scope::Scope(FrameProfiler& profiler, Stage stage) :
+    profiler(profiler),
+    stage(stage),
+    active(profiler.isEnabled()),
+    traced(active && profiler.traceSections.load(std::memory_order_relaxed) && traceEnabled())
+{
+#ifdef __ANDROID__
+    if (traced) ATrace_beginSection(stageName(stage));
+#endif
+    if (active) startNs = nowNs();
+}
+
+FrameProfiler::Scope::~Scope() {
+    if (!active) return;
+    int64_t endNs = nowNs();
+#ifdef __ANDROID__
+    if (traced) ATrace_endSection();
+#endif
+    profiler.record(stage, startNs, endNs - startNs);
+}
+
+void FrameProfiler::setEnabled(bool enabled) {
+    if (enabled && !isEnabled()) {
+        reset();
+    }
+    this->enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void FrameProfiler::setTraceSections(bool enabled) {
+    traceSections.store(enabled, std::memory_order_relaxed);
+}
+
+void FrameProfiler::record(Stage stage, int64_t startNs, int64_t durationNs) {
+    auto index = static_cast<int>(stage);
+    if (index < 0 || index >= STAGES) return;
+
+    uint64_t durationUs = durationNs > 0 ? static_cast<uint64_t>(durationNs) / 1000 : 0;
+    Histogram& histogram = histograms[index];
+    histogram.buckets[bucketIndex(durationUs)].fetch_add(1, std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.totalUs.fetch_add(durationUs, std::memory_order_relaxed);
+
+    uint64_t currentMax = histogram.maxUs.load(std::memory_order_relaxed);
+    while (durationUs > currentMax
+        && !histogram.maxUs.compare_exchange_weak(currentMax, durationUs, std::memory_order_relaxed)) {
+    }
+
+    int64_t offsetNs = startNs - epochNs.load(std::memory_order_relaxed);
+    uint64_t startUs = offsetNs > 0 ? static_cast<uint64_t>(offsetNs) / 1000 : 0;
+    uint64_t packed = static_cast<uint64_t>(index)
+        | ((startUs & START_MASK) << STAGE_BITS)
+        | (std::min(durationUs, DURATION_MASK) << (STAGE_BITS + START_BITS));
+
+    uint64_t slot = ringWrite.fetch_add(1, std::memory_order_relaxed) % RING_SIZE;
+    ring[slot].packed.store(packed, std::memory_order_relaxed);
+}
+
+std::string FrameProfiler::snapshot(bool reset) {
+    std::ostringstream json;
+    json << "{\"frames\":" << histograms[static_cast<int>(Stage::FRAME)].count.load(std::memory_order_relaxed);
+
+    json << ",\"stages\":[";
+    for (int stage = 0; stage < STAGES; stage++) {
+        Histogram& histogram = histograms[stage];
+        std::array<uint32_t, BUCKETS> buckets {};
+        uint64_t count = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+            count += buckets[i];
+        }
+        uint64_t totalUs = histogram.totalUs.load(std::memory_order_relaxed);
+        uint64_t maxUs = histogram.maxUs.load(std::memory_order_relaxed);
+
+        if (stage > 0) json << ",";
+        json << "{\"name\":\"" << STAGE_NAMES[stage] << "\""
+             << ",\"count\":" << count
+             << ",\"meanUs\":" << (count > 0 ? totalUs / count : 0)
+             << ",\"p50Us\":" << std::min(percentile(buckets, count, 0.50), maxUs)
+             << ",\"p95Us\":" << std::min(percentile(buckets, count, 0.95), maxUs)
+             << ",\"p99Us\":" << std::min(percentile(buckets, count, 0.99), maxUs)
+             << ",\"maxUs\":" << maxUs
+             << ",\"histogram\":[";
+
+        // Only occupied buckets, as [upper bound in us, count] pairs.
+        bool first = true;
+        for (int i = 0; i < BUCKETS; i++) {
+            if (buckets[i] == 0) continue;
+            if (!first) json << ",";
+            json << "[" << bucketUpperBound(i) << "," << buckets[i] << "]";
+            first = false;
+        }
+        json << "]}";
+    }
+    json << "]";
+
+    // Oldest first, as [stage, start in us since the profile began, duration in us].
+    json << ",\"recent\":[";
+    uint64_t written = ringWrite.load(std::memory_order_relaxed);
+    uint64_t available = std::min<uint64_t>(written, RING_SIZE);
+    bool firstSample = true;
+    for (uint64_t i = written - available; i < written; i++) {
+        uint64_t packed = ring[i % RING_SIZE].packed.load(std::memory_order_relaxed);
+        auto stage = static_cast<int>(packed & ((1ULL << STAGE_BITS) - 1));
+        if (stage >= STAGES) continue;
+        if (!firstSample) json << ",";
+        firstSample = false;
+        json << "[\"" << STAGE_NAMES[stage] << "\","
+             << ((packed >> STAGE_BITS) & START_MASK) << ","
+             << ((packed >> (STAGE_BITS + START_BITS)) & DURATION_MASK) << "]";
+    }
+    json << "]}";
+
+    if (reset) {
+        this->reset();
+    }
+    return json.str();
+}
+
+void FrameProfiler::reset() {
+    for (auto& histogram : histograms) {
+        for (auto& bucket : histogram.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.totalUs.store(0, std::memory_order_relaxed);
+        histogram.maxUs.store(0, std::memory_order_relaxed);
+    }
+    for (auto& sample : ring) {
+        sample.packed.store(0, std::memory_order_relaxed);
+    }
+    ringWrite.store(0, std::memory_order_relaxed);
+    epochNs.store(nowNs(), std::memory_order_relaxed);
+}
+
+const char* FrameProfiler::stageName(Stage stage) {
+    auto index = static_cast<int>(stage);
+    return index >= 0 && index < STAGES ? STAGE_NAMES[index] : "unknown";
+}
+
+int64_t FrameProfiler::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+int FrameProfiler::bucketIndex(uint64_t valueUs) {
+    if (valueUs < LINEAR_LIMIT) {
+        return static_cast<int>(valueUs);
+    }
+    int exponent = 63 - __builtin_clzll(valueUs);
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+    int shift = exponent - SUB_BUCKET_BITS;
+    auto subBucket = static_cast<int>(valueUs >> shift) - SUB_BUCKETS;
+    return LINEAR_LIMIT + (exponent - SUB_BUCKET_BITS - 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t FrameProfiler::bucketUpperBound(int index) {
+    if (index < LINEAR_LIMIT) {
+        return static_cast<uint64_t>(index);
+    }
+    int exponent = (index - LINEAR_LIMIT) / SUB_BUCKETS + SUB_BUCKET_BITS + 1;
+    uint64_t subBucket = (index - LINEAR_LIMIT) % SUB_BUCKETS + SUB_BUCKETS;
+    int shift = exponent - SUB_BUCKET_BITS;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+uint64_t FrameProfiler::percentile(const std::array<uint32_t, BUCKETS>& buckets, uint64_t count, double fraction) {
+    if (count == 0) return 0;
+    auto target = static_cast<uint64_t>(fraction * static_cast<double>(count) + 0.5);
+    target = std::max<uint64_t>(target, 1);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= target) return bucketUpperBound(i);
+    }
+    return bucketUpperBound(BUCKETS - 1);
+}
+
+} //namespace libretrodroid
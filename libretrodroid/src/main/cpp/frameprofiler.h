@@ -0,0 +1,115 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_FRAMEPROFILER_H
+#define LIBRETRODROID_FRAMEPROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace libretrodroid {
+
+/**
+ * Always-available timing of the stages of a frame, meant for triaging stutter reports on devices
+ * we cannot attach a profiler to. Every stage feeds a log-linear histogram (16 sub-buckets per
+ * power of two, so quantiles are within about 6%) and the most recent samples are kept in a ring.
+ * Recording is lock free and safe from the GL and core threads at once. When disabled a scope
+ * costs one relaxed load.
+ */
+class FrameProfiler {
+public:
+    enum class Stage {
+        FRAME,
+        CORE_WAIT,
+        CORE_RUN,
+        REWIND,
+        ACHIEVEMENTS,
+        RENDER,
+        FPS_SYNC,
+        ENVIRONMENT,
+        COUNT
+    };
+
+    class Scope {
+    public:
+        Scope(FrameProfiler& profiler, Stage stage);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameProfiler& profiler;
+        Stage stage;
+        bool active;
+        bool traced;
+        int64_t startNs = 0;
+    };
+
+    void setEnabled(bool enabled);
+    void setTraceSections(bool enabled);
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void record(Stage stage, int64_t startNs, int64_t durationNs);
+
+    /** Returns the histograms and recent samples as JSON, optionally starting over afterwards. */
+    std::string snapshot(bool reset);
+    void reset();
+
+    static const char* stageName(Stage stage);
+    static int64_t nowNs();
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int LINEAR_LIMIT = SUB_BUCKETS * 2;
+    static constexpr int MAX_EXPONENT = 24;
+    static constexpr int BUCKETS = LINEAR_LIMIT + (MAX_EXPONENT - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;
+    static constexpr size_t RING_SIZE = 512;
+    static constexpr int STAGES = static_cast<int>(Stage::COUNT);
+
+    struct Histogram {
+        std::array<std::atomic<uint32_t>, BUCKETS> buckets {};
+        std::atomic<uint64_t> count { 0 };
+        std::atomic<uint64_t> totalUs { 0 };
+        std::atomic<uint64_t> maxUs { 0 };
+    };
+
+    // Stage, start and duration packed into one word so readers never see a torn sample.
+    struct Sample {
+        std::atomic<uint64_t> packed { 0 };
+    };
+
+    static int bucketIndex(uint64_t valueUs);
+    static uint64_t bucketUpperBound(int index);
+    static uint64_t percentile(const std::array<uint32_t, BUCKETS>& buckets, uint64_t count, double fraction);
+
+private:
+    std::atomic<bool> enabled { false };
+    std::atomic<bool> traceSections { false };
+    std::array<Histogram, STAGES> histograms;
+    std::array<Sample, RING_SIZE> ring;
+    std::atomic<uint64_t> ringWrite { 0 };
+    std::atomic<int64_t> epochNs { 0 };
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_FRAMEPROFILER_H
@@ -0,0 +1,208 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "framereadback.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "log.h"
+
+namespace libretrodroid {
+
+int FrameReadback::request() {
+    std::lock_guard<std::mutex> lock(mutex);
+    int ticket = nextTicket++;
+    requested.push_back(ticket);
+    return ticket;
+}
+
+int FrameReadback::store(Capture capture) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int ticket = nextTicket++;
+    addCompleted(ticket, std::move(capture));
+    return ticket;
+}
+
+FrameReadback::Status FrameReadback::poll(int ticket, Capture& capture) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto done = std::find_if(completed.begin(), completed.end(), [&](const auto& entry) {
+        return entry.first == ticket;
+    });
+    if (done != completed.end()) {
+        capture = std::move(done->second);
+        completed.erase(done);
+        return capture.pixels.empty() ? Status::FAILED : Status::READY;
+    }
+
+    if (std::find(requested.begin(), requested.end(), ticket) != requested.end()) {
+        return Status::PENDING;
+    }
+    for (const auto& readback : inFlight) {
+        if (std::find(readback.tickets.begin(), readback.tickets.end(), ticket) != readback.tickets.end()) {
+            return Status::PENDING;
+        }
+    }
+    return Status::FAILED;
+}
+
+void FrameReadback::process(GLuint sourceTexture, int width, int height) {
+    std::lock_guard<std::mutex> lock(mutex);
+    collectReadbacks();
+
+    // Requests made before the first frame simply wait for one.
+    if (requested.empty() || sourceTexture == 0 || width <= 0 || height <= 0) return;
+    issueReadback(sourceTexture, width, height);
+}
+
+void FrameReadback::destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& readback : inFlight) {
+        glDeleteSync(readback.fence);
+        freeBuffers.push_back(readback.buffer);
+    }
+    inFlight.clear();
+    requested.clear();
+
+    if (!freeBuffers.empty()) {
+        glDeleteBuffers((GLsizei) freeBuffers.size(), freeBuffers.data());
+        freeBuffers.clear();
+    }
+    if (sourceFramebuffer != 0) glDeleteFramebuffers(1, &sourceFramebuffer);
+    if (flipFramebuffer != 0) glDeleteFramebuffers(1, &flipFramebuffer);
+    if (flipRenderbuffer != 0) glDeleteRenderbuffers(1, &flipRenderbuffer);
+    sourceFramebuffer = 0;
+    flipFramebuffer = 0;
+    flipRenderbuffer = 0;
+    flipWidth = 0;
+    flipHeight = 0;
+}
+
+void FrameReadback::collectReadbacks() {
+    while (!inFlight.empty()) {
+        Readback& readback = inFlight.front();
+        GLenum result = glClientWaitSync(readback.fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) break;
+        glDeleteSync(readback.fence);
+
+        Capture capture;
+        if (result != GL_WAIT_FAILED) {
+            size_t size = (size_t) readback.width * readback.height * 4;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+            auto* mapped = static_cast<const uint8_t*>(
+                glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr) size, GL_MAP_READ_BIT));
+            if (mapped != nullptr) {
+                capture.width = readback.width;
+                capture.height = readback.height;
+                capture.pixels.assign(mapped, mapped + size);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            } else {
+                LOGE("Unable to map frame readback buffer: 0x%x", glGetError());
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        freeBuffers.push_back(readback.buffer);
+
+        for (size_t i = 0; i < readback.tickets.size(); i++) {
+            bool last = i + 1 == readback.tickets.size();
+            addCompleted(readback.tickets[i], last ? std::move(capture) : capture);
+        }
+        inFlight.pop_front();
+    }
+}
+
+void FrameReadback::issueReadback(GLuint sourceTexture, int width, int height) {
+    if (!ensureFlipTarget(width, height)) {
+        for (int ticket : requested) {
+            addCompleted(ticket, Capture());
+        }
+        requested.clear();
+        return;
+    }
+
+    // Swapping the destination rows makes the blit flip the image, so readers get rows top first.
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, sourceFramebuffer);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sourceTexture, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, flipFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, height, width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    Readback readback;
+    readback.buffer = obtainBuffer();
+    readback.width = width;
+    readback.height = height;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, flipFramebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) width * height * 4, nullptr, GL_STREAM_READ);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.tickets.swap(requested);
+    inFlight.push_back(std::move(readback));
+}
+
+bool FrameReadback::ensureFlipTarget(int width, int height) {
+    if (flipFramebuffer == 0) {
+        glGenFramebuffers(1, &sourceFramebuffer);
+        glGenFramebuffers(1, &flipFramebuffer);
+        glGenRenderbuffers(1, &flipRenderbuffer);
+    }
+    if (width == flipWidth && height == flipHeight) return true;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, flipRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, flipFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, flipRenderbuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOGE("Frame readback target incomplete: 0x%x", status);
+        flipWidth = 0;
+        flipHeight = 0;
+        return false;
+    }
+    flipWidth = width;
+    flipHeight = height;
+    return true;
+}
+
+GLuint FrameReadback::obtainBuffer() {
+    if (!freeBuffers.empty()) {
+        GLuint buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        return buffer;
+    }
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    return buffer;
+}
+
+void FrameReadback::addCompleted(int ticket, Capture capture) {
+    completed.emplace_back(ticket, std::move(capture));
+    if (completed.size() > MAX_COMPLETED) {
+        LOGW("Dropping unclaimed frame capture %d", completed.front().first);
+        completed.pop_front();
+    }
+}
+
+} //namespace libretrodroid
@@ -0,0 +1,94 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_FRAMEREADBACK_H
+#define LIBRETRODROID_FRAMEREADBACK_H
+
+#include <GLES3/gl3.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Non-blocking frame capture. A request is served by the next presented frame: the source texture
+ * is blitted upside down into a scratch target, so rows come back top first, and read into a pixel
+ * pack buffer behind a fence. The buffer is mapped only once a later frame finds the fence
+ * signaled, so the GL thread never stalls on the GPU.
+ *
+ * Frames that already live in memory skip the GPU entirely and are handed over through store().
+ * process() and destroy() must be called with the presenting context current.
+ */
+class FrameReadback {
+public:
+    struct Capture {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    enum class Status {
+        PENDING,
+        READY,
+        FAILED
+    };
+
+    int request();
+    int store(Capture capture);
+    Status poll(int ticket, Capture& capture);
+
+    void process(GLuint sourceTexture, int width, int height);
+    void destroy();
+
+private:
+    static constexpr size_t MAX_COMPLETED = 8;
+
+    struct Readback {
+        std::vector<int> tickets;
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+
+    void collectReadbacks();
+    void issueReadback(GLuint sourceTexture, int width, int height);
+    bool ensureFlipTarget(int width, int height);
+    GLuint obtainBuffer();
+    void addCompleted(int ticket, Capture capture);
+
+private:
+    std::mutex mutex;
+    int nextTicket = 1;
+    std::vector<int> requested;
+    std::deque<Readback> inFlight;
+    std::deque<std::pair<int, Capture>> completed;
+    std::vector<GLuint> freeBuffers;
+
+    GLuint sourceFramebuffer = 0;
+    GLuint flipFramebuffer = 0;
+    GLuint flipRenderbuffer = 0;
+    int flipWidth = 0;
+    int flipHeight = 0;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_FRAMEREADBACK_H
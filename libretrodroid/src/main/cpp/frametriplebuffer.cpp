@@ -0,0 +1,59 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frametriplebuffer.h"
+
+#include <cstring>
+
+namespace libretrodroid {
+
+void FrameTripleBuffer::publish(
+    const void* data,
+    unsigned width,
+    unsigned height,
+    size_t pitch,
+    unsigned bytesPerPixel
+) {
+    Frame& frame = frames[back];
+    size_t rowBytes = (size_t) width * bytesPerPixel;
+    frame.data.resize(rowBytes * height);
+
+    const auto* source = static_cast<const uint8_t*>(data);
+    if (pitch == rowBytes) {
+        memcpy(frame.data.data(), source, rowBytes * height);
+    } else {
+        for (unsigned y = 0; y < height; y++) {
+            memcpy(frame.data.data() + y * rowBytes, source + y * pitch, rowBytes);
+        }
+    }
+
+    frame.width = width;
+    frame.height = height;
+    frame.pitch = rowBytes;
+
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+FrameTripleBuffer::Frame* FrameTripleBuffer::consume() {
+    if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+        return nullptr;
+    }
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+    return &frames[front];
+}
+
+} //namespace libretrodroid
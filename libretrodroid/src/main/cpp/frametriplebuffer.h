@@ -0,0 +1,62 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_FRAMETRIPLEBUFFER_H
+#define LIBRETRODROID_FRAMETRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Lock-free hand-off of software frames from the emulation thread to the GL thread. The producer
+ * always owns one buffer and the consumer another; the third is swapped atomically with either
+ * side, so publishing never waits and the consumer only ever sees the newest complete frame.
+ * Intermediate frames (fast-forward, rewind) are simply overwritten.
+ */
+class FrameTripleBuffer {
+public:
+    struct Frame {
+        std::vector<uint8_t> data;
+        unsigned width = 0;
+        unsigned height = 0;
+        size_t pitch = 0;
+    };
+
+    // Producer side. Rows are packed, so the published pitch is width * bytesPerPixel.
+    void publish(const void* data, unsigned width, unsigned height, size_t pitch, unsigned bytesPerPixel);
+
+    // Consumer side. Returns the newest frame, or nullptr if nothing was published since last time.
+    Frame* consume();
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<Frame, 3> frames;
+    std::atomic<uint8_t> middle { 1 };
+    uint8_t back = 0;
+    uint8_t front = 2;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_FRAMETRIPLEBUFFER_H
@@ -0,0 +1,212 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hwframering.h"
+
+#include "log.h"
+
+namespace libretrodroid {
+
+bool HWFrameRing::initialize(unsigned width, unsigned height, bool useDepth, bool useStencil) {
+    this->useDepth = useDepth;
+    this->useStencil = useStencil;
+
+    if (useDepth) {
+        glGenRenderbuffers(1, &depthStencil);
+    }
+
+    for (auto& slot : slots) {
+        glGenTextures(1, &slot.texture);
+        glBindTexture(GL_TEXTURE_2D, slot.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glGenFramebuffers(1, &slot.framebuffer);
+    }
+
+    allocateStorage(width, height);
+
+    for (auto& slot : slots) {
+        glBindFramebuffer(GL_FRAMEBUFFER, slot.framebuffer);
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            LOGE("HW frame ring FBO incomplete: 0x%x", status);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            destroy();
+            return false;
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    LOGI("HW frame ring created: %d slots %ux%u depth=%d stencil=%d", SLOTS, width, height, useDepth, useStencil);
+    return true;
+}
+
+void HWFrameRing::resize(unsigned width, unsigned height) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (readySlot != NONE) {
+        deleteFence(slots[readySlot].readyFence);
+        readySlot = NONE;
+    }
+    allocateStorage(width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void HWFrameRing::destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& slot : slots) {
+        deleteFence(slot.readyFence);
+        deleteFence(slot.releaseFence);
+        if (slot.framebuffer != 0) glDeleteFramebuffers(1, &slot.framebuffer);
+        if (slot.texture != 0) glDeleteTextures(1, &slot.texture);
+        slot = Slot();
+    }
+    if (depthStencil != 0) {
+        glDeleteRenderbuffers(1, &depthStencil);
+        depthStencil = 0;
+    }
+    writeSlot = 0;
+    readySlot = NONE;
+    displayedSlot = NONE;
+}
+
+GLuint HWFrameRing::getWriteFramebuffer() const {
+    return slots[writeSlot].framebuffer;
+}
+
+void HWFrameRing::beginFrame() {
+    GLsync releaseFence;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        releaseFence = slots[writeSlot].releaseFence;
+        slots[writeSlot].releaseFence = nullptr;
+    }
+
+    // The presenter may still be sampling this texture from an earlier frame.
+    if (releaseFence != nullptr) {
+        glWaitSync(releaseFence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(releaseFence);
+    }
+    frameMarked = false;
+}
+
+void HWFrameRing::markFrame(unsigned width, unsigned height) {
+    slots[writeSlot].width = width;
+    slots[writeSlot].height = height;
+    frameMarked = true;
+}
+
+void HWFrameRing::endFrame() {
+    if (!frameMarked) return;
+    frameMarked = false;
+
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (readySlot != NONE) {
+        deleteFence(slots[readySlot].readyFence);
+    }
+    slots[writeSlot].readyFence = fence;
+    readySlot = writeSlot;
+
+    for (int i = 0; i < SLOTS; i++) {
+        if (i != readySlot && i != displayedSlot) {
+            writeSlot = i;
+            break;
+        }
+    }
+}
+
+bool HWFrameRing::acquireFrame(Frame& frame) {
+    GLsync readyFence;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (readySlot == NONE) return false;
+
+        displayedSlot = readySlot;
+        readySlot = NONE;
+
+        Slot& slot = slots[displayedSlot];
+        readyFence = slot.readyFence;
+        slot.readyFence = nullptr;
+        frame.texture = slot.texture;
+        frame.width = slot.width;
+        frame.height = slot.height;
+    }
+
+    if (readyFence != nullptr) {
+        glWaitSync(readyFence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(readyFence);
+    }
+    return true;
+}
+
+GLuint HWFrameRing::getDisplayedTexture() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return displayedSlot != NONE ? slots[displayedSlot].texture : 0;
+}
+
+void HWFrameRing::releaseDisplayedFrame() {
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (displayedSlot == NONE) {
+        glDeleteSync(fence);
+        return;
+    }
+    deleteFence(slots[displayedSlot].releaseFence);
+    slots[displayedSlot].releaseFence = fence;
+}
+
+void HWFrameRing::allocateStorage(unsigned width, unsigned height) {
+    if (depthStencil != 0) {
+        glBindRenderbuffer(GL_RENDERBUFFER, depthStencil);
+        glRenderbufferStorage(GL_RENDERBUFFER,
+            useStencil ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT16, width, height);
+    }
+
+    for (auto& slot : slots) {
+        glBindTexture(GL_TEXTURE_2D, slot.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, slot.framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot.texture, 0);
+        if (depthStencil != 0) {
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+                useStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                GL_RENDERBUFFER, depthStencil);
+        }
+
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        slot.width = width;
+        slot.height = height;
+    }
+}
+
+void HWFrameRing::deleteFence(GLsync& fence) {
+    if (fence != nullptr) {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+} //namespace libretrodroid
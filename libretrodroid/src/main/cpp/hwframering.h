@@ -0,0 +1,91 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_HWFRAMERING_H
+#define LIBRETRODROID_HWFRAMERING_H
+
+#include <GLES3/gl3.h>
+
+#include <array>
+#include <mutex>
+
+namespace libretrodroid {
+
+/**
+ * Render targets for a hardware core running on its own thread. The core draws into one slot
+ * while the presenter samples another, and a third holds the newest finished frame, so neither
+ * side waits for the other. Hand-off in both directions uses fence syncs waited on the GPU with
+ * glWaitSync, never on the CPU.
+ *
+ * Methods marked producer must be called with the core's context current, consumer ones with the
+ * presenting context current. Both contexts must belong to the same share group.
+ */
+class HWFrameRing {
+public:
+    struct Frame {
+        GLuint texture = 0;
+        unsigned width = 0;
+        unsigned height = 0;
+    };
+
+    // Producer side.
+    bool initialize(unsigned width, unsigned height, bool useDepth, bool useStencil);
+    void resize(unsigned width, unsigned height);
+    void destroy();
+
+    GLuint getWriteFramebuffer() const;
+    void beginFrame();
+    void markFrame(unsigned width, unsigned height);
+    void endFrame();
+
+    // Consumer side.
+    bool acquireFrame(Frame& frame);
+    GLuint getDisplayedTexture() const;
+    void releaseDisplayedFrame();
+
+private:
+    static constexpr int SLOTS = 3;
+    static constexpr int NONE = -1;
+
+    struct Slot {
+        GLuint texture = 0;
+        GLuint framebuffer = 0;
+        GLsync readyFence = nullptr;
+        GLsync releaseFence = nullptr;
+        unsigned width = 0;
+        unsigned height = 0;
+    };
+
+    void allocateStorage(unsigned width, unsigned height);
+    static void deleteFence(GLsync& fence);
+
+private:
+    mutable std::mutex mutex;
+    std::array<Slot, SLOTS> slots;
+    GLuint depthStencil = 0;
+    bool useDepth = false;
+    bool useStencil = false;
+
+    int writeSlot = 0;
+    int readySlot = NONE;
+    int displayedSlot = NONE;
+    bool frameMarked = false;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_HWFRAMERING_H
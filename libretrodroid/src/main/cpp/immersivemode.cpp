@@ -17,6 +17,8 @@
 
 #include "immersivemode.h"
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <vector>
 
@@ -171,7 +173,8 @@ void ImmersiveMode::renderToFinalOutput(
     unsigned screenWidth,
     unsigned screenHeight,
     std::array<float, 12> backgroundVertices,
-    std::array<float, 4> foregroundBounds
+    std::array<float, 4> foregroundBounds,
+    const std::array<float, 12>& foregroundVertices
 ) {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glViewport(0, 0, screenWidth, screenHeight);
@@ -196,7 +199,31 @@ void ImmersiveMode::renderToFinalOutput(
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, blurFramebuffers[3]->texture);
     glUniform1i(displayTextureHandle, 0);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    ScreenRect foreground;
+    if (computeForegroundRect(screenWidth, screenHeight, foregroundVertices, foreground)) {
+        // The game is drawn opaque on top, so only the bands around it are shaded.
+        int width = (int) screenWidth;
+        int height = (int) screenHeight;
+        int foregroundTop = foreground.y + foreground.height;
+        int foregroundRight = foreground.x + foreground.width;
+        const ScreenRect bands[] = {
+            { 0, 0, width, foreground.y },
+            { 0, foregroundTop, width, height - foregroundTop },
+            { 0, foreground.y, foreground.x, foreground.height },
+            { foregroundRight, foreground.y, width - foregroundRight, foreground.height },
+        };
+
+        glEnable(GL_SCISSOR_TEST);
+        for (const auto& band : bands) {
+            if (band.width <= 0 || band.height <= 0) continue;
+            glScissor(band.x, band.y, band.width, band.height);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+        glDisable(GL_SCISSOR_TEST);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
 
     glDisableVertexAttribArray(displayPositionHandle);
     glDisableVertexAttribArray(displayTextureCoordinatesHandle);
@@ -210,20 +237,58 @@ void ImmersiveMode::renderBackground(
     unsigned screenHeight,
     std::array<float, 12> backgroundVertices,
     std::array<float, 4> foregroundBounds,
+    const std::array<float, 12>& foregroundVertices,
     GLfloat* framebufferVertices,
-    uintptr_t texture
+    uintptr_t texture,
+    bool frameChanged
 ) {
     initializeShaders();
     initializeFramebuffers();
 
-    if (blendFramebufferCurrent == 0) {
+    if (blurSchedule.advance(frameChanged)) {
         renderToFramebuffer(texture, framebufferVertices);
     }
 
-    // Let's update the blurred texture every other frame.
-    blendFramebufferCurrent = (blendFramebufferCurrent + 1) % blurSkipUpdate;
+    renderToFinalOutput(screenWidth, screenHeight, backgroundVertices, foregroundBounds, foregroundVertices);
+}
+
+bool ImmersiveMode::computeForegroundRect(
+    unsigned screenWidth,
+    unsigned screenHeight,
+    const std::array<float, 12>& foregroundVertices,
+    ScreenRect& rect
+) {
+    float xMin = foregroundVertices[0];
+    float xMax = foregroundVertices[0];
+    float yMin = foregroundVertices[1];
+    float yMax = foregroundVertices[1];
+    for (size_t i = 2; i < foregroundVertices.size(); i += 2) {
+        xMin = std::min(xMin, foregroundVertices[i]);
+        xMax = std::max(xMax, foregroundVertices[i]);
+        yMin = std::min(yMin, foregroundVertices[i + 1]);
+        yMax = std::max(yMax, foregroundVertices[i + 1]);
+    }
+
+    // With an arbitrary rotation the quad does not fill its bounding box.
+    const float epsilon = 1e-4F;
+    for (size_t i = 0; i < foregroundVertices.size(); i += 2) {
+        float x = foregroundVertices[i];
+        float y = foregroundVertices[i + 1];
+        bool onCornerX = std::fabs(x - xMin) < epsilon || std::fabs(x - xMax) < epsilon;
+        bool onCornerY = std::fabs(y - yMin) < epsilon || std::fabs(y - yMax) < epsilon;
+        if (!onCornerX || !onCornerY) return false;
+    }
+
+    auto toPixels = [](float ndc, unsigned size) {
+        float clamped = std::clamp(ndc, -1.0F, 1.0F);
+        return (int) std::lround((clamped + 1.0F) * 0.5F * (float) size);
+    };
 
-    renderToFinalOutput(screenWidth, screenHeight, backgroundVertices, foregroundBounds);
+    rect.x = toPixels(xMin, screenWidth);
+    rect.y = toPixels(yMin, screenHeight);
+    rect.width = toPixels(xMax, screenWidth) - rect.x;
+    rect.height = toPixels(yMax, screenHeight) - rect.y;
+    return rect.width > 0 && rect.height > 0;
 }
 
 std::vector<float> ImmersiveMode::generateSmoothingWeights(int size, float brightness) {
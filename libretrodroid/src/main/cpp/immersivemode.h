@@ -24,6 +24,7 @@
 #include <GLES2/gl2.h>
 
 #include "renderers/es3/es3utils.h"
+#include "blurschedule.h"
 
 namespace libretrodroid {
 
@@ -59,20 +60,40 @@ public:
         downscaledHeight(config.downscaledHeight),
         blurMaskSize(config.blurMaskSize),
         blurBrightness(config.blurBrightness),
-        blurSkipUpdate(config.blurSkipUpdate > 0 ? config.blurSkipUpdate : 1),
-        blendFactor(config.blendFactor)
+        blendFactor(config.blendFactor),
+        blurSchedule(config.blurSkipUpdate, config.blendFactor)
     {}
 
+    /**
+     * Draws the blurred background around the game. The blur is only refreshed while the game
+     * frame changes, and the area the game covers is left out when it is an axis aligned rectangle.
+     */
     void renderBackground(
         unsigned screenWidth,
         unsigned screenHeight,
         std::array<float, 12> backgroundVertices,
         std::array<float, 4> foregroundBounds,
+        const std::array<float, 12>& foregroundVertices,
         GLfloat* framebufferVertices,
-        uintptr_t texture
+        uintptr_t texture,
+        bool frameChanged
     );
 
 private:
+    struct ScreenRect {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    static bool computeForegroundRect(
+        unsigned screenWidth,
+        unsigned screenHeight,
+        const std::array<float, 12>& foregroundVertices,
+        ScreenRect& rect
+    );
+
     std::string generateBlurShader();
     static std::vector<float> generateSmoothingWeights(int size, float brightness);
 
@@ -86,7 +107,8 @@ private:
         unsigned screenWidth,
         unsigned screenHeight,
         std::array<float, 12> backgroundVertices,
-        std::array<float, 4> foregroundBounds
+        std::array<float, 4> foregroundBounds,
+        const std::array<float, 12>& foregroundVertices
     );
 
 private:
@@ -184,7 +206,6 @@ private:
     int downscaledHeight;
     int blurMaskSize;
     float blurBrightness;
-    int blurSkipUpdate;
     float blendFactor;
 
     GLuint blendShaderProgram = 0;
@@ -192,7 +213,7 @@ private:
     GLint blendPrevTextureHandle = -1;
     GLint blendFactorHandle = -1;
     int blendFramebufferWriteIndex = 0;
-    int blendFramebufferCurrent = 0;
+    BlurSchedule blurSchedule;
 };
 
 } // libretrodroid
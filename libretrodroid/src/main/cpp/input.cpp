@@ -16,7 +16,12 @@
  */
 
 #include "input.h"
+
+#ifdef HOST_BUILD
+#include "tests/log_host.h"
+#else
 #include "log.h"
+#endif
 
 #include <cmath>
 
@@ -31,6 +36,10 @@ int16_t Input::getInputState(unsigned port, unsigned device, unsigned index, uns
     if (port >= 4 || port < 0) return 0;
 
     std::lock_guard<std::mutex> lock(inputMutex);
+    if (playbackActive && (device == RETRO_DEVICE_JOYPAD || device == RETRO_DEVICE_ANALOG)) {
+        return getPlaybackState(port, device, index, id);
+    }
+
     switch (device) {
         case RETRO_DEVICE_JOYPAD: {
             if (id == RETRO_DEVICE_ID_JOYPAD_MASK) {
@@ -45,30 +54,8 @@ int16_t Input::getInputState(unsigned port, unsigned device, unsigned index, uns
             return getButtonState(port, id) ? 1 : 0;
         }
 
-        case RETRO_DEVICE_ANALOG: {
-            switch (index) {
-                case RETRO_DEVICE_INDEX_ANALOG_LEFT:
-                    switch (id) {
-                        case RETRO_DEVICE_ID_ANALOG_X:
-                            return (int16_t) (pads[port].joypadLeftXAxis * MAX_RANGE_MOTION);
-                        case RETRO_DEVICE_ID_ANALOG_Y:
-                            return (int16_t) (pads[port].joypadLeftYAxis * MAX_RANGE_MOTION);
-                        default:
-                            return 0;
-                    }
-                case RETRO_DEVICE_INDEX_ANALOG_RIGHT:
-                    switch (id) {
-                        case RETRO_DEVICE_ID_ANALOG_X:
-                            return (int16_t) (pads[port].joypadRightXAxis * MAX_RANGE_MOTION);
-                        case RETRO_DEVICE_ID_ANALOG_Y:
-                            return (int16_t) (pads[port].joypadRightYAxis * MAX_RANGE_MOTION);
-                        default:
-                            return 0;
-                    }
-                default:
-                    return 0;
-            }
-        }
+        case RETRO_DEVICE_ANALOG:
+            return getAnalogState(port, index, id);
 
         case RETRO_DEVICE_POINTER: {
             // TODO: handle multitouch
@@ -99,6 +86,84 @@ int16_t Input::getInputState(unsigned port, unsigned device, unsigned index, uns
     }
 }
 
+int16_t Input::getAnalogState(unsigned port, unsigned index, unsigned id) const {
+    switch (index) {
+        case RETRO_DEVICE_INDEX_ANALOG_LEFT:
+            switch (id) {
+                case RETRO_DEVICE_ID_ANALOG_X:
+                    return (int16_t) (pads[port].joypadLeftXAxis * MAX_RANGE_MOTION);
+                case RETRO_DEVICE_ID_ANALOG_Y:
+                    return (int16_t) (pads[port].joypadLeftYAxis * MAX_RANGE_MOTION);
+                default:
+                    return 0;
+            }
+        case RETRO_DEVICE_INDEX_ANALOG_RIGHT:
+            switch (id) {
+                case RETRO_DEVICE_ID_ANALOG_X:
+                    return (int16_t) (pads[port].joypadRightXAxis * MAX_RANGE_MOTION);
+                case RETRO_DEVICE_ID_ANALOG_Y:
+                    return (int16_t) (pads[port].joypadRightYAxis * MAX_RANGE_MOTION);
+                default:
+                    return 0;
+            }
+        default:
+            return 0;
+    }
+}
+
+int16_t Input::getPlaybackState(unsigned port, unsigned device, unsigned index, unsigned id) const {
+    const PortSnapshot& state = playback[port];
+    if (device == RETRO_DEVICE_JOYPAD) {
+        if (id == RETRO_DEVICE_ID_JOYPAD_MASK) return static_cast<int16_t>(state.buttons);
+        return id <= RETRO_DEVICE_ID_JOYPAD_R3 ? (state.buttons >> id) & 1 : 0;
+    }
+
+    if (index > RETRO_DEVICE_INDEX_ANALOG_RIGHT || id > RETRO_DEVICE_ID_ANALOG_Y) return 0;
+    return state.analog[index * 2 + id];
+}
+
+void Input::captureSnapshot(Snapshot& snapshot) const {
+    std::lock_guard<std::mutex> lock(inputMutex);
+    if (playbackActive) {
+        snapshot = playback;
+        return;
+    }
+    captureLiveSnapshot(snapshot);
+}
+
+void Input::pinLiveSnapshot(Snapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(inputMutex);
+    captureLiveSnapshot(snapshot);
+    playback = snapshot;
+    playbackActive = true;
+}
+
+void Input::captureLiveSnapshot(Snapshot& snapshot) const {
+    for (unsigned port = 0; port < snapshot.size(); port++) {
+        PortSnapshot& state = snapshot[port];
+        state.buttons = 0;
+        for (unsigned i = 0; i <= RETRO_DEVICE_ID_JOYPAD_R3; i++) {
+            if (getButtonState(port, i)) {
+                state.buttons |= (1u << i);
+            }
+        }
+        for (unsigned axis = 0; axis < state.analog.size(); axis++) {
+            state.analog[axis] = getAnalogState(port, axis / 2, axis % 2);
+        }
+    }
+}
+
+void Input::setPlaybackSnapshot(const Snapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(inputMutex);
+    playback = snapshot;
+    playbackActive = true;
+}
+
+void Input::clearPlaybackSnapshot() {
+    std::lock_guard<std::mutex> lock(inputMutex);
+    playbackActive = false;
+}
+
 int Input::convertAndroidToLibretroKey(int keyCode) const {
     switch (keyCode) {
         case AKEYCODE_BUTTON_START:
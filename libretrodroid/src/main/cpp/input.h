@@ -47,6 +47,19 @@ private:
     };
 
 public:
+    // What the core sees on one port: joypad buttons as a RETRO_DEVICE_ID_JOYPAD bitmask and the
+    // analog axes as getInputState reports them (left x, left y, right x, right y).
+    struct PortSnapshot {
+        uint16_t buttons = 0;
+        std::array<int16_t, 4> analog {};
+
+        bool operator==(const PortSnapshot& other) const {
+            return buttons == other.buttons && analog == other.analog;
+        }
+        bool operator!=(const PortSnapshot& other) const { return !(*this == other); }
+    };
+    typedef std::array<PortSnapshot, 4> Snapshot;
+
     static constexpr int MOTION_SOURCE_DPAD = 0;
     static constexpr int MOTION_SOURCE_ANALOG_LEFT = 1;
     static constexpr int MOTION_SOURCE_ANALOG_RIGHT = 2;
@@ -68,10 +81,21 @@ public:
     uint32_t getInputPortBitmask(unsigned port);
     void setNetplayActive(bool active);
 
+    void captureSnapshot(Snapshot& snapshot) const;
+    // While set, joypad and analog queries are answered from the snapshot instead of live input.
+    void setPlaybackSnapshot(const Snapshot& snapshot);
+    void clearPlaybackSnapshot();
+    // Captures live input and pins it as the playback snapshot in one step, so what is recorded
+    // for a frame is exactly what the core reads during it.
+    void pinLiveSnapshot(Snapshot& snapshot);
+
 private:
     const int UNKNOWN_KEY = -1;
 
     bool getButtonState(unsigned port, unsigned id) const;
+    int16_t getAnalogState(unsigned port, unsigned index, unsigned id) const;
+    int16_t getPlaybackState(unsigned port, unsigned device, unsigned index, unsigned id) const;
+    void captureLiveSnapshot(Snapshot& snapshot) const;
     template<typename ...T>
     bool anyPressed(unsigned int port, unsigned int id, T&... args) const;
     bool anyPressed(unsigned int port, unsigned int id) const;
@@ -80,6 +104,9 @@ private:
     GamePadState pads[4];
     GamePadState captured[4];
     bool netplayActive = false;
+
+    Snapshot playback;
+    bool playbackActive = false;
 };
 
 }
@@ -0,0 +1,288 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inputmovie.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "log.h"
+
+namespace libretrodroid {
+
+namespace {
+
+const uint8_t MAGIC[4] = { 'L', 'D', 'M', 'V' };
+const uint16_t VERSION = 1;
+const size_t HEADER_SIZE = 16;
+const size_t VERSION_OFFSET = 4;
+const size_t CONTAINER_SIZE_OFFSET = 8;
+
+const uint8_t FIELD_BUTTONS = 1 << 0;
+const uint8_t FIELD_ANALOG_SHIFT = 1;
+
+// Deflate never expands data more than this, so it bounds the anchor by the container holding it.
+const uint64_t MAX_INFLATE_RATIO = 1032;
+
+uint64_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t unzigzag(uint64_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+}
+
+InputMovieWriter::InputMovieWriter(StateContainer::Sink sink) : sink(std::move(sink)) { }
+
+bool InputMovieWriter::begin(const uint8_t* state, size_t stateSize, const std::string& coreId) {
+    // The reader needs the anchor's length up front, so compress it before writing anything.
+    std::vector<uint8_t> container;
+    bool compressed = StateContainer::write(state, stateSize, coreId, [&](const uint8_t* data, size_t size) {
+        container.insert(container.end(), data, data + size);
+        return true;
+    });
+    if (!compressed) {
+        LOGE("Unable to compress input movie anchor state");
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE] = {0};
+    uint16_t version = VERSION;
+    uint64_t containerSize = container.size();
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    memcpy(header + VERSION_OFFSET, &version, sizeof(version));
+    memcpy(header + CONTAINER_SIZE_OFFSET, &containerSize, sizeof(containerSize));
+
+    if (!sink(header, sizeof(header)) || !sink(container.data(), container.size())) {
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool InputMovieWriter::writeFrame(const Input::Snapshot& snapshot) {
+    if (failed) return false;
+
+    frameCount++;
+    if (snapshot == previous) {
+        repeats++;
+        return true;
+    }
+
+    putVarint(repeats);
+    writeChange(snapshot);
+    repeats = 0;
+    previous = snapshot;
+
+    return pending.size() < FLUSH_SIZE || flush();
+}
+
+bool InputMovieWriter::finish() {
+    if (failed) return false;
+    putVarint(repeats);
+    pending.push_back(0);
+    repeats = 0;
+    return flush();
+}
+
+void InputMovieWriter::writeChange(const Input::Snapshot& snapshot) {
+    uint8_t ports = 0;
+    for (size_t port = 0; port < snapshot.size(); port++) {
+        if (snapshot[port] != previous[port]) ports |= 1 << port;
+    }
+    pending.push_back(ports);
+
+    for (size_t port = 0; port < snapshot.size(); port++) {
+        if ((ports & (1 << port)) == 0) continue;
+        const Input::PortSnapshot& before = previous[port];
+        const Input::PortSnapshot& after = snapshot[port];
+
+        uint8_t fields = after.buttons != before.buttons ? FIELD_BUTTONS : 0;
+        for (size_t axis = 0; axis < after.analog.size(); axis++) {
+            if (after.analog[axis] != before.analog[axis]) fields |= 1 << (FIELD_ANALOG_SHIFT + axis);
+        }
+        pending.push_back(fields);
+
+        if (fields & FIELD_BUTTONS) {
+            pending.push_back(static_cast<uint8_t>(after.buttons));
+            pending.push_back(static_cast<uint8_t>(after.buttons >> 8));
+        }
+        for (size_t axis = 0; axis < after.analog.size(); axis++) {
+            if (fields & (1 << (FIELD_ANALOG_SHIFT + axis))) {
+                putVarint(zigzag(after.analog[axis] - before.analog[axis]));
+            }
+        }
+    }
+}
+
+void InputMovieWriter::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        pending.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    pending.push_back(static_cast<uint8_t>(value));
+}
+
+bool InputMovieWriter::flush() {
+    if (!pending.empty() && !sink(pending.data(), pending.size())) {
+        LOGE("Unable to write input movie");
+        failed = true;
+        return false;
+    }
+    pending.clear();
+    return true;
+}
+
+InputMovieReader::InputMovieReader(StateContainer::Source source)
+    : source(std::move(source)), buffer(BUFFER_SIZE) { }
+
+bool InputMovieReader::open(StateContainer::Header& header, std::vector<uint8_t>& state) {
+    uint8_t raw[HEADER_SIZE];
+    if (readBytes(raw, sizeof(raw)) != sizeof(raw) || memcmp(raw, MAGIC, sizeof(MAGIC)) != 0) {
+        LOGE("Not an input movie");
+        return false;
+    }
+
+    uint16_t version;
+    uint64_t containerSize;
+    memcpy(&version, raw + VERSION_OFFSET, sizeof(version));
+    memcpy(&containerSize, raw + CONTAINER_SIZE_OFFSET, sizeof(containerSize));
+    if (version != VERSION) {
+        LOGE("Unsupported input movie version %u", version);
+        return false;
+    }
+
+    // The container reads ahead in large chunks, so keep it from running into the frame stream.
+    uint64_t remaining = containerSize;
+    StateContainer::Source anchorSource = [&](uint8_t* data, size_t size) -> ssize_t {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(size, remaining));
+        ssize_t read = readBytes(data, count);
+        if (read > 0) remaining -= read;
+        return read;
+    };
+
+    if (!StateContainer::readHeader(anchorSource, header)) return false;
+    if (header.stateSize > containerSize * MAX_INFLATE_RATIO) {
+        LOGE("Input movie anchor of %llu bytes cannot fit its container", (unsigned long long) header.stateSize);
+        return false;
+    }
+    state.resize(header.stateSize);
+    if (!StateContainer::readState(anchorSource, header, state.data())) return false;
+
+    // Skip whatever zlib did not need, so the frame stream starts where the writer put it.
+    uint8_t discard[256];
+    while (remaining > 0) {
+        if (anchorSource(discard, sizeof(discard)) <= 0) return false;
+    }
+
+    loadRecord();
+    return true;
+}
+
+bool InputMovieReader::readFrame(Input::Snapshot& snapshot) {
+    if (repeats > 0) {
+        repeats--;
+    } else if (hasChange) {
+        current = next;
+        hasChange = false;
+        loadRecord();
+    } else {
+        return false;
+    }
+
+    snapshot = current;
+    frameCount++;
+    return true;
+}
+
+void InputMovieReader::loadRecord() {
+    uint64_t count = 0;
+    if (!readVarint(count)) {
+        LOGW("Input movie ends without a terminator after %llu frames", (unsigned long long) frameCount);
+        repeats = 0;
+        hasChange = false;
+        return;
+    }
+
+    repeats = count;
+    next = current;
+    hasChange = readChange(next);
+}
+
+bool InputMovieReader::readChange(Input::Snapshot& snapshot) {
+    uint8_t ports = 0;
+    if (!readByte(ports) || ports == 0) return false;
+
+    for (size_t port = 0; port < snapshot.size(); port++) {
+        if ((ports & (1 << port)) == 0) continue;
+        Input::PortSnapshot& state = snapshot[port];
+
+        uint8_t fields = 0;
+        if (!readByte(fields)) return false;
+
+        if (fields & FIELD_BUTTONS) {
+            uint8_t low = 0, high = 0;
+            if (!readByte(low) || !readByte(high)) return false;
+            state.buttons = static_cast<uint16_t>(low | (high << 8));
+        }
+        for (size_t axis = 0; axis < state.analog.size(); axis++) {
+            if ((fields & (1 << (FIELD_ANALOG_SHIFT + axis))) == 0) continue;
+            uint64_t delta = 0;
+            if (!readVarint(delta)) return false;
+            state.analog[axis] = static_cast<int16_t>(state.analog[axis] + unzigzag(delta));
+        }
+    }
+    return true;
+}
+
+ssize_t InputMovieReader::readBytes(uint8_t* data, size_t size) {
+    size_t copied = 0;
+    while (copied < size) {
+        if (position == available) {
+            ssize_t count = source(buffer.data(), buffer.size());
+            if (count < 0) return -1;
+            if (count == 0) break;
+            position = 0;
+            available = static_cast<size_t>(count);
+        }
+        size_t chunk = std::min(size - copied, available - position);
+        memcpy(data + copied, buffer.data() + position, chunk);
+        position += chunk;
+        copied += chunk;
+    }
+    return static_cast<ssize_t>(copied);
+}
+
+bool InputMovieReader::readByte(uint8_t& value) {
+    return readBytes(&value, 1) == 1;
+}
+
+bool InputMovieReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = 0;
+        if (!readByte(byte)) return false;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+} //namespace libretrodroid
@@ -0,0 +1,104 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_INPUTMOVIE_H
+#define LIBRETRODROID_INPUTMOVIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "input.h"
+#include "statecontainer.h"
+
+namespace libretrodroid {
+
+/**
+ * Input movies: the save state a recording starts from, followed by the input the core saw on
+ * every frame after it. Layout is a 16 byte header (magic, version, container size), the anchor
+ * state as a StateContainer, then the frame stream.
+ *
+ * The frame stream is a list of records. Each holds a varint count of frames that repeat the
+ * previous input, then a byte with one bit per port that changed (zero ends the stream) and, for
+ * every changed port, a byte of changed fields followed by the new buttons (16 bit little endian)
+ * and zigzag varint deltas of the changed analog axes. Held input therefore costs nothing until
+ * it changes. A stream cut short by a crash plays back up to the last complete record.
+ */
+class InputMovieWriter {
+public:
+    explicit InputMovieWriter(StateContainer::Sink sink);
+
+    bool begin(const uint8_t* state, size_t stateSize, const std::string& coreId);
+    bool writeFrame(const Input::Snapshot& snapshot);
+    bool finish();
+
+    uint64_t getFrameCount() const { return frameCount; }
+
+private:
+    static constexpr size_t FLUSH_SIZE = 4096;
+
+    void writeChange(const Input::Snapshot& snapshot);
+    void putVarint(uint64_t value);
+    bool flush();
+
+private:
+    StateContainer::Sink sink;
+    std::vector<uint8_t> pending;
+    Input::Snapshot previous {};
+    uint64_t repeats = 0;
+    uint64_t frameCount = 0;
+    bool failed = false;
+};
+
+class InputMovieReader {
+public:
+    explicit InputMovieReader(StateContainer::Source source);
+
+    /** Reads the header and anchor state. The state is checked against its CRC. */
+    bool open(StateContainer::Header& header, std::vector<uint8_t>& state);
+
+    /** Fills in the next frame's input. Returns false once the movie is over. */
+    bool readFrame(Input::Snapshot& snapshot);
+
+    uint64_t getFrameCount() const { return frameCount; }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 4096;
+
+    void loadRecord();
+    bool readChange(Input::Snapshot& snapshot);
+    ssize_t readBytes(uint8_t* data, size_t size);
+    bool readByte(uint8_t& value);
+    bool readVarint(uint64_t& value);
+
+private:
+    StateContainer::Source source;
+    std::vector<uint8_t> buffer;
+    size_t position = 0;
+    size_t available = 0;
+
+    Input::Snapshot current {};
+    Input::Snapshot next {};
+    uint64_t repeats = 0;
+    bool hasChange = false;
+    uint64_t frameCount = 0;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_INPUTMOVIE_H
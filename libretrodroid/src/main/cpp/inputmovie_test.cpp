@@ -0,0 +1,170 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ */
+
+#include "inputmovie_test.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "inputmovie.h"
+#include "libretro/libretro-common/include/libretro.h"
+
+namespace libretrodroid::test {
+
+namespace {
+
+StateContainer::Sink vectorSink(std::vector<uint8_t>& output) {
+    return [&output](const uint8_t* data, size_t size) {
+        output.insert(output.end(), data, data + size);
+        return true;
+    };
+}
+
+// Hands out at most chunkSize bytes per call to exercise partial reads.
+StateContainer::Source vectorSource(const std::vector<uint8_t>& input, size_t& position, size_t chunkSize) {
+    return [&input, &position, chunkSize](uint8_t* data, size_t size) -> ssize_t {
+        size_t count = std::min({ size, chunkSize, input.size() - position });
+        std::copy_n(input.begin() + position, count, data);
+        position += count;
+        return static_cast<ssize_t>(count);
+    };
+}
+
+// Buttons held for a few frames at a time and a slowly sweeping stick on two ports.
+std::vector<Input::Snapshot> makeFrames(size_t count) {
+    std::vector<Input::Snapshot> frames(count);
+    uint32_t rng = 12345;
+    Input::Snapshot current {};
+    for (size_t i = 0; i < count; i++) {
+        rng = rng * 1103515245u + 12345u;
+        if ((rng >> 24) < 40) current[0].buttons = static_cast<uint16_t>(rng >> 8);
+        if (i % 7 == 0) current[1].analog[0] = static_cast<int16_t>((i * 97) % 65536 - 32768);
+        if (i % 11 == 0) current[1].analog[3] = static_cast<int16_t>(-current[1].analog[3] - 1);
+        frames[i] = current;
+    }
+    return frames;
+}
+
+bool writeMovie(const std::vector<uint8_t>& state, const std::vector<Input::Snapshot>& frames,
+                bool finish, std::vector<uint8_t>& movie) {
+    InputMovieWriter writer(vectorSink(movie));
+    if (!writer.begin(state.data(), state.size(), "Test Core")) return false;
+    for (const auto& frame : frames) {
+        if (!writer.writeFrame(frame)) return false;
+    }
+    return !finish || writer.finish();
+}
+
+}
+
+int runInputMovieTests() {
+    int passed = 0;
+    std::vector<uint8_t> state(64 * 1024);
+    for (size_t i = 0; i < state.size(); i++) state[i] = static_cast<uint8_t>(i * 31 + (i >> 9));
+    std::vector<Input::Snapshot> frames = makeFrames(20000);
+
+    std::vector<uint8_t> movie;
+    if (writeMovie(state, frames, true, movie)) {
+        size_t position = 0;
+        InputMovieReader reader(vectorSource(movie, position, 1021));
+        StateContainer::Header header {};
+        std::vector<uint8_t> anchor;
+        if (reader.open(header, anchor) && anchor == state && header.coreId == "Test Core") {
+            bool matches = true;
+            Input::Snapshot snapshot {};
+            for (const auto& frame : frames) {
+                matches = matches && reader.readFrame(snapshot) && snapshot == frame;
+            }
+            if (matches && !reader.readFrame(snapshot)) {
+                ++passed;
+            }
+        }
+    }
+
+    // A held pad should cost a handful of bytes no matter how long it is held.
+    std::vector<uint8_t> held;
+    std::vector<Input::Snapshot> heldFrames(100000);
+    for (auto& frame : heldFrames) frame[0].buttons = 1 << RETRO_DEVICE_ID_JOYPAD_A;
+    std::vector<uint8_t> anchorOnly;
+    if (writeMovie(state, {}, true, anchorOnly) && writeMovie(state, heldFrames, true, held)
+        && held.size() - anchorOnly.size() < 16) {
+        ++passed;
+    }
+
+    // A recording that was never finished plays back up to its last complete record.
+    std::vector<uint8_t> unfinished;
+    if (writeMovie(state, frames, false, unfinished) && unfinished.size() > 64) {
+        unfinished.resize(unfinished.size() - 3);
+        size_t position = 0;
+        InputMovieReader reader(vectorSource(unfinished, position, unfinished.size()));
+        StateContainer::Header header {};
+        std::vector<uint8_t> anchor;
+        if (reader.open(header, anchor)) {
+            bool matches = true;
+            Input::Snapshot snapshot {};
+            size_t count = 0;
+            while (reader.readFrame(snapshot)) {
+                matches = matches && count < frames.size() && snapshot == frames[count];
+                count++;
+            }
+            if (matches && count > 0 && count < frames.size()) {
+                ++passed;
+            }
+        }
+    }
+
+    std::vector<uint8_t> notMovie(state.begin(), state.begin() + 256);
+    size_t position = 0;
+    InputMovieReader badReader(vectorSource(notMovie, position, notMovie.size()));
+    StateContainer::Header header {};
+    std::vector<uint8_t> anchor;
+    if (!badReader.open(header, anchor)) {
+        ++passed;
+    }
+
+    // Playback overrides live input and is what a recording would capture.
+    Input input;
+    input.setInputPortState(0, 1 << RETRO_DEVICE_ID_JOYPAD_B);
+    Input::Snapshot playback {};
+    playback[0].buttons = (1 << RETRO_DEVICE_ID_JOYPAD_A) | (1 << RETRO_DEVICE_ID_JOYPAD_START);
+    playback[0].analog[2] = -1234;
+    input.setPlaybackSnapshot(playback);
+
+    Input::Snapshot captured {};
+    input.captureSnapshot(captured);
+    bool overridden = captured == playback
+        && input.getInputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_MASK) == playback[0].buttons
+        && input.getInputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_A) == 1
+        && input.getInputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B) == 0
+        && input.getInputState(0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_X) == -1234;
+
+    input.clearPlaybackSnapshot();
+    input.captureSnapshot(captured);
+    if (overridden && captured[0].buttons == (1 << RETRO_DEVICE_ID_JOYPAD_B)
+        && input.getInputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B) == 1) {
+        ++passed;
+    }
+
+    // A recorded frame pins the input it captured, so later live changes wait for the next frame.
+    Input::Snapshot pinned {};
+    input.pinLiveSnapshot(pinned);
+    input.setInputPortState(0, 1 << RETRO_DEVICE_ID_JOYPAD_Y);
+    bool unchanged = pinned[0].buttons == (1 << RETRO_DEVICE_ID_JOYPAD_B)
+        && input.getInputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_Y) == 0;
+    input.pinLiveSnapshot(pinned);
+    if (unchanged && pinned[0].buttons == (1 << RETRO_DEVICE_ID_JOYPAD_Y)
+        && input.getInputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_Y) == 1) {
+        ++passed;
+    }
+
+    return passed;
+}
+
+} // namespace libretrodroid::test
@@ -0,0 +1,19 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ */
+
+#ifndef LIBRETRODROID_INPUTMOVIE_TEST_H
+#define LIBRETRODROID_INPUTMOVIE_TEST_H
+
+namespace libretrodroid::test {
+
+int runInputMovieTests();
+
+} // namespace libretrodroid::test
+
+#endif // LIBRETRODROID_INPUTMOVIE_TEST_H
@@ -19,6 +19,8 @@
 
 #include <EGL/egl.h>
 #include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cerrno>
 
 #include <algorithm>
@@ -48,9 +50,52 @@
 #include "utils/rect.h"
 #include "errorcodes.h"
 #include "vfs/vfs.h"
+#include "vfs/archivereader.h"
+#include "microphone/microphoneinterface.h"
 
 namespace libretrodroid {
 
+namespace {
+
+thread_local LibretroDroid* currentSession = nullptr;
+
+}
+
+LibretroDroid& LibretroDroid::getInstance() {
+    if (currentSession != nullptr) return *currentSession;
+
+    // Never destroyed, threads a core spawned may still call back while the process exits.
+    static LibretroDroid* defaultSession = []() {
+        auto* session = new LibretroDroid();
+        Environment::setDefault(&session->environment);
+        VFS::setDefault(&session->vfs);
+        return session;
+    }();
+    return *defaultSession;
+}
+
+LibretroDroid::SessionScope::SessionScope(LibretroDroid* session) :
+    previous(std::exchange(currentSession, session)),
+    previousEnvironment(Environment::bindToCurrentThread(&session->environment)),
+    previousVFS(VFS::bindToCurrentThread(&session->vfs)) { }
+
+LibretroDroid::SessionScope::~SessionScope() {
+    VFS::bindToCurrentThread(previousVFS);
+    Environment::bindToCurrentThread(previousEnvironment);
+    currentSession = previous;
+}
+
+LibretroDroid::SessionScope LibretroDroid::enterSession() {
+    syncCoreThread();
+    return SessionScope(this);
+}
+
+void LibretroDroid::bindToCurrentThread() {
+    currentSession = this;
+    Environment::bindToCurrentThread(&environment);
+    VFS::bindToCurrentThread(&vfs);
+}
+
 uintptr_t LibretroDroid::callback_get_current_framebuffer() {
     return LibretroDroid::getInstance().handleGetCurrentFrameBuffer();
 }
@@ -102,37 +147,41 @@ void LibretroDroid::resetGlobalVariables() {
 }
 
 int LibretroDroid::availableDisks() {
-    return Environment::getInstance().getRetroDiskControlCallback() != nullptr
-           ? Environment::getInstance().getRetroDiskControlCallback()->get_num_images()
+    SessionScope session = enterSession();
+    return environment.getRetroDiskControlCallback() != nullptr
+           ? environment.getRetroDiskControlCallback()->get_num_images()
            : 0;
 }
 
 int LibretroDroid::currentDisk() {
-    return Environment::getInstance().getRetroDiskControlCallback() != nullptr
-           ? Environment::getInstance().getRetroDiskControlCallback()->get_image_index()
+    SessionScope session = enterSession();
+    return environment.getRetroDiskControlCallback() != nullptr
+           ? environment.getRetroDiskControlCallback()->get_image_index()
            : 0;
 }
 
 void LibretroDroid::changeDisk(unsigned int index) {
-    if (Environment::getInstance().getRetroDiskControlCallback() == nullptr) {
+    SessionScope session = enterSession();
+    if (environment.getRetroDiskControlCallback() == nullptr) {
         LOGE("Cannot swap disk. This platform does not support it.");
         return;
     }
 
-    if (index < 0 || index >= Environment::getInstance().getRetroDiskControlCallback()->get_num_images()) {
+    if (index < 0 || index >= environment.getRetroDiskControlCallback()->get_num_images()) {
         LOGE("Requested image index is not valid.");
         return;
     }
 
-    if (Environment::getInstance().getRetroDiskControlCallback()->get_image_index() != index) {
-        Environment::getInstance().getRetroDiskControlCallback()->set_eject_state(true);
-        Environment::getInstance().getRetroDiskControlCallback()->set_image_index((unsigned) index);
-        Environment::getInstance().getRetroDiskControlCallback()->set_eject_state(false);
+    if (environment.getRetroDiskControlCallback()->get_image_index() != index) {
+        environment.getRetroDiskControlCallback()->set_eject_state(true);
+        environment.getRetroDiskControlCallback()->set_image_index((unsigned) index);
+        environment.getRetroDiskControlCallback()->set_eject_state(false);
     }
 }
 
 void LibretroDroid::changeDisk(unsigned int index, const std::string& path) {
-    auto* diskControl = Environment::getInstance().getRetroDiskControlCallback();
+    SessionScope session = enterSession();
+    auto* diskControl = environment.getRetroDiskControlCallback();
     if (diskControl == nullptr) {
         LOGE("Cannot change disk. This platform does not support it.");
         return;
@@ -148,9 +197,9 @@ void LibretroDroid::changeDisk(unsigned int index, const std::string& path) {
         game_info.data = nullptr;
         game_info.size = 0;
     } else {
-        struct Utils::ReadResult file = Utils::readFileAsBytes(path);
-        game_info.data = file.data;
-        game_info.size = file.size;
+        diskFiles.push_back(MappedFile::open(path));
+        game_info.data = diskFiles.back()->getData();
+        game_info.size = diskFiles.back()->getSize();
     }
 
     diskControl->set_eject_state(true);
@@ -163,18 +212,20 @@ void LibretroDroid::changeDisk(unsigned int index, const std::string& path) {
 }
 
 void LibretroDroid::updateVariable(const Variable& variable) {
-    Environment::getInstance().updateVariable(variable.key, variable.value);
+    SessionScope session = enterSession();
+    environment.updateVariable(variable.key, variable.value);
 }
 
 std::vector<Variable> LibretroDroid::getVariables() {
-    return Environment::getInstance().getVariables();
+    return environment.getVariables();
 }
 
 std::vector<std::vector<struct Controller>> LibretroDroid::getControllers() {
-    return Environment::getInstance().getControllers();
+    return environment.getControllers();
 }
 
 void LibretroDroid::setControllerType(unsigned int port, unsigned int type) {
+    SessionScope session = enterSession();
     core->retro_set_controller_port_device(port, type);
 }
 
@@ -182,6 +233,44 @@ bool LibretroDroid::unserializeState(int8_t *data, size_t size) {
     return unserializeStateWithPolicy(data, size, StateLoadPolicy::StrictSize);
 }
 
+int LibretroDroid::serializeStateToFd(int fd) {
+    SessionScope session = enterSession();
+    size_t size = core->retro_serialize_size();
+    if (size == 0) {
+        LOGE("serializeStateToFd: core reports no serialization support");
+        return -1;
+    }
+
+    return stateWriter.write(fd, size, [this](uint8_t* data, size_t size) {
+        return core->retro_serialize(data, size);
+    });
+}
+
+StateWriter::Status LibretroDroid::pollStateWrite(int ticket) {
+    return stateWriter.poll(ticket);
+}
+
+bool LibretroDroid::unserializeStateFromFd(int fd) {
+    SessionScope session = enterSession();
+
+    // Sized for the core's state up front, so a matching file reads in one go.
+    size_t size = 0;
+    stateBuffer.resize(std::max<size_t>(core->retro_serialize_size(), 1));
+    while (true) {
+        if (size == stateBuffer.size()) stateBuffer.resize(size * 2);
+        ssize_t count = read(fd, stateBuffer.data() + size, stateBuffer.size() - size);
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0) {
+            LOGE("unserializeStateFromFd: read failed (%d)", errno);
+            return false;
+        }
+        if (count == 0) break;
+        size += count;
+    }
+
+    return unserializeStateWithPolicy(reinterpret_cast<int8_t*>(stateBuffer.data()), size, StateLoadPolicy::StrictSize);
+}
+
 bool LibretroDroid::unserializePersistedState(int8_t *data, size_t size) {
     return unserializeStateWithPolicy(data, size, StateLoadPolicy::CoreValidated);
 }
@@ -191,6 +280,8 @@ bool LibretroDroid::unserializeStateWithPolicy(
     size_t size,
     StateLoadPolicy policy
 ) {
+    SessionScope session = enterSession();
+
     const size_t currentSize = core->retro_serialize_size();
     if (currentSize == 0) {
         LOGE("unserializeState: core reports no serialization support");
@@ -236,17 +327,16 @@ bool LibretroDroid::unserializeStateWithPolicy(
     }
 
     if (video && video->isHWAccelerated()) {
-        auto contextReset = Environment::getInstance().getHwContextReset();
+        auto contextReset = environment.getHwContextReset();
         if (contextReset) {
-            video->bindHWContext();
-            contextReset();
-            video->bindMainContext();
+            runWithHWContext(contextReset);
         }
     }
     return true;
 }
 
 JNIEXPORT jboolean JNICALL LibretroDroid::unserializeSRAM(int8_t* data, size_t size) {
+    SessionScope session = enterSession();
     size_t sramSize = core->retro_get_memory_size(RETRO_MEMORY_SAVE_RAM);
     void *sramState = core->retro_get_memory_data(RETRO_MEMORY_SAVE_RAM);
 
@@ -261,11 +351,13 @@ JNIEXPORT jboolean JNICALL LibretroDroid::unserializeSRAM(int8_t* data, size_t s
     }
 
     memcpy(sramState, data, size);
+    resetSRAMTracking();
 
     return true;
 }
 
 std::pair<int8_t*, size_t> LibretroDroid::serializeSRAM() {
+    SessionScope session = enterSession();
     if (core == nullptr) {
         return std::pair(nullptr, 0);
     }
@@ -282,6 +374,89 @@ std::pair<int8_t*, size_t> LibretroDroid::serializeSRAM() {
     return std::pair(data, size);
 }
 
+void LibretroDroid::setSRAMScanInterval(unsigned frames) {
+    SessionScope session = enterSession();
+    sramScanInterval = frames;
+    framesUntilSRAMScan = frames;
+}
+
+size_t LibretroDroid::getSRAMDirtyPageCount() const {
+    return sramDirtyPages.load(std::memory_order_relaxed);
+}
+
+int64_t LibretroDroid::flushSRAM(int fd) {
+    SessionScope session = enterSession();
+    if (core == nullptr) return -1;
+
+    size_t size = core->retro_get_memory_size(RETRO_MEMORY_SAVE_RAM);
+    auto* data = static_cast<const uint8_t*>(core->retro_get_memory_data(RETRO_MEMORY_SAVE_RAM));
+    if (size == 0 || data == nullptr) return 0;
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        LOGE("Cannot flush SRAM: fstat failed (%d)", errno);
+        return -1;
+    }
+    if (static_cast<size_t>(info.st_size) != size) {
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            LOGE("Cannot flush SRAM: ftruncate failed (%d)", errno);
+            return -1;
+        }
+        sramTracker.markAllDirty();
+    }
+
+    int64_t written = sramTracker.flush(data, size, [fd](size_t offset, const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t count = pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) return false;
+            data += count;
+            offset += count;
+            size -= count;
+        }
+        return true;
+    });
+
+    if (written < 0 || fsync(fd) != 0) {
+        LOGE("Cannot flush SRAM: write failed (%d)", errno);
+        // Whatever reached the file is unknown now, so the next flush rewrites everything.
+        sramTracker.markAllDirty();
+        written = -1;
+    }
+
+    sramDirtyPages.store(sramTracker.getDirtyPageCount(), std::memory_order_relaxed);
+    return written;
+}
+
+void LibretroDroid::markSRAMDirty() {
+    SessionScope session = enterSession();
+    sramTracker.markAllDirty();
+    sramDirtyPages.store(sramTracker.getDirtyPageCount(), std::memory_order_relaxed);
+}
+
+void LibretroDroid::resetSRAMTracking() {
+    size_t size = core->retro_get_memory_size(RETRO_MEMORY_SAVE_RAM);
+    auto* data = static_cast<const uint8_t*>(core->retro_get_memory_data(RETRO_MEMORY_SAVE_RAM));
+    sramTracker.reset(data, data != nullptr ? size : 0);
+    sramDirtyPages.store(0, std::memory_order_relaxed);
+    framesUntilSRAMScan = sramScanInterval;
+}
+
+void LibretroDroid::scanSRAM(unsigned frames) {
+    if (sramScanInterval == 0) return;
+    if (framesUntilSRAMScan > frames) {
+        framesUntilSRAMScan -= frames;
+        return;
+    }
+    framesUntilSRAMScan = sramScanInterval;
+
+    size_t size = core->retro_get_memory_size(RETRO_MEMORY_SAVE_RAM);
+    auto* data = static_cast<const uint8_t*>(core->retro_get_memory_data(RETRO_MEMORY_SAVE_RAM));
+    if (size == 0 || data == nullptr) return;
+
+    sramDirtyPages.store(sramTracker.scan(data, size), std::memory_order_relaxed);
+}
+
 std::vector<uint8_t> LibretroDroid::captureRawFrame(int& outWidth, int& outHeight) {
     if (video == nullptr) {
         outWidth = 0;
@@ -291,7 +466,18 @@ std::vector<uint8_t> LibretroDroid::captureRawFrame(int& outWidth, int& outHeigh
     return video->captureRawFrame(outWidth, outHeight);
 }
 
+int LibretroDroid::requestFrameCapture() {
+    if (video == nullptr) return -1;
+    return video->requestCapture();
+}
+
+FrameReadback::Status LibretroDroid::pollFrameCapture(int ticket, FrameReadback::Capture& capture) {
+    if (video == nullptr) return FrameReadback::Status::FAILED;
+    return video->pollCapture(ticket, capture);
+}
+
 std::pair<int8_t*, size_t> LibretroDroid::getMemoryData(unsigned int memoryType) {
+    SessionScope session = enterSession();
     size_t size = core->retro_get_memory_size(memoryType);
     if (size == 0) {
         return std::pair(nullptr, 0);
@@ -308,9 +494,85 @@ std::pair<int8_t*, size_t> LibretroDroid::getMemoryData(unsigned int memoryType)
 }
 
 size_t LibretroDroid::getMemorySize(unsigned int memoryType) {
+    SessionScope session = enterSession();
     return core->retro_get_memory_size(memoryType);
 }
 
+uint32_t LibretroDroid::getMemoryGeneration() const {
+    return memoryGeneration.load(std::memory_order_acquire);
+}
+
+LibretroDroid::MemoryRegion LibretroDroid::getMemoryRegion(unsigned memoryType) {
+    SessionScope session = enterSession();
+    return resolveMemoryRegion(false, memoryType);
+}
+
+std::vector<retro_memory_descriptor> LibretroDroid::getMemoryMapDescriptors() {
+    SessionScope session = enterSession();
+    const struct retro_memory_map* mmap = environment.getMemoryMap();
+    if (mmap == nullptr) return { };
+    return std::vector<retro_memory_descriptor>(mmap->descriptors, mmap->descriptors + mmap->num_descriptors);
+}
+
+LibretroDroid::MemoryRegion LibretroDroid::getMemoryMapRegion(size_t index) {
+    SessionScope session = enterSession();
+    return resolveMemoryRegion(true, index);
+}
+
+LibretroDroid::MemoryRegion LibretroDroid::resolveMemoryRegion(bool mapped, unsigned index) {
+    if (core == nullptr) return { };
+
+    if (!mapped) {
+        auto* data = static_cast<uint8_t*>(core->retro_get_memory_data(index));
+        size_t size = core->retro_get_memory_size(index);
+        return data != nullptr ? MemoryRegion { data, size } : MemoryRegion { };
+    }
+
+    const struct retro_memory_map* mmap = environment.getMemoryMap();
+    if (mmap == nullptr || index >= mmap->num_descriptors) return { };
+    const retro_memory_descriptor& descriptor = mmap->descriptors[index];
+    if (descriptor.ptr == nullptr) return { };
+    return { static_cast<uint8_t*>(descriptor.ptr) + descriptor.offset, descriptor.len };
+}
+
+void LibretroDroid::invalidateMemoryRegions() {
+    memoryGeneration.fetch_add(1, std::memory_order_release);
+    memorySearch.clear();
+}
+
+int64_t LibretroDroid::beginMemorySearch(bool mapped, unsigned index, unsigned width) {
+    SessionScope session = enterSession();
+    MemoryRegion region = resolveMemoryRegion(mapped, index);
+    if (region.data == nullptr || !memorySearch.begin(region.data, region.size, width)) {
+        memorySearch.clear();
+        return -1;
+    }
+
+    memorySearchMapped = mapped;
+    memorySearchIndex = index;
+    memorySearchGeneration = getMemoryGeneration();
+    return static_cast<int64_t>(memorySearch.getCandidateCount());
+}
+
+int64_t LibretroDroid::filterMemorySearch(MemorySearch::Comparison comparison, bool againstValue, uint32_t value) {
+    SessionScope session = enterSession();
+    if (!memorySearch.isActive() || memorySearchGeneration != getMemoryGeneration()) return -1;
+
+    MemoryRegion region = resolveMemoryRegion(memorySearchMapped, memorySearchIndex);
+    if (region.data == nullptr) return -1;
+    return memorySearch.filter(region.data, region.size, comparison, againstValue, value);
+}
+
+std::vector<uint32_t> LibretroDroid::getMemorySearchResults(size_t skip, size_t max) {
+    SessionScope session = enterSession();
+    return memorySearch.getCandidates(skip, max);
+}
+
+void LibretroDroid::endMemorySearch() {
+    SessionScope session = enterSession();
+    memorySearch.clear();
+}
+
 void LibretroDroid::onSurfaceChanged(unsigned int width, unsigned int height) {
     LOGD("Performing libretrodroid onSurfaceChanged");
     if (video) video->updateScreenSize(width, height);
@@ -318,16 +580,19 @@ void LibretroDroid::onSurfaceChanged(unsigned int width, unsigned int height) {
 
 void LibretroDroid::onSurfaceCreated() {
     LOGD("Performing libretrodroid onSurfaceCreated");
+    SessionScope session(this);
+
+    // A frame posted by the last step may still be running; the core is only touched after it.
+    stopCoreThread();
+    video = nullptr;
 
     struct retro_system_av_info system_av_info {};
     core->retro_get_system_av_info(&system_av_info);
 
-    video = nullptr;
-
     // A hardware core renders into a target it sizes itself, up to the maximum it declares, and
     // base_* is only the display size: Flycast pins base at 640x480 while rendering the internal
     // resolution into max_*. Sizing the render target from base crops everything above 1x.
-    bool hwAccelerated = Environment::getInstance().isUseHwAcceleration();
+    bool hwAccelerated = environment.isUseHwAcceleration();
     unsigned renderWidth = system_av_info.geometry.base_width;
     unsigned renderHeight = system_av_info.geometry.base_height;
     if (hwAccelerated) {
@@ -339,17 +604,19 @@ void LibretroDroid::onSurfaceCreated() {
         hwAccelerated,
         renderWidth,
         renderHeight,
-        Environment::getInstance().isUseDepth(),
-        Environment::getInstance().isUseStencil(),
+        environment.isUseDepth(),
+        environment.isUseStencil(),
         openglESVersion,
-        Environment::getInstance().getPixelFormat()
+        environment.getPixelFormat(),
+        hwAccelerated && threadedHWRendering,
+        !hwAccelerated && threadedVideo
     };
 
     auto newVideo = new Video(
         renderingOptions,
         fragmentShaderConfig,
-        Environment::getInstance().isBottomLeftOrigin(),
-        Environment::getInstance().getScreenRotation(),
+        environment.isBottomLeftOrigin(),
+        environment.getScreenRotation(),
         skipDuplicateFrames,
         immersiveModeEnabled,
         viewportRect,
@@ -369,14 +636,65 @@ void LibretroDroid::onSurfaceCreated() {
         video->setBlackFrameInsertion(bfiEnabled);
     }
 
-    if (Environment::getInstance().getHwContextReset() != nullptr) {
-        if (video && video->isHWAccelerated()) {
-            video->bindHWContext();
-        }
-        Environment::getInstance().getHwContextReset()();
-        if (video && video->isHWAccelerated()) {
-            video->bindMainContext();
-        }
+    if (renderingOptions.threadedHWRendering || renderingOptions.threadedVideo) {
+        startCoreThread();
+    }
+
+    if (environment.getHwContextReset() != nullptr) {
+        runWithHWContext(environment.getHwContextReset());
+    }
+}
+
+void LibretroDroid::startCoreThread() {
+    coreThread = std::make_unique<CoreThread>();
+    coreThread->post([this]() { bindToCurrentThread(); });
+
+    // Software frames cross over through the video triple buffer and need no context.
+    if (!video->isHWAccelerated()) {
+        LOGI("Core running on its own emulation thread");
+        return;
+    }
+
+    bool attached = false;
+    coreThread->runSync([&]() { attached = video->attachHWContext(); });
+
+    if (!attached) {
+        coreThread = nullptr;
+        video->disableThreadedHWRendering();
+        return;
+    }
+    LOGI("HW core running on its own render thread");
+}
+
+void LibretroDroid::stopCoreThread() {
+    if (!coreThread) return;
+
+    coreThread->runSync([this]() {
+        if (video) video->detachHWContext();
+    });
+    coreThread = nullptr;
+}
+
+void LibretroDroid::syncCoreThread() {
+    if (coreThread) {
+        coreThread->waitIdle();
+    }
+}
+
+void LibretroDroid::runWithHWContext(const std::function<void()>& task) {
+    if (coreThread) {
+        coreThread->runSync(task);
+        return;
+    }
+
+    SessionScope session(this);
+    bool hwAccelerated = video && video->isHWAccelerated();
+    if (hwAccelerated) {
+        video->bindHWContext();
+    }
+    task();
+    if (hwAccelerated) {
+        video->bindMainContext();
     }
 }
 
@@ -442,13 +760,16 @@ void LibretroDroid::create(
     const std::string& language
 ) {
     LOGD("Performing libretrodroid create");
+    SessionScope session(this);
 
     resetGlobalVariables();
 
-    Environment::getInstance().initialize(systemDir, savesDir, &callback_get_current_framebuffer);
-    Environment::getInstance().setLanguage(language);
-    Environment::getInstance().setEnableVirtualFileSystem(enableVirtualFileSystem);
-    Environment::getInstance().setEnableMicrophone(enableMicrophone);
+    environment.initialize(systemDir, savesDir, &callback_get_current_framebuffer);
+    environment.setLanguage(language);
+    environment.setTargetRefreshRate(refreshRate);
+    environment.setEnableVirtualFileSystem(enableVirtualFileSystem);
+    environment.setEnableMicrophone(enableMicrophone);
+    MicrophoneInterface::setLowLatency(lowLatencyAudio);
 
     openglESVersion = GLESVersion;
     screenRefreshRate = refreshRate;
@@ -456,6 +777,8 @@ void LibretroDroid::create(
     immersiveModeEnabled = GLESVersion >= 3 && immersiveModeConfig.has_value();
     this->immersiveModeConfig = immersiveModeConfig.value_or(ImmersiveMode::Config{});
     audioEnabled = true;
+    audioMuted = false;
+    audioResetPending = false;
     frameSpeed = 1;
 
     core = std::make_unique<Core>(soFilePath);
@@ -477,7 +800,7 @@ void LibretroDroid::create(
     this->forceSoftwareTiming = forceSoftwareTiming;
 
     // HW accelerated cores are only supported on opengles 3.
-    if (Environment::getInstance().isUseHwAcceleration() && openglESVersion < 3) {
+    if (environment.isUseHwAcceleration() && openglESVersion < 3) {
         throw LibretroDroidError("OpenGL ES 3 is required for this Core", ERROR_GL_NOT_COMPATIBLE);
     }
 
@@ -488,6 +811,7 @@ void LibretroDroid::create(
 
 void LibretroDroid::loadGameFromPath(const std::string& gamePath) {
     LOGD("Performing libretrodroid loadGameFromPath");
+    SessionScope session(this);
     struct retro_system_info system_info {};
     core->retro_get_system_info(&system_info);
 
@@ -499,22 +823,28 @@ void LibretroDroid::loadGameFromPath(const std::string& gamePath) {
         game_info.data = nullptr;
         game_info.size = 0;
     } else {
-        struct Utils::ReadResult file = Utils::readFileAsBytes(gamePath);
-        game_info.data = file.data;
-        game_info.size = file.size;
+        gameFile = MappedFile::open(gamePath);
+        game_info.data = gameFile->getData();
+        game_info.size = gameFile->getSize();
     }
 
+    invalidateMemoryRegions();
     bool result = core->retro_load_game(&game_info);
     if (!result) {
         LOGE("Cannot load game. Leaving.");
         throw std::runtime_error("Cannot load game");
     }
 
+    if (gameFile) {
+        gameFile->adviseRandomAccess();
+    }
+
     afterGameLoad();
 }
 
 void LibretroDroid::loadGameFromBytes(const int8_t *data, size_t size) {
     LOGD("Performing libretrodroid loadGameFromBytes");
+    SessionScope session(this);
 
     struct retro_system_info system_info {};
     core->retro_get_system_info(&system_info);
@@ -531,6 +861,7 @@ void LibretroDroid::loadGameFromBytes(const int8_t *data, size_t size) {
         game_info.size = size;
     }
 
+    invalidateMemoryRegions();
     bool result = core->retro_load_game(&game_info);
     if (!result) {
         LOGE("Cannot load game. Leaving.");
@@ -542,6 +873,7 @@ void LibretroDroid::loadGameFromBytes(const int8_t *data, size_t size) {
 
 void LibretroDroid::loadGameFromVirtualFiles(std::vector<VFSFile> virtualFiles) {
     LOGD("Performing libretrodroid loadGameFromVirtualFiles");
+    SessionScope session(this);
     struct retro_system_info system_info {};
     core->retro_get_system_info(&system_info);
 
@@ -550,37 +882,99 @@ void LibretroDroid::loadGameFromVirtualFiles(std::vector<VFSFile> virtualFiles)
         throw std::runtime_error("Calling loadGameFromVirtualFiles without any file.");
     }
 
+    if (!Utils::hasExtension(system_info.valid_extensions, "zip") && ArchiveReader::isArchive(virtualFiles[0].getFD())) {
+        LOGI("Core does not read archives, extracting %s in memory", virtualFiles[0].getFileName().c_str());
+        auto extractedFiles = extractArchive(virtualFiles[0], system_info);
+        for (size_t i = 1; i < virtualFiles.size(); ++i) {
+            extractedFiles.push_back(std::move(virtualFiles[i]));
+        }
+        virtualFiles = std::move(extractedFiles);
+    }
+
     std::string firstFilePath = virtualFiles[0].getFileName();
     int firstFileFD = virtualFiles[0].getFD();
 
-    bool loadUsingVFS = system_info.need_fullpath || virtualFiles.size() > 1;
+    bool presentCHDAsCue = !Utils::hasExtension(system_info.valid_extensions, "chd") && CHDImage::isCHD(firstFileFD);
 
-    struct retro_game_info game_info {};
-    game_info.path = Utils::cloneToCString(firstFilePath);
-    game_info.meta = nullptr;
+    bool loadUsingVFS = system_info.need_fullpath || virtualFiles.size() > 1 || presentCHDAsCue;
 
     if (loadUsingVFS) {
-        VFS::getInstance().initialize(std::move(virtualFiles));
+        vfs.initialize(std::move(virtualFiles));
+    }
+
+    std::string cuePath = CHDImage::cueSheetPath(firstFilePath);
+    if (presentCHDAsCue && vfs.hasVirtualFile(cuePath)) {
+        LOGI("Core does not read CHD, loading synthesized cue sheet %s", cuePath.c_str());
+        firstFilePath = cuePath;
     }
 
+    struct retro_game_info game_info {};
+    game_info.path = Utils::cloneToCString(firstFilePath);
+    game_info.meta = nullptr;
+
     if (loadUsingVFS) {
         game_info.data = nullptr;
         game_info.size = 0;
     } else {
-        struct Utils::ReadResult file = Utils::readFileAsBytes(firstFileFD);
-        game_info.data = file.data;
-        game_info.size = file.size;
+        gameFile = MappedFile::open(firstFileFD);
+        game_info.data = gameFile->getData();
+        game_info.size = gameFile->getSize();
     }
 
+    invalidateMemoryRegions();
     bool result = core->retro_load_game(&game_info);
     if (!result) {
         LOGE("Cannot load game. Leaving.");
         throw std::runtime_error("Cannot load game");
     }
 
+    if (gameFile) {
+        gameFile->adviseRandomAccess();
+    }
+
     afterGameLoad();
 }
 
+std::vector<VFSFile> LibretroDroid::extractArchive(const VFSFile& archive, const retro_system_info& systemInfo) {
+    static const char* PREFERRED_EXTENSIONS[] = { "m3u", "cue", "gdi", "ccd" };
+
+    ArchiveReader reader(archive.getFD());
+    const auto& entries = reader.getEntries();
+
+    auto isLaunchable = [&](const ArchiveReader::Entry& entry) {
+        return Utils::hasExtension(systemInfo.valid_extensions, Utils::getExtension(entry.name));
+    };
+
+    auto launchEntry = entries.end();
+    for (auto extension : PREFERRED_EXTENSIONS) {
+        launchEntry = std::find_if(entries.begin(), entries.end(), [&](const ArchiveReader::Entry& entry) {
+            return Utils::getExtension(entry.name) == extension && isLaunchable(entry);
+        });
+        if (launchEntry != entries.end()) break;
+    }
+    if (launchEntry == entries.end()) {
+        launchEntry = std::find_if(entries.begin(), entries.end(), isLaunchable);
+    }
+    if (launchEntry == entries.end()) {
+        throw std::runtime_error("Archive does not contain a file supported by this core");
+    }
+
+    auto separator = archive.getFileName().find_last_of('/');
+    std::string directory = separator != std::string::npos ? archive.getFileName().substr(0, separator + 1) : "";
+
+    std::vector<VFSFile> result;
+    result.emplace_back(directory + launchEntry->name, reader.extract(*launchEntry));
+
+    if (systemInfo.need_fullpath) {
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it == launchEntry) continue;
+            result.emplace_back(directory + it->name, reader.extract(*it));
+        }
+    }
+
+    return result;
+}
+
 namespace {
 
 /**
@@ -628,18 +1022,26 @@ void LibretroDroid::destroy() {
     LOGD("Performing libretrodroid destroy");
     ScopedSignalStackGuard signalStackGuard;
 
-    auto contextDestroy = Environment::getInstance().getHwContextDestroy();
+    SessionScope session = enterSession();
+
+    // Before the core frees anything, so readers checking the generation stop in time.
+    invalidateMemoryRegions();
+
+    auto contextDestroy = environment.getHwContextDestroy();
     if (contextDestroy != nullptr && video && video->isHWAccelerated()) {
-        video->bindHWContext();
-        contextDestroy();
-        video->bindMainContext();
+        runWithHWContext(contextDestroy);
     }
+    stopCoreThread();
+    closeMovie();
 
     if (core) {
         core->retro_unload_game();
         core->retro_deinit();
     }
 
+    gameFile = nullptr;
+    diskFiles.clear();
+
     video = nullptr;
     core = nullptr;
     rumble = nullptr;
@@ -651,9 +1053,14 @@ void LibretroDroid::destroy() {
     rewindBuffer.reset();
     rewindTempBuffer.clear();
     rewindTempBuffer.shrink_to_fit();
+    stateBuffer.clear();
+    stateBuffer.shrink_to_fit();
+    sramTracker.reset(nullptr, 0);
+    sramDirtyPages = 0;
+    stateWriter.releaseBuffers();
 
-    Environment::getInstance().deinitialize();
-    VFS::getInstance().deinitialize();
+    environment.deinitialize();
+    vfs.deinitialize();
 }
 
 void LibretroDroid::resume() {
@@ -668,107 +1075,60 @@ void LibretroDroid::resume() {
 
 void LibretroDroid::pause() {
     LOGD("Performing libretrodroid pause");
+    SessionScope session = enterSession();
     audio->stop();
 
     input = nullptr;
 }
 
 void LibretroDroid::step() {
-    if (rewinding && rewindBuffer) {
-        bool hadAudio = audioEnabled;
-        audioEnabled = false;
-
-        unsigned speed = rewindSpeed.load();
-        for (unsigned i = 1; i < speed; i++) {
-            if (!rewindBuffer->discard()) break;
-        }
+    SessionScope session(this);
+    FrameProfiler::Scope frameScope(frameProfiler, FrameProfiler::Stage::FRAME);
 
-        size_t lastSize = 0;
-        bool hasState = rewindBuffer->pop(rewindTempBuffer.data(), &lastSize);
-
-        if (hasState && lastSize > 0) {
-            int8_t* lastData = reinterpret_cast<int8_t*>(rewindTempBuffer.data());
-            core->retro_unserialize(lastData, lastSize);
-            if (video && video->isHWAccelerated()) {
-                video->bindHWContext();
-            }
-            core->retro_run();
-            if (video && video->isHWAccelerated()) {
-                video->bindMainContext();
-            }
-        }
-
-        audioEnabled = hadAudio;
+    if (coreThread) {
+        // Pick up the frames posted at the end of the previous step.
+        FrameProfiler::Scope scope(frameProfiler, FrameProfiler::Stage::CORE_WAIT);
+        coreThread->waitIdle();
     } else {
-        unsigned frames;
-        if (frameSpeed > 1) {
-            frames = frameSpeed;
-        } else {
-            frames = 1;
-            if (fpsSync) {
-                unsigned requestedFrames = fpsSync->advanceFrames();
-                frames = std::min(requestedFrames, 2u);
-            }
-        }
-
-        if (video && video->isHWAccelerated()) {
-            video->bindHWContext();
-        }
-
-        for (size_t i = 0; i < frames; i++) {
-            core->retro_run();
-
-            if (input) {
-                input->flushPendingReleases();
-            }
-        }
-
-        if (rewindEnabled && rewindBuffer) {
-            size_t sz = core->retro_serialize_size();
-            if (sz > 0 && sz <= rewindBuffer->getMaxStateSize()) {
-                if (core->retro_serialize(rewindTempBuffer.data(), sz)) {
-                    rewindBuffer->push(rewindTempBuffer.data(), sz);
-                }
-            }
-        }
-
-        if (video && video->isHWAccelerated()) {
-            video->bindMainContext();
-        }
-    }
-
-    if (achievements.isActive()) {
-        achievements.evaluateFrame();
+        bool rewindStep = rewinding && rewindBuffer;
+        advanceCore(rewindStep, rewindStep ? 0 : framesToRun(), throttleState(rewindStep));
     }
 
     if (video && !video->rendersInVideoCallback()) {
+        FrameProfiler::Scope scope(frameProfiler, FrameProfiler::Stage::RENDER);
         video->renderFrame();
     }
 
     if (fpsSync && frameSpeed <= 1) {
+        FrameProfiler::Scope scope(frameProfiler, FrameProfiler::Stage::FPS_SYNC);
         fpsSync->wait();
     }
 
+    FrameProfiler::Scope environmentScope(frameProfiler, FrameProfiler::Stage::ENVIRONMENT);
+
     if (rumble && rumbleEnabled) {
-        rumble->fetchFromEnvironment();
+        rumble->fetchFromEnvironment(environment);
     }
 
     // Some games override the core geometry at runtime. These fields get updated in retro_run().
-    if (video && Environment::getInstance().isGameMaxGeometryUpdated()) {
-        Environment::getInstance().clearGameMaxGeometryUpdated();
+    if (video && environment.isGameMaxGeometryUpdated()) {
+        environment.clearGameMaxGeometryUpdated();
 
-        video->resizeHWRenderTarget(
-            Environment::getInstance().getGameMaxGeometryWidth(),
-            Environment::getInstance().getGameMaxGeometryHeight()
-        );
+        unsigned maxWidth = environment.getGameMaxGeometryWidth();
+        unsigned maxHeight = environment.getGameMaxGeometryHeight();
+        if (coreThread) {
+            coreThread->runSync([&]() { video->resizeHWRenderTarget(maxWidth, maxHeight); });
+        } else {
+            video->resizeHWRenderTarget(maxWidth, maxHeight);
+        }
     }
 
-    if (video && Environment::getInstance().isGameGeometryUpdated()) {
-        Environment::getInstance().clearGameGeometryUpdated();
+    if (video && environment.isGameGeometryUpdated()) {
+        environment.clearGameGeometryUpdated();
 
-        unsigned geoW = Environment::getInstance().getGameGeometryWidth();
-        unsigned geoH = Environment::getInstance().getGameGeometryHeight();
-        float geoAR = Environment::getInstance().getGameGeometryAspectRatio();
+        unsigned geoW = environment.getGameGeometryWidth();
+        unsigned geoH = environment.getGameGeometryHeight();
+        float geoAR = environment.getGameGeometryAspectRatio();
         LOGI("Runtime geometry update: %ux%u aspect=%.4f", geoW, geoH, geoAR);
 
         video->updateRendererSize(geoW, geoH);
@@ -777,18 +1137,19 @@ void LibretroDroid::step() {
         dirtyVideo = true;
     }
 
-    if (video && Environment::getInstance().isScreenRotationUpdated()) {
-        Environment::getInstance().clearScreenRotationUpdated();
+    if (video && environment.isScreenRotationUpdated()) {
+        environment.clearScreenRotationUpdated();
 
-        video->updateRotation(Environment::getInstance().getScreenRotation());
+        video->updateRotation(environment.getScreenRotation());
     }
 
-    if (audio && fpsSync && Environment::getInstance().isGameTimingUpdated()) {
-        Environment::getInstance().clearGameTimingUpdated();
+    if (audio && fpsSync && environment.isGameTimingUpdated()) {
+        environment.clearGameTimingUpdated();
 
-        double newFps = Environment::getInstance().getGameTimingFps();
-        double newSampleRate = Environment::getInstance().getGameTimingSampleRate();
+        double newFps = environment.getGameTimingFps();
+        double newSampleRate = environment.getGameTimingSampleRate();
 
+        contentFps = newFps;
         fpsSync->updateContentRefreshRate(newFps);
 
         if (bfiEnabled) {
@@ -799,50 +1160,239 @@ void LibretroDroid::step() {
         audio->updateTiming((int32_t) std::lround(effectiveSampleRate), newFps);
         updateAudioSampleRateMultiplier();
     }
+
+    // The core works on the next frames while the GL thread presents this one and swaps.
+    if (coreThread) {
+        bool rewindStep = rewinding && rewindBuffer;
+        unsigned frames = rewindStep ? 0 : framesToRun();
+        struct retro_throttle_state throttle = throttleState(rewindStep);
+        coreThread->post([this, rewindStep, frames, throttle]() { advanceCore(rewindStep, frames, throttle); });
+    }
 }
 
-void LibretroDroid::stepForNetplay() {
-    if (video && video->isHWAccelerated()) {
-        video->bindHWContext();
+unsigned LibretroDroid::framesToRun() {
+    if (frameSpeed > 1) {
+        return frameSpeed;
     }
 
-    core->retro_run();
+    unsigned frames = 1;
+    if (fpsSync) {
+        unsigned requestedFrames = fpsSync->advanceFrames();
+        frames = std::min(requestedFrames, 2u);
+    }
+    return frames;
+}
 
-    if (input) {
-        input->flushPendingReleases();
+struct retro_throttle_state LibretroDroid::throttleState(bool rewindStep) const {
+    struct retro_throttle_state state {RETRO_THROTTLE_NONE, static_cast<float>(contentFps)};
+    if (rewindStep) {
+        state.mode = RETRO_THROTTLE_REWINDING;
+    } else if (frameSpeed > 1) {
+        state.mode = RETRO_THROTTLE_FAST_FORWARD;
+        state.rate = static_cast<float>(contentFps * frameSpeed);
+    } else if (fpsSync && fpsSync->isUsingVSync() && screenRefreshRate < contentFps) {
+        state.mode = RETRO_THROTTLE_VSYNC;
+        state.rate = screenRefreshRate;
+    }
+    return state;
+}
+
+// Real time between runs at normal speed, the core's reference while fast-forwarding or
+// rewinding. Catch-up frames share the elapsed time, and gaps such as a pause fall back to the
+// reference so the core does not jump ahead.
+retro_usec_t LibretroDroid::frameTimeDelta(const struct retro_throttle_state& throttle, unsigned frames) {
+    retro_usec_t reference = environment.getFrameTimeCallback().reference;
+    auto now = std::chrono::steady_clock::now();
+
+    retro_usec_t delta = reference;
+    bool realTime = throttle.mode == RETRO_THROTTLE_NONE || throttle.mode == RETRO_THROTTLE_VSYNC;
+    if (realTime && lastCoreRun != TimePoint() && frames > 0) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - lastCoreRun).count() / frames;
+        if (elapsed > 0 && elapsed < reference * 4) {
+            delta = elapsed;
+        }
     }
 
-    if (video && video->isHWAccelerated()) {
-        video->bindMainContext();
+    lastCoreRun = realTime ? now : TimePoint();
+    return delta;
+}
+
+void LibretroDroid::advanceCore(bool rewindStep, unsigned frames, struct retro_throttle_state throttle) {
+    if (audioResetPending.exchange(false) && audio) {
+        audio->resetBufferState();
+    }
+
+    // On the core thread the HW context is permanently current.
+    bool bindContext = !coreThread && video && video->isHWAccelerated();
+
+    environment.setThrottleState(throttle);
+    retro_frame_time_callback_t frameTimeCallback = environment.getFrameTimeCallback().callback;
+    retro_usec_t frameTime = frameTimeCallback ? frameTimeDelta(throttle, rewindStep ? 1 : frames) : 0;
+
+    if (rewindStep) {
+        audioMuted = true;
+
+        size_t lastSize = 0;
+        bool hasState;
+        {
+            FrameProfiler::Scope scope(frameProfiler, FrameProfiler::Stage::REWIND);
+            unsigned speed = rewindSpeed.load();
+            for (unsigned i = 1; i < speed; i++) {
+                if (!rewindBuffer->discard()) break;
+            }
+
+            hasState = rewindBuffer->pop(rewindTempBuffer.data(), &lastSize);
+            if (hasState && lastSize > 0) {
+                core->retro_unserialize(rewindTempBuffer.data(), lastSize);
+            }
+        }
+
+        if (hasState && lastSize > 0) {
+            if (bindContext) {
+                video->bindHWContext();
+            }
+            FrameProfiler::Scope scope(frameProfiler, FrameProfiler::Stage::CORE_RUN);
+            if (video) video->beginHWFrame();
+            setAudioVideoEnable(true);
+            if (frameTimeCallback) frameTimeCallback(frameTime);
+            reportAudioBufferStatus();
+            core->retro_run();
+            if (video) video->endHWFrame();
+            if (bindContext) {
+                video->bindMainContext();
+            }
+        }
+
+        audioMuted = false;
+    } else {
+        if (bindContext) {
+            video->bindHWContext();
+        }
+
+        {
+            FrameProfiler::Scope scope(frameProfiler, FrameProfiler::Stage::CORE_RUN);
+            if (video) video->beginHWFrame();
+            for (size_t i = 0; i < frames; i++) {
+                // Only the last frame is shown, so fast-forward lets the core skip rendering the rest.
+                setAudioVideoEnable(i + 1 == frames);
+                advanceMovie();
+                if (frameTimeCallback) frameTimeCallback(frameTime);
+                reportAudioBufferStatus();
+                core->retro_run();
+
+                if (input) {
+                    input->flushPendingReleases();
+                }
+            }
+            if (video) video->endHWFrame();
+        }
+
+        if (rewindEnabled && rewindBuffer) {
+            FrameProfiler::Scope scope(frameProfiler, FrameProfiler::Stage::REWIND);
+            size_t sz = core->retro_serialize_size();
+            if (sz > 0 && sz <= rewindBuffer->getMaxStateSize()) {
+                if (core->retro_serialize(rewindTempBuffer.data(), sz)) {
+                    rewindBuffer->push(rewindTempBuffer.data(), sz);
+                }
+            }
+        }
+
+        if (bindContext) {
+            video->bindMainContext();
+        }
+    }
+
+    // Resizing here, on the thread that writes samples, keeps the stream swap away from writes.
+    if (environment.isMinimumAudioLatencyUpdated()) {
+        environment.clearMinimumAudioLatencyUpdated();
+        if (audio) {
+            audio->setMinimumLatency(environment.getMinimumAudioLatency());
+        }
     }
 
     if (achievements.isActive()) {
+        FrameProfiler::Scope scope(frameProfiler, FrameProfiler::Stage::ACHIEVEMENTS);
         achievements.evaluateFrame();
     }
 
+    scanSRAM(rewindStep ? 1 : frames);
+}
+
+void LibretroDroid::reportAudioBufferStatus() {
+    retro_audio_buffer_status_callback_t callback = environment.getAudioBufferStatusCallback();
+    if (callback == nullptr) return;
+
+    if (audio && isAudioOutputEnabled()) {
+        callback(true, audio->getBufferOccupancy(), audio->consumeUnderrun());
+    } else {
+        callback(false, 0, false);
+    }
+}
+
+// Audio stays on for skipped frames while it is being played, since fast-forward audio is
+// time-stretched from the output of every frame.
+void LibretroDroid::setAudioVideoEnable(bool video) {
+    unsigned flags = 0;
+    if (video) flags |= Environment::AV_ENABLE_VIDEO;
+    if (isAudioOutputEnabled()) flags |= Environment::AV_ENABLE_AUDIO;
+    environment.setAudioVideoEnable(flags);
+}
+
+bool LibretroDroid::isAudioOutputEnabled() const {
+    return audioEnabled.load(std::memory_order_relaxed) && !audioMuted;
+}
+
+void LibretroDroid::stepForNetplay() {
+    SessionScope session = enterSession();
+
+    runWithHWContext([this]() {
+        advanceMovie();
+        if (video) video->beginHWFrame();
+        setAudioVideoEnable(true);
+        environment.setThrottleState(throttleState(false));
+        auto frameTimeCallback = environment.getFrameTimeCallback();
+        if (frameTimeCallback.callback) frameTimeCallback.callback(frameTimeCallback.reference);
+        reportAudioBufferStatus();
+        core->retro_run();
+        if (video) video->endHWFrame();
+
+        if (input) {
+            input->flushPendingReleases();
+        }
+    });
+
+    if (achievements.isActive()) {
+        achievements.evaluateFrame();
+    }
+
+    scanSRAM(1);
+
     if (video && !video->rendersInVideoCallback()) {
         video->renderFrame();
     }
 
     if (rumble && rumbleEnabled) {
-        rumble->fetchFromEnvironment();
+        rumble->fetchFromEnvironment(environment);
     }
 
-    if (video && Environment::getInstance().isGameMaxGeometryUpdated()) {
-        Environment::getInstance().clearGameMaxGeometryUpdated();
+    if (video && environment.isGameMaxGeometryUpdated()) {
+        environment.clearGameMaxGeometryUpdated();
 
-        video->resizeHWRenderTarget(
-            Environment::getInstance().getGameMaxGeometryWidth(),
-            Environment::getInstance().getGameMaxGeometryHeight()
-        );
+        unsigned maxWidth = environment.getGameMaxGeometryWidth();
+        unsigned maxHeight = environment.getGameMaxGeometryHeight();
+        if (coreThread) {
+            coreThread->runSync([&]() { video->resizeHWRenderTarget(maxWidth, maxHeight); });
+        } else {
+            video->resizeHWRenderTarget(maxWidth, maxHeight);
+        }
     }
 
-    if (video && Environment::getInstance().isGameGeometryUpdated()) {
-        Environment::getInstance().clearGameGeometryUpdated();
+    if (video && environment.isGameGeometryUpdated()) {
+        environment.clearGameGeometryUpdated();
 
-        unsigned geoW = Environment::getInstance().getGameGeometryWidth();
-        unsigned geoH = Environment::getInstance().getGameGeometryHeight();
-        float geoAR = Environment::getInstance().getGameGeometryAspectRatio();
+        unsigned geoW = environment.getGameGeometryWidth();
+        unsigned geoH = environment.getGameGeometryHeight();
+        float geoAR = environment.getGameGeometryAspectRatio();
         LOGI("Runtime geometry update: %ux%u aspect=%.4f", geoW, geoH, geoAR);
 
         video->updateRendererSize(geoW, geoH);
@@ -851,17 +1401,17 @@ void LibretroDroid::stepForNetplay() {
         dirtyVideo = true;
     }
 
-    if (video && Environment::getInstance().isScreenRotationUpdated()) {
-        Environment::getInstance().clearScreenRotationUpdated();
+    if (video && environment.isScreenRotationUpdated()) {
+        environment.clearScreenRotationUpdated();
 
-        video->updateRotation(Environment::getInstance().getScreenRotation());
+        video->updateRotation(environment.getScreenRotation());
     }
 
-    if (audio && fpsSync && Environment::getInstance().isGameTimingUpdated()) {
-        Environment::getInstance().clearGameTimingUpdated();
+    if (audio && fpsSync && environment.isGameTimingUpdated()) {
+        environment.clearGameTimingUpdated();
 
-        double newFps = Environment::getInstance().getGameTimingFps();
-        double newSampleRate = Environment::getInstance().getGameTimingSampleRate();
+        double newFps = environment.getGameTimingFps();
+        double newSampleRate = environment.getGameTimingSampleRate();
 
         fpsSync->updateContentRefreshRate(newFps);
 
@@ -884,6 +1434,7 @@ void LibretroDroid::setRewindSpeed(unsigned int speed) {
 }
 
 void LibretroDroid::initRewindBuffer(int maxSlots, jlong budgetBytes) {
+    SessionScope session = enterSession();
     constexpr size_t MIN_SLOTS = 4;
 
     size_t stateSize = core->retro_serialize_size();
@@ -916,6 +1467,7 @@ void LibretroDroid::initRewindBuffer(int maxSlots, jlong budgetBytes) {
 }
 
 void LibretroDroid::destroyRewindBuffer() {
+    SessionScope session = enterSession();
     rewindEnabled = false;
     rewinding = false;
     rewindBuffer.reset();
@@ -924,6 +1476,7 @@ void LibretroDroid::destroyRewindBuffer() {
 }
 
 void LibretroDroid::clearRewindBuffer() {
+    SessionScope session = enterSession();
     if (rewindBuffer) {
         rewindBuffer->clear();
     }
@@ -948,7 +1501,7 @@ void LibretroDroid::renderFrameOnly() {
 }
 
 float LibretroDroid::getAspectRatio() {
-    float gameAspectRatio = Environment::getInstance().retrieveGameSpecificAspectRatio();
+    float gameAspectRatio = environment.retrieveGameSpecificAspectRatio();
     return gameAspectRatio > 0 ? gameAspectRatio : defaultAspectRatio;
 }
 
@@ -957,10 +1510,27 @@ void LibretroDroid::refreshAspectRatio() {
 }
 
 void LibretroDroid::setAspectRatioOverride(float ratio) {
-    Environment::getInstance().setAspectRatioOverride(ratio);
+    environment.setAspectRatioOverride(ratio);
     refreshAspectRatio();
 }
 
+void LibretroDroid::setThreadedHWRendering(bool enabled) {
+    threadedHWRendering = enabled;
+}
+
+void LibretroDroid::setThreadedVideo(bool enabled) {
+    threadedVideo = enabled;
+}
+
+void LibretroDroid::setFrameProfiling(bool enabled, bool traceSections) {
+    frameProfiler.setTraceSections(traceSections);
+    frameProfiler.setEnabled(enabled);
+}
+
+std::string LibretroDroid::getFrameProfile(bool reset) {
+    return frameProfiler.snapshot(reset);
+}
+
 void LibretroDroid::setRumbleEnabled(bool enabled) {
     rumbleEnabled = enabled;
 }
@@ -970,13 +1540,13 @@ bool LibretroDroid::isRumbleEnabled() const {
 }
 
 void LibretroDroid::setFrameSpeed(unsigned int speed) {
-    unsigned int oldSpeed = frameSpeed;
-    frameSpeed = speed;
+    unsigned int oldSpeed = frameSpeed.exchange(speed);
     if (fpsSync && speed <= 1) {
         fpsSync->reset();
     }
-    if (audio && oldSpeed != speed) {
-        audio->resetBufferState();
+    // The core may be writing audio right now, so the buffers are reset before its next frame.
+    if (oldSpeed != speed) {
+        audioResetPending = true;
     }
     updateAudioSampleRateMultiplier();
 }
@@ -1054,6 +1624,11 @@ void LibretroDroid::handleVideoRefresh(
     unsigned int height,
     size_t pitch
 ) {
+    // Cores that ignore GET_AUDIO_VIDEO_ENABLE still render skipped frames; don't upload them.
+    if ((environment.getAudioVideoEnable() & Environment::AV_ENABLE_VIDEO) == 0) {
+        return;
+    }
+
     if (video) {
         video->onNewFrame(data, width, height, pitch);
 
@@ -1064,7 +1639,7 @@ void LibretroDroid::handleVideoRefresh(
 }
 
 size_t LibretroDroid::handleAudioCallback(const int16_t *data, size_t frames) {
-    if (audio && audioEnabled) {
+    if (audio && isAudioOutputEnabled()) {
         audio->write(data, frames);
     }
     return frames;
@@ -1090,15 +1665,18 @@ uintptr_t LibretroDroid::handleGetCurrentFrameBuffer() {
 }
 
 void LibretroDroid::reset() {
+    SessionScope session = enterSession();
     ScopedSignalStackGuard signalStackGuard;
     core->retro_reset();
 }
 
 size_t LibretroDroid::getSerializeSize() {
+    SessionScope session = enterSession();
     return core->retro_serialize_size();
 }
 
 std::pair<int8_t*, size_t> LibretroDroid::serializeState() {
+    SessionScope session = enterSession();
     size_t size = core->retro_serialize_size();
     if (size == 0) {
         return std::pair(nullptr, 0);
@@ -1113,11 +1691,264 @@ std::pair<int8_t*, size_t> LibretroDroid::serializeState() {
     return std::pair(data, size);
 }
 
+size_t LibretroDroid::getCompressedStateBound() {
+    SessionScope session = enterSession();
+    return StateContainer::maxContainerSize(core->retro_serialize_size());
+}
+
+bool LibretroDroid::serializeCompressedState(const StateContainer::Sink& sink) {
+    SessionScope session = enterSession();
+    size_t size = core->retro_serialize_size();
+    if (size == 0) {
+        LOGE("serializeCompressedState: core reports no serialization support");
+        return false;
+    }
+
+    stateBuffer.resize(size);
+    if (!core->retro_serialize(stateBuffer.data(), size)) {
+        LOGE("serializeCompressedState: core failed to serialize");
+        return false;
+    }
+
+    struct retro_system_info system_info {};
+    core->retro_get_system_info(&system_info);
+
+    return StateContainer::write(stateBuffer.data(), size, system_info.library_name, sink);
+}
+
+bool LibretroDroid::unserializeCompressedState(const StateContainer::Source& source) {
+    SessionScope session = enterSession();
+    StateContainer::Header header {};
+    if (!StateContainer::readHeader(source, header)) {
+        return false;
+    }
+
+    struct retro_system_info system_info {};
+    core->retro_get_system_info(&system_info);
+
+    std::string coreId = std::string(system_info.library_name).substr(0, StateContainer::CORE_ID_SIZE);
+    if (header.coreId != coreId) {
+        LOGE("unserializeCompressedState: state was saved by %s, not %s", header.coreId.c_str(), coreId.c_str());
+        return false;
+    }
+
+    // Persisted states may come from another core version, so only a clearly wrong size is refused.
+    size_t currentSize = core->retro_serialize_size();
+    if (currentSize > 0 && header.stateSize > currentSize * 2) {
+        LOGE("unserializeCompressedState: state size %llu does not fit a %zu byte core state",
+             (unsigned long long) header.stateSize, currentSize);
+        return false;
+    }
+
+    stateBuffer.resize(header.stateSize);
+    if (!StateContainer::readState(source, header, stateBuffer.data())) {
+        return false;
+    }
+
+    return unserializePersistedState(reinterpret_cast<int8_t*>(stateBuffer.data()), stateBuffer.size());
+}
+
+bool LibretroDroid::startMovieRecording(int fd) {
+    SessionScope session = enterSession();
+    closeMovie();
+
+    size_t size = core->retro_serialize_size();
+    stateBuffer.resize(size);
+    if (size == 0 || !core->retro_serialize(stateBuffer.data(), size)) {
+        LOGE("startMovieRecording: core failed to serialize the anchor state");
+        return false;
+    }
+
+    movieFd = dup(fd);
+    if (movieFd < 0) {
+        LOGE("startMovieRecording: unable to duplicate descriptor (errno %d)", errno);
+        return false;
+    }
+
+    int target = movieFd;
+    movieWriter = std::make_unique<InputMovieWriter>([target](const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t count = write(target, data, size);
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) return false;
+            data += count;
+            size -= count;
+        }
+        return true;
+    });
+
+    struct retro_system_info system_info {};
+    core->retro_get_system_info(&system_info);
+
+    if (!movieWriter->begin(stateBuffer.data(), size, system_info.library_name)) {
+        closeMovie();
+        return false;
+    }
+    return true;
+}
+
+bool LibretroDroid::stopMovieRecording() {
+    SessionScope session = enterSession();
+    return movieWriter && closeMovie();
+}
+
+bool LibretroDroid::startMoviePlayback(int fd) {
+    SessionScope session = enterSession();
+    closeMovie();
+
+    movieFd = dup(fd);
+    if (movieFd < 0) {
+        LOGE("startMoviePlayback: unable to duplicate descriptor (errno %d)", errno);
+        return false;
+    }
+
+    int source = movieFd;
+    movieReader = std::make_unique<InputMovieReader>([source](uint8_t* data, size_t size) -> ssize_t {
+        ssize_t count;
+        do {
+            count = read(source, data, size);
+        } while (count < 0 && errno == EINTR);
+        return count;
+    });
+
+    StateContainer::Header header {};
+    if (!movieReader->open(header, stateBuffer)) {
+        closeMovie();
+        return false;
+    }
+
+    struct retro_system_info system_info {};
+    core->retro_get_system_info(&system_info);
+
+    std::string coreId = std::string(system_info.library_name).substr(0, StateContainer::CORE_ID_SIZE);
+    if (header.coreId != coreId) {
+        LOGE("startMoviePlayback: movie was recorded with %s, not %s", header.coreId.c_str(), coreId.c_str());
+        closeMovie();
+        return false;
+    }
+
+    // Input only reproduces the run from exactly the state it was recorded against.
+    if (!unserializeStateWithPolicy(
+            reinterpret_cast<int8_t*>(stateBuffer.data()), stateBuffer.size(), StateLoadPolicy::StrictSize)) {
+        closeMovie();
+        return false;
+    }
+    return true;
+}
+
+void LibretroDroid::stopMoviePlayback() {
+    SessionScope session = enterSession();
+    if (movieReader) closeMovie();
+}
+
+int LibretroDroid::getMovieState() {
+    SessionScope session = enterSession();
+    if (movieWriter) return MOVIE_RECORDING;
+    if (movieReader) return MOVIE_PLAYING;
+    return MOVIE_IDLE;
+}
+
+uint64_t LibretroDroid::getMovieFrame() {
+    SessionScope session = enterSession();
+    if (movieWriter) return movieWriter->getFrameCount();
+    if (movieReader) return movieReader->getFrameCount();
+    return 0;
+}
+
+// Runs the loaded game flat out with nothing presented or played, so the numbers reflect the core
+// alone. The game really advances; rewind, movies and achievements skip these frames.
+CoreBenchmark::Result LibretroDroid::runBenchmark(uint32_t frames, int8_t* state, size_t stateSize) {
+    SessionScope session = enterSession();
+
+    if (state != nullptr && stateSize > 0 && !unserializeState(state, stateSize)) {
+        LOGE("runBenchmark: unable to load the starting state");
+        return CoreBenchmark::Result();
+    }
+
+    CoreBenchmark benchmark(frames);
+
+    runWithHWContext([&]() {
+        ScopedSignalStackGuard signalStackGuard;
+        audioMuted = true;
+        environment.setThrottleState({RETRO_THROTTLE_UNBLOCKED, 0.0f});
+        setAudioVideoEnable(false);
+        const auto& frameTime = environment.getFrameTimeCallback();
+
+        if (video) video->beginHWFrame();
+        for (uint32_t i = 0; i < frames; i++) {
+            auto start = std::chrono::steady_clock::now();
+            if (frameTime.callback) frameTime.callback(frameTime.reference);
+            core->retro_run();
+            benchmark.recordFrame(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+        if (video) video->endHWFrame();
+
+        audioMuted = false;
+        setAudioVideoEnable(true);
+    });
+
+    if (fpsSync) fpsSync->reset();
+    if (audio) audio->resetBufferState();
+    lastCoreRun = TimePoint();
+
+    CoreBenchmark::Result result = benchmark.finish();
+    LOGI("Benchmark: %u frames at %.1f fps, p99 %.0f us, drift %.1f%%",
+         result.frames, result.emulatedFps, result.frameP99Us, result.driftPercent);
+    return result;
+}
+
+// Called before every forward retro_run, on whichever thread runs the core.
+void LibretroDroid::advanceMovie() {
+    if (!input) return;
+
+    if (movieReader) {
+        Input::Snapshot snapshot;
+        if (movieReader->readFrame(snapshot)) {
+            input->setPlaybackSnapshot(snapshot);
+        } else {
+            LOGI("Input movie finished after %llu frames", (unsigned long long) movieReader->getFrameCount());
+            closeMovie();
+        }
+    }
+
+    if (movieWriter) {
+        // Live input can change while the core polls, so it gets the frame's recorded input.
+        Input::Snapshot snapshot;
+        input->pinLiveSnapshot(snapshot);
+        if (!movieWriter->writeFrame(snapshot)) {
+            LOGE("Input movie recording stopped after a write failure");
+            closeMovie();
+        }
+    }
+}
+
+bool LibretroDroid::closeMovie() {
+    bool result = true;
+    if (movieWriter) {
+        result = movieWriter->finish();
+        LOGI("Input movie recorded %llu frames", (unsigned long long) movieWriter->getFrameCount());
+        movieWriter.reset();
+        if (input) input->clearPlaybackSnapshot();
+    }
+    if (movieReader) {
+        movieReader.reset();
+        if (input) input->clearPlaybackSnapshot();
+    }
+    if (movieFd >= 0) {
+        close(movieFd);
+        movieFd = -1;
+    }
+    return result;
+}
+
 void LibretroDroid::resetCheat() {
+    SessionScope session = enterSession();
     core->retro_cheat_reset();
 }
 
 void LibretroDroid::setCheat(unsigned index, bool enabled, const std::string& code) {
+    SessionScope session = enterSession();
     core->retro_cheat_set(index, enabled, Utils::cloneToCString(code));
 }
 
@@ -1134,6 +1965,8 @@ void LibretroDroid::afterGameLoad() {
     core->retro_get_system_av_info(&system_av_info);
 
     contentFps = system_av_info.timing.fps;
+    lastCoreRun = TimePoint();
+    environment.setThrottleState({RETRO_THROTTLE_NONE, static_cast<float>(contentFps)});
     fpsSync = std::make_unique<FPSSync>(system_av_info.timing.fps, screenRefreshRate, forceSoftwareTiming);
 
     if (bfiEnabled) {
@@ -1149,12 +1982,19 @@ void LibretroDroid::afterGameLoad() {
     );
     audio->setPitchPreservation(pitchPreservationEnabled);
     audio->setOutputVolume(audioVolume);
+    // Cores may ask for more latency while loading, before there was a stream to resize.
+    environment.clearMinimumAudioLatencyUpdated();
+    audio->setMinimumLatency(environment.getMinimumAudioLatency());
 
     updateAudioSampleRateMultiplier();
 
     defaultAspectRatio = findDefaultAspectRatio(system_av_info);
 
-    auto& controllers = Environment::getInstance().getControllers();
+    // Until the app loads a save over it, the save RAM the core starts with counts as flushed.
+    resetSRAMTracking();
+    invalidateMemoryRegions();
+
+    auto& controllers = environment.getControllers();
     for (unsigned port = 0; port < controllers.size() && port < 4; port++) {
         unsigned deviceType = RETRO_DEVICE_JOYPAD;
         for (const auto& ctrl : controllers[port]) {
@@ -1202,10 +2042,10 @@ void LibretroDroid::setTextureCrop(float left, float top, float right, float bot
 }
 
 void LibretroDroid::initAchievements(const std::vector<AchievementDef>& achievementDefs, uint32_t consoleId) {
-    Achievements::setCore(core.get());
+    achievements.setCore(core.get());
     achievements.init(achievementDefs);
 
-    const struct retro_memory_map* mmap = Environment::getInstance().getMemoryMap();
+    const struct retro_memory_map* mmap = environment.getMemoryMap();
     achievements.initMemory(consoleId, mmap);
 }
 
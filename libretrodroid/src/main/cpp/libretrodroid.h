@@ -42,47 +42,124 @@
 #include "shadermanager.h"
 #include "utils/javautils.h"
 #include "environment.h"
+#include "vfs/vfs.h"
 #include "vfs/vfsfile.h"
 #include "renderers/es3/framebufferrenderer.h"
 #include "renderers/es2/imagerendereres2.h"
 #include "renderers/es3/imagerendereres3.h"
 #include "utils/rect.h"
+#include "utils/mappedfile.h"
 #include "rewindbuffer.h"
 #include "stateloadpolicy.h"
+#include "statecontainer.h"
+#include "corethread.h"
+#include "frameprofiler.h"
+#include "inputmovie.h"
+#include "corebenchmark.h"
+#include "sramtracker.h"
+#include "statewriter.h"
+#include "memorysearch.h"
 
 namespace libretrodroid {
 
+/**
+ * One emulation session: a core with its own environment, file system and rendering state.
+ * Libretro callbacks are plain functions, so every entry point binds the calling thread to its
+ * session for the duration of the call and the callbacks look the binding up.
+ */
 class LibretroDroid {
 public:
-    static LibretroDroid& getInstance()
-    {
-        static LibretroDroid instance;
-        return instance;
-    }
+    /**
+     * The session bound to the calling thread, else the default one the Java API drives. Extra
+     * sessions are constructed directly and need a core library of their own, since two
+     * instances of one dlopen'ed core would share its globals.
+     */
+    static LibretroDroid& getInstance();
+
+    LibretroDroid() {}
     LibretroDroid(LibretroDroid const&) = delete;
     void operator=(LibretroDroid const&) = delete;
 
-    void setViewport(Rect viewportRect);
+    Environment& getEnvironment() { return environment; }
 
-private:
-    LibretroDroid() {}
+    void setViewport(Rect viewportRect);
 
-public:
     void setCheat(unsigned index, bool enabled, const std::string& code);
     void resetCheat();
 
     std::pair<int8_t*, size_t> serializeState();
     size_t getSerializeSize();
     bool unserializeState(int8_t *data, size_t size);
+
+    /**
+     * Serialize into a reusable native buffer and write it to fd on a background thread, then
+     * sync it. Emulation only waits for the core to serialize. Returns a ticket for
+     * pollStateWrite, or -1 if no state was taken.
+     */
+    int serializeStateToFd(int fd);
+    StateWriter::Status pollStateWrite(int ticket);
+    bool unserializeStateFromFd(int fd);
     bool unserializePersistedState(int8_t *data, size_t size);
 
+    size_t getCompressedStateBound();
+    bool serializeCompressedState(const StateContainer::Sink& sink);
+    bool unserializeCompressedState(const StateContainer::Source& source);
+
+    static constexpr int MOVIE_IDLE = 0;
+    static constexpr int MOVIE_RECORDING = 1;
+    static constexpr int MOVIE_PLAYING = 2;
+
+    bool startMovieRecording(int fd);
+    bool stopMovieRecording();
+    bool startMoviePlayback(int fd);
+    void stopMoviePlayback();
+    int getMovieState();
+    uint64_t getMovieFrame();
+
+    CoreBenchmark::Result runBenchmark(uint32_t frames, int8_t* state, size_t stateSize);
+
     std::pair<int8_t *, size_t> serializeSRAM();
     jboolean unserializeSRAM(int8_t *data, size_t size);
 
+    /** Compare save RAM with what was last flushed every frames frames, 0 to only do so on flush. */
+    void setSRAMScanInterval(unsigned frames);
+    /** Pages changed since the last flush, as of the last scan. Does not wait for the core. */
+    size_t getSRAMDirtyPageCount() const;
+    /**
+     * Write the save RAM pages changed since the last flush or load into fd, then sync it. A file
+     * that is not exactly the save RAM's size, like a fresh one to rename over the old, gets all
+     * of it. Returns the number of bytes written, or -1 on failure.
+     */
+    int64_t flushSRAM(int fd);
+    /** Forget what earlier flushes wrote, so the next one writes all of the save RAM. */
+    void markSRAMDirty();
+
     std::pair<int8_t *, size_t> getMemoryData(unsigned int memoryType);
     size_t getMemorySize(unsigned int memoryType);
 
+    /**
+     * Core memory handed out in place instead of copied. It stays valid while the game is loaded;
+     * the generation changes on every load and unload, after which old regions must not be read.
+     */
+    struct MemoryRegion {
+        uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+    uint32_t getMemoryGeneration() const;
+    MemoryRegion getMemoryRegion(unsigned memoryType);
+    /** The regions of the memory map the core set, in the order of its descriptors. */
+    std::vector<retro_memory_descriptor> getMemoryMapDescriptors();
+    MemoryRegion getMemoryMapRegion(size_t index);
+
+    /** Search a memory type, or with mapped a memory map descriptor. Returns the candidates or -1. */
+    int64_t beginMemorySearch(bool mapped, unsigned index, unsigned width);
+    int64_t filterMemorySearch(MemorySearch::Comparison comparison, bool againstValue, uint32_t value);
+    std::vector<uint32_t> getMemorySearchResults(size_t skip, size_t max);
+    void endMemorySearch();
+
     std::vector<uint8_t> captureRawFrame(int& outWidth, int& outHeight);
+    int requestFrameCapture();
+    FrameReadback::Status pollFrameCapture(int ticket, FrameReadback::Capture& capture);
 
     void onSurfaceCreated();
     void onSurfaceChanged(unsigned int width, unsigned int height);
@@ -141,6 +218,12 @@ public:
     void changeDisk(unsigned int index);
     void changeDisk(unsigned int index, const std::string& path);
 
+    void setThreadedHWRendering(bool enabled);
+    void setThreadedVideo(bool enabled);
+
+    void setFrameProfiling(bool enabled, bool traceSections);
+    std::string getFrameProfile(bool reset);
+
     void setRumbleEnabled(bool enabled);
     bool isRumbleEnabled() const;
     void handleRumbleUpdates(const std::function<void(int, float, float)> &handler);
@@ -185,10 +268,47 @@ public:
     uintptr_t handleGetCurrentFrameBuffer();
 
 private:
+    /** Binds the calling thread to a session, restoring the previous binding when it ends. */
+    class SessionScope {
+    public:
+        explicit SessionScope(LibretroDroid* session);
+        ~SessionScope();
+
+        SessionScope(const SessionScope&) = delete;
+        SessionScope& operator=(const SessionScope&) = delete;
+
+    private:
+        LibretroDroid* previous;
+        Environment* previousEnvironment;
+        VFS* previousVFS;
+    };
+
+    /** Waits for the core thread, then binds the calling thread to this session. */
+    SessionScope enterSession();
+    void bindToCurrentThread();
+
     bool unserializeStateWithPolicy(int8_t *data, size_t size, StateLoadPolicy policy);
     void updateAudioSampleRateMultiplier();
     float findDefaultAspectRatio(const retro_system_av_info &system_av_info);
     void afterGameLoad();
+    unsigned framesToRun();
+    struct retro_throttle_state throttleState(bool rewindStep) const;
+    void advanceCore(bool rewindStep, unsigned frames, struct retro_throttle_state throttle);
+    retro_usec_t frameTimeDelta(const struct retro_throttle_state& throttle, unsigned frames);
+    void advanceMovie();
+    void setAudioVideoEnable(bool video);
+    bool isAudioOutputEnabled() const;
+    void reportAudioBufferStatus();
+    void resetSRAMTracking();
+    MemoryRegion resolveMemoryRegion(bool mapped, unsigned index);
+    void invalidateMemoryRegions();
+    void scanSRAM(unsigned frames);
+    bool closeMovie();
+    void startCoreThread();
+    void stopCoreThread();
+    void syncCoreThread();
+    void runWithHWContext(const std::function<void()>& task);
+    std::vector<VFSFile> extractArchive(const VFSFile& archive, const retro_system_info& systemInfo);
 
 protected:
     static void callback_hw_video_refresh(const void *data, unsigned width, unsigned height, size_t pitch);
@@ -199,20 +319,49 @@ protected:
     static void callback_retro_set_input_poll();
 
 private:
-    unsigned int frameSpeed = 1;
-    bool audioEnabled = true;
+    // Set from the UI thread and read wherever the core runs.
+    std::atomic<unsigned int> frameSpeed{1};
+    std::atomic<bool> audioEnabled{true};
+    std::atomic<bool> audioResetPending{false};
+    // Mutes the core's audio during rewind and benchmarks without touching the user's setting.
+    // Only used by the thread running the core.
+    bool audioMuted = false;
     bool pitchPreservationEnabled = false;
     float audioVolume = 1.0f;
     bool preferLowLatencyAudio = false;
     bool forceSoftwareTiming = false;
     bool rumbleEnabled = false;
+    bool threadedHWRendering = false;
+    bool threadedVideo = false;
 
     std::unique_ptr<RewindBuffer> rewindBuffer;
     std::vector<uint8_t> rewindTempBuffer;
+    std::vector<uint8_t> stateBuffer;
+    StateWriter stateWriter;
+
+    // Bumped whenever regions handed out by getMemoryRegion stop being valid.
+    std::atomic<uint32_t> memoryGeneration{0};
+    MemorySearch memorySearch;
+    bool memorySearchMapped = false;
+    unsigned memorySearchIndex = 0;
+    uint32_t memorySearchGeneration = 0;
     std::atomic<bool> rewindEnabled{false};
     std::atomic<bool> rewinding{false};
     std::atomic<unsigned int> rewindSpeed{1};
+
+    // Input movie being recorded or played back, and the descriptor it streams through.
+    std::unique_ptr<InputMovieWriter> movieWriter;
+    std::unique_ptr<InputMovieReader> movieReader;
+    int movieFd = -1;
     double contentFps = 60.0;
+    // When the core last ran, for the deltas passed to its frame time callback. Core thread only.
+    TimePoint lastCoreRun;
+
+    // Save RAM pages that differ from the save file, scanned on the core thread.
+    SramTracker sramTracker;
+    unsigned sramScanInterval = 0;
+    unsigned framesUntilSRAMScan = 0;
+    std::atomic<size_t> sramDirtyPages{0};
 
     ShaderManager::Config fragmentShaderConfig = ShaderManager::Config {
         ShaderManager::Type::SHADER_DEFAULT, { }
@@ -231,6 +380,9 @@ private:
     float defaultAspectRatio = 1.0;
     bool dirtyVideo = false;
 
+    Environment environment;
+    VFS vfs;
+
     std::unique_ptr<Core> core;
     std::unique_ptr<Audio> audio;
     std::unique_ptr<Video> video;
@@ -238,6 +390,15 @@ private:
     std::unique_ptr<Input> input;
     std::unique_ptr<Rumble> rumble;
     Achievements achievements;
+
+    // Owns all core calls while the core runs apart from the GL thread (threaded HW or video).
+    std::unique_ptr<CoreThread> coreThread;
+
+    FrameProfiler frameProfiler;
+
+    // Content buffers passed to the core, kept alive until retro_unload_game has run.
+    std::unique_ptr<MappedFile> gameFile;
+    std::vector<std::unique_ptr<MappedFile>> diskFiles;
 };
 
 } //namespace libretrodroid
@@ -26,6 +26,9 @@
 #include <mutex>
 #include <optional>
 
+#include <cerrno>
+#include <unistd.h>
+
 #include "libretrodroid.h"
 #include "log.h"
 #include "core.h"
@@ -45,6 +48,14 @@
 #include "utils/jnistring.h"
 #include "achievements_test.h"
 #include "stateloadpolicy_test.h"
+#include "statecontainer_test.h"
+#include "pixelconversion_test.h"
+#include "inputmovie_test.h"
+#include "sramtracker_test.h"
+#include "statewriter_test.h"
+#include "memorysearch_test.h"
+#include "blurschedule_test.h"
+#include "romhasher.h"
 #include <rc_hash.h>
 
 namespace libretrodroid {
@@ -95,7 +106,7 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_updateVari
     jobject variable
 ) {
     Variable v = JavaUtils::variableFromJava(env, variable);
-    Environment::getInstance().updateVariable(v.key, v.value);
+    LibretroDroid::getInstance().getEnvironment().updateVariable(v.key, v.value);
 }
 
 JNIEXPORT jobjectArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getVariables(
@@ -105,7 +116,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_ge
     jclass variableClass = env->FindClass("com/swordfish/libretrodroid/Variable");
     jmethodID variableMethodID = env->GetMethodID(variableClass, "<init>", "()V");
 
-    auto variables = Environment::getInstance().getVariables();
+    auto variables = LibretroDroid::getInstance().getEnvironment().getVariables();
     jobjectArray result = env->NewObjectArray(variables.size(), variableClass, nullptr);
 
     for (int i = 0; i < variables.size(); i++) {
@@ -137,7 +148,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_ge
 ) {
     jclass variableClass = env->FindClass("[Lcom/swordfish/libretrodroid/Controller;");
 
-    auto controllers = Environment::getInstance().getControllers();
+    auto controllers = LibretroDroid::getInstance().getEnvironment().getControllers();
     jobjectArray result = env->NewObjectArray(controllers.size(), variableClass, nullptr);
 
     for (int i = 0; i < controllers.size(); i++) {
@@ -248,6 +259,289 @@ JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_seri
     return nullptr;
 }
 
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getCompressedStateBound(
+    JNIEnv* env,
+    jclass obj
+) {
+    try {
+        return (jlong) LibretroDroid::getInstance().getCompressedStateBound();
+    } catch (std::exception &exception) {
+        return 0;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_serializeCompressedState(
+    JNIEnv* env,
+    jclass obj,
+    jobject buffer
+) {
+    try {
+        auto* dest = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+        jlong capacity = env->GetDirectBufferCapacity(buffer);
+        if (dest == nullptr || capacity <= 0) {
+            throw std::runtime_error("serializeCompressedState requires a direct ByteBuffer");
+        }
+
+        size_t written = 0;
+        bool result = LibretroDroid::getInstance().serializeCompressedState(
+            [&](const uint8_t* data, size_t size) {
+                if (written + size > (size_t) capacity) return false;
+                memcpy(dest + written, data, size);
+                written += size;
+                return true;
+            }
+        );
+
+        if (!result) {
+            throw std::runtime_error("Unable to write compressed state into buffer");
+        }
+        return (jint) written;
+
+    } catch (std::exception &exception) {
+        LOGE("Error in serializeCompressedState: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return -1;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_serializeCompressedStateToFd(
+    JNIEnv* env,
+    jclass obj,
+    jint fd
+) {
+    try {
+        return LibretroDroid::getInstance().serializeCompressedState(
+            [fd](const uint8_t* data, size_t size) {
+                while (size > 0) {
+                    ssize_t count = write(fd, data, size);
+                    if (count < 0 && errno == EINTR) continue;
+                    if (count <= 0) return false;
+                    data += count;
+                    size -= count;
+                }
+                return true;
+            }
+        ) ? JNI_TRUE : JNI_FALSE;
+
+    } catch (std::exception &exception) {
+        LOGE("Error in serializeCompressedStateToFd: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_serializeStateToFd(
+    JNIEnv* env,
+    jclass obj,
+    jint fd
+) {
+    try {
+        return LibretroDroid::getInstance().serializeStateToFd(fd);
+    } catch (std::exception &exception) {
+        LOGE("Error in serializeStateToFd: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return -1;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_pollStateWrite(
+    JNIEnv* env,
+    jclass obj,
+    jint ticket
+) {
+    return static_cast<jint>(LibretroDroid::getInstance().pollStateWrite(ticket));
+}
+
+JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_unserializeStateFromFd(
+    JNIEnv* env,
+    jclass obj,
+    jint fd
+) {
+    try {
+        return LibretroDroid::getInstance().unserializeStateFromFd(fd) ? JNI_TRUE : JNI_FALSE;
+    } catch (std::exception &exception) {
+        LOGE("Error in unserializeStateFromFd: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_unserializeCompressedState(
+    JNIEnv* env,
+    jclass obj,
+    jobject buffer,
+    jint length
+) {
+    try {
+        auto* source = static_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+        jlong capacity = env->GetDirectBufferCapacity(buffer);
+        if (source == nullptr || length < 0 || length > capacity) {
+            throw std::runtime_error("unserializeCompressedState requires a direct ByteBuffer");
+        }
+
+        size_t position = 0;
+        return LibretroDroid::getInstance().unserializeCompressedState(
+            [&](uint8_t* data, size_t size) -> ssize_t {
+                size_t count = std::min(size, (size_t) length - position);
+                memcpy(data, source + position, count);
+                position += count;
+                return (ssize_t) count;
+            }
+        ) ? JNI_TRUE : JNI_FALSE;
+
+    } catch (std::exception &exception) {
+        LOGE("Error in unserializeCompressedState: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_unserializeCompressedStateFromFd(
+    JNIEnv* env,
+    jclass obj,
+    jint fd
+) {
+    try {
+        return LibretroDroid::getInstance().unserializeCompressedState(
+            [fd](uint8_t* data, size_t size) -> ssize_t {
+                ssize_t count;
+                do {
+                    count = read(fd, data, size);
+                } while (count < 0 && errno == EINTR);
+                return count;
+            }
+        ) ? JNI_TRUE : JNI_FALSE;
+
+    } catch (std::exception &exception) {
+        LOGE("Error in unserializeCompressedStateFromFd: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_startMovieRecording(
+    JNIEnv* env,
+    jclass obj,
+    jint fd
+) {
+    try {
+        return LibretroDroid::getInstance().startMovieRecording(fd) ? JNI_TRUE : JNI_FALSE;
+    } catch (std::exception &exception) {
+        LOGE("Error in startMovieRecording: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_stopMovieRecording(
+    JNIEnv* env,
+    jclass obj
+) {
+    try {
+        return LibretroDroid::getInstance().stopMovieRecording() ? JNI_TRUE : JNI_FALSE;
+    } catch (std::exception &exception) {
+        LOGE("Error in stopMovieRecording: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_startMoviePlayback(
+    JNIEnv* env,
+    jclass obj,
+    jint fd
+) {
+    try {
+        return LibretroDroid::getInstance().startMoviePlayback(fd) ? JNI_TRUE : JNI_FALSE;
+    } catch (std::exception &exception) {
+        LOGE("Error in startMoviePlayback: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return JNI_FALSE;
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_stopMoviePlayback(
+    JNIEnv* env,
+    jclass obj
+) {
+    try {
+        LibretroDroid::getInstance().stopMoviePlayback();
+    } catch (std::exception &exception) {
+        LOGE("Error in stopMoviePlayback: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMovieState(
+    JNIEnv* env,
+    jclass obj
+) {
+    try {
+        return LibretroDroid::getInstance().getMovieState();
+    } catch (std::exception &exception) {
+        LOGE("Error in getMovieState: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return 0;
+    }
+}
+
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMovieFrame(
+    JNIEnv* env,
+    jclass obj
+) {
+    try {
+        return static_cast<jlong>(LibretroDroid::getInstance().getMovieFrame());
+    } catch (std::exception &exception) {
+        LOGE("Error in getMovieFrame: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return 0;
+    }
+}
+
+JNIEXPORT jobject JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runBenchmark(
+    JNIEnv* env,
+    jclass obj,
+    jint frames,
+    jbyteArray state
+) {
+    try {
+        CoreBenchmark::Result result;
+        if (state != nullptr) {
+            jbyte* data = env->GetByteArrayElements(state, nullptr);
+            jsize size = env->GetArrayLength(state);
+            result = LibretroDroid::getInstance().runBenchmark(std::max(frames, 0), data, size);
+            env->ReleaseByteArrayElements(state, data, JNI_ABORT);
+        } else {
+            result = LibretroDroid::getInstance().runBenchmark(std::max(frames, 0), nullptr, 0);
+        }
+
+        jdoubleArray windowFps = env->NewDoubleArray(CoreBenchmark::WINDOWS);
+        env->SetDoubleArrayRegion(windowFps, 0, CoreBenchmark::WINDOWS, result.windowFps.data());
+
+        jclass resultClass = env->FindClass("com/swordfish/libretrodroid/CoreBenchmarkResult");
+        jmethodID constructor = env->GetMethodID(resultClass, "<init>", "(IDDDDDDJ[DD)V");
+        return env->NewObject(
+            resultClass,
+            constructor,
+            (jint) result.frames,
+            result.elapsedMs,
+            result.emulatedFps,
+            result.frameP50Us,
+            result.frameP95Us,
+            result.frameP99Us,
+            result.frameMaxUs,
+            (jlong) result.peakRssKb,
+            windowFps,
+            result.driftPercent
+        );
+
+    } catch (std::exception &exception) {
+        LOGE("Error in runBenchmark: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_GENERIC);
+        return nullptr;
+    }
+}
+
 JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getSerializeSize(
     JNIEnv* env,
     jclass obj
@@ -276,6 +570,32 @@ JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_capt
     return result;
 }
 
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_requestFrameCapture(
+    JNIEnv* env,
+    jclass obj
+) {
+    return LibretroDroid::getInstance().requestFrameCapture();
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_pollFrameCapture(
+    JNIEnv* env,
+    jclass obj,
+    jint ticket
+) {
+    FrameReadback::Capture capture;
+    auto status = LibretroDroid::getInstance().pollFrameCapture(ticket, capture);
+    if (status == FrameReadback::Status::PENDING) return nullptr;
+    if (status == FrameReadback::Status::FAILED) return env->NewByteArray(0);
+
+    jsize totalSize = 8 + (jsize)capture.pixels.size();
+    jbyteArray result = env->NewByteArray(totalSize);
+    int32_t dims[2] = { capture.width, capture.height };
+    env->SetByteArrayRegion(result, 0, 8, reinterpret_cast<jbyte*>(dims));
+    env->SetByteArrayRegion(result, 8, (jsize)capture.pixels.size(),
+        reinterpret_cast<const jbyte*>(capture.pixels.data()));
+    return result;
+}
+
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setCheat(
     JNIEnv* env,
     jclass obj,
@@ -351,6 +671,47 @@ JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_seri
     return nullptr;
 }
 
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setSRAMScanInterval(
+    JNIEnv* env,
+    jclass obj,
+    jint frames
+) {
+    try {
+        LibretroDroid::getInstance().setSRAMScanInterval(std::max(frames, 0));
+    } catch (std::exception &exception) {
+        LOGE("Error in setSRAMScanInterval: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_GENERIC);
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getSRAMDirtyPageCount(
+    JNIEnv* env,
+    jclass obj
+) {
+    return (jint) LibretroDroid::getInstance().getSRAMDirtyPageCount();
+}
+
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_flushSRAM(
+    JNIEnv* env,
+    jclass obj,
+    jint fd
+) {
+    try {
+        return (jlong) LibretroDroid::getInstance().flushSRAM(fd);
+    } catch (std::exception &exception) {
+        LOGE("Error in flushSRAM: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+        return -1;
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_markSRAMDirty(
+    JNIEnv* env,
+    jclass obj
+) {
+    LibretroDroid::getInstance().markSRAMDirty();
+}
+
 JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryData(
     JNIEnv* env,
     jclass obj,
@@ -387,6 +748,157 @@ JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryS
     return 0;
 }
 
+// The core owns the memory; Java only gets to look at it.
+static jobject readOnlyBuffer(JNIEnv* env, LibretroDroid::MemoryRegion region) {
+    if (region.data == nullptr || region.size == 0) return nullptr;
+
+    jobject buffer = env->NewDirectByteBuffer(region.data, (jlong) region.size);
+    if (buffer == nullptr) return nullptr;
+
+    jclass bufferClass = env->FindClass("java/nio/ByteBuffer");
+    jmethodID asReadOnly = env->GetMethodID(bufferClass, "asReadOnlyBuffer", "()Ljava/nio/ByteBuffer;");
+    jobject result = env->CallObjectMethod(buffer, asReadOnly);
+    env->DeleteLocalRef(buffer);
+    env->DeleteLocalRef(bufferClass);
+    return result;
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryGeneration(
+    JNIEnv* env,
+    jclass obj
+) {
+    return (jint) LibretroDroid::getInstance().getMemoryGeneration();
+}
+
+JNIEXPORT jobject JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryBuffer(
+    JNIEnv* env,
+    jclass obj,
+    jint memoryType
+) {
+    try {
+        return readOnlyBuffer(env, LibretroDroid::getInstance().getMemoryRegion(memoryType));
+    } catch (std::exception &exception) {
+        LOGE("Error in getMemoryBuffer: %s", exception.what());
+    }
+    return nullptr;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryMapDescriptors(
+    JNIEnv* env,
+    jclass obj
+) {
+    try {
+        auto descriptors = LibretroDroid::getInstance().getMemoryMapDescriptors();
+        std::vector<jlong> values;
+        values.reserve(descriptors.size() * 3);
+        for (auto& descriptor : descriptors) {
+            values.push_back((jlong) descriptor.start);
+            values.push_back(descriptor.ptr != nullptr ? (jlong) descriptor.len : 0);
+            values.push_back((jlong) descriptor.flags);
+        }
+
+        jlongArray result = env->NewLongArray(values.size());
+        env->SetLongArrayRegion(result, 0, values.size(), values.data());
+        return result;
+    } catch (std::exception &exception) {
+        LOGE("Error in getMemoryMapDescriptors: %s", exception.what());
+    }
+    return nullptr;
+}
+
+JNIEXPORT jobject JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryMapBuffer(
+    JNIEnv* env,
+    jclass obj,
+    jint index
+) {
+    try {
+        if (index < 0) return nullptr;
+        return readOnlyBuffer(env, LibretroDroid::getInstance().getMemoryMapRegion(index));
+    } catch (std::exception &exception) {
+        LOGE("Error in getMemoryMapBuffer: %s", exception.what());
+    }
+    return nullptr;
+}
+
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_beginMemorySearch(
+    JNIEnv* env,
+    jclass obj,
+    jint memoryType,
+    jint width
+) {
+    try {
+        return (jlong) LibretroDroid::getInstance().beginMemorySearch(false, memoryType, width);
+    } catch (std::exception &exception) {
+        LOGE("Error in beginMemorySearch: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_GENERIC);
+        return -1;
+    }
+}
+
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_beginMemoryMapSearch(
+    JNIEnv* env,
+    jclass obj,
+    jint index,
+    jint width
+) {
+    try {
+        if (index < 0) return -1;
+        return (jlong) LibretroDroid::getInstance().beginMemorySearch(true, index, width);
+    } catch (std::exception &exception) {
+        LOGE("Error in beginMemoryMapSearch: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_GENERIC);
+        return -1;
+    }
+}
+
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_filterMemorySearch(
+    JNIEnv* env,
+    jclass obj,
+    jint comparison,
+    jboolean againstValue,
+    jint value
+) {
+    try {
+        if (comparison < 0 || comparison > (jint) MemorySearch::Comparison::LESS) return -1;
+        return (jlong) LibretroDroid::getInstance().filterMemorySearch(
+            static_cast<MemorySearch::Comparison>(comparison),
+            againstValue,
+            static_cast<uint32_t>(value)
+        );
+    } catch (std::exception &exception) {
+        LOGE("Error in filterMemorySearch: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_GENERIC);
+        return -1;
+    }
+}
+
+JNIEXPORT jintArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemorySearchResults(
+    JNIEnv* env,
+    jclass obj,
+    jint first,
+    jint max
+) {
+    try {
+        auto offsets = LibretroDroid::getInstance().getMemorySearchResults(
+            std::max(first, 0),
+            std::max(max, 0)
+        );
+        jintArray result = env->NewIntArray(offsets.size());
+        env->SetIntArrayRegion(result, 0, offsets.size(), reinterpret_cast<const jint*>(offsets.data()));
+        return result;
+    } catch (std::exception &exception) {
+        LOGE("Error in getMemorySearchResults: %s", exception.what());
+    }
+    return nullptr;
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_endMemorySearch(
+    JNIEnv* env,
+    jclass obj
+) {
+    LibretroDroid::getInstance().endMemorySearch();
+}
+
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_reset(
     JNIEnv* env,
     jclass obj
@@ -735,6 +1247,40 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setRumbleE
     LibretroDroid::getInstance().setRumbleEnabled(enabled);
 }
 
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setThreadedHWRendering(
+    JNIEnv* env,
+    jclass obj,
+    jboolean enabled
+) {
+    LibretroDroid::getInstance().setThreadedHWRendering(enabled);
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setThreadedVideo(
+    JNIEnv* env,
+    jclass obj,
+    jboolean enabled
+) {
+    LibretroDroid::getInstance().setThreadedVideo(enabled);
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setFrameProfiling(
+    JNIEnv* env,
+    jclass obj,
+    jboolean enabled,
+    jboolean traceSections
+) {
+    LibretroDroid::getInstance().setFrameProfiling(enabled, traceSections);
+}
+
+JNIEXPORT jstring JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getFrameProfile(
+    JNIEnv* env,
+    jclass obj,
+    jboolean reset
+) {
+    std::string profile = LibretroDroid::getInstance().getFrameProfile(reset);
+    return env->NewStringUTF(profile.c_str());
+}
+
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setFrameSpeed(
     JNIEnv* env,
     jclass obj,
@@ -869,7 +1415,7 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setRotatio
     jclass obj,
     jint degrees
 ) {
-    Environment::getInstance().setManualRotation(degrees);
+    LibretroDroid::getInstance().getEnvironment().setManualRotation(degrees);
 }
 
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_initRewindBuffer(
@@ -1008,6 +1554,55 @@ JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runStateLo
     return static_cast<jint>(test::runStateLoadPolicyTests());
 }
 
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runStateContainerTests(
+    JNIEnv* env,
+    jclass obj
+) {
+    return static_cast<jint>(test::runStateContainerTests());
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runPixelConversionTests(
+    JNIEnv* env,
+    jclass obj
+) {
+    return static_cast<jint>(test::runPixelConversionTests());
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runInputMovieTests(
+    JNIEnv* env,
+    jclass obj
+) {
+    return static_cast<jint>(test::runInputMovieTests());
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runSramTrackerTests(
+    JNIEnv* env,
+    jclass obj
+) {
+    return static_cast<jint>(test::runSramTrackerTests());
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runStateWriterTests(
+    JNIEnv* env,
+    jclass obj
+) {
+    return static_cast<jint>(test::runStateWriterTests());
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runMemorySearchTests(
+    JNIEnv* env,
+    jclass obj
+) {
+    return static_cast<jint>(test::runMemorySearchTests());
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_runBlurScheduleTests(
+    JNIEnv* env,
+    jclass obj
+) {
+    return static_cast<jint>(test::runBlurScheduleTests());
+}
+
 JNIEXPORT jstring JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_computeRomHash(
     JNIEnv* env,
     jclass obj,
@@ -1035,6 +1630,73 @@ JNIEXPORT jstring JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_compute
     return env->NewStringUTF(hash);
 }
 
+JNIEXPORT jobjectArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_computeRomHashes(
+    JNIEnv* env,
+    jclass obj,
+    jobjectArray romPaths,
+    jintArray consoleIds,
+    jstring cachePath,
+    jint maxThreads,
+    jobject progressListener
+) {
+    static std::mutex hashMutex;
+
+    try {
+        jsize count = env->GetArrayLength(romPaths);
+        if (env->GetArrayLength(consoleIds) != count) {
+            throw std::runtime_error("romPaths and consoleIds must have the same length");
+        }
+
+        std::vector<RomHasher::Request> requests;
+        requests.reserve(count);
+
+        jint* ids = env->GetIntArrayElements(consoleIds, nullptr);
+        for (jsize i = 0; i < count; i++) {
+            auto jPath = (jstring) env->GetObjectArrayElement(romPaths, i);
+            std::string path = jPath != nullptr ? JniString(env, jPath).stdString() : std::string();
+            requests.push_back(RomHasher::Request { path, static_cast<uint32_t>(ids[i]) });
+            env->DeleteLocalRef(jPath);
+        }
+        env->ReleaseIntArrayElements(consoleIds, ids, JNI_ABORT);
+
+        jmethodID onProgressMethodID = nullptr;
+        if (progressListener != nullptr) {
+            jclass listenerClass = env->GetObjectClass(progressListener);
+            onProgressMethodID = env->GetMethodID(listenerClass, "onProgress", "(II)V");
+        }
+
+        std::string cacheFile = cachePath != nullptr ? JniString(env, cachePath).stdString() : std::string();
+
+        std::lock_guard<std::mutex> lock(hashMutex);
+        RomHasher hasher(cacheFile);
+        std::vector<std::string> hashes = hasher.hashAll(
+            requests,
+            static_cast<unsigned int>(std::max(0, maxThreads)),
+            [&](size_t completed, size_t total) {
+                if (onProgressMethodID == nullptr || env->ExceptionCheck()) return;
+                env->CallVoidMethod(progressListener, onProgressMethodID, (jint) completed, (jint) total);
+            }
+        );
+
+        if (env->ExceptionCheck()) return nullptr;
+
+        jclass stringClass = env->FindClass("java/lang/String");
+        jobjectArray result = env->NewObjectArray(count, stringClass, nullptr);
+        for (jsize i = 0; i < count; i++) {
+            if (hashes[i].empty()) continue;
+            jstring jHash = env->NewStringUTF(hashes[i].c_str());
+            env->SetObjectArrayElement(result, i, jHash);
+            env->DeleteLocalRef(jHash);
+        }
+        return result;
+
+    } catch (std::exception &exception) {
+        LOGE("Error in computeRomHashes: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_GENERIC);
+        return nullptr;
+    }
+}
+
 }
 
 }
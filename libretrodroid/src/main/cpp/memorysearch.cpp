@@ -0,0 +1,315 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "memorysearch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace libretrodroid {
+
+namespace {
+
+inline uint32_t readValue(const uint8_t* data, unsigned width) {
+    switch (width) {
+        case 1:
+            return data[0];
+        case 2: {
+            uint16_t value;
+            memcpy(&value, data, sizeof(value));
+            return value;
+        }
+        default: {
+            uint32_t value;
+            memcpy(&value, data, sizeof(value));
+            return value;
+        }
+    }
+}
+
+inline bool compare(uint32_t current, uint32_t reference, MemorySearch::Comparison comparison) {
+    switch (comparison) {
+        case MemorySearch::Comparison::EQUAL: return current == reference;
+        case MemorySearch::Comparison::NOT_EQUAL: return current != reference;
+        case MemorySearch::Comparison::GREATER: return current > reference;
+        case MemorySearch::Comparison::LESS: return current < reference;
+    }
+    return false;
+}
+
+inline int popcount(uint64_t bits) {
+    return __builtin_popcountll(bits);
+}
+
+}
+
+bool MemorySearch::begin(const uint8_t* data, size_t size, unsigned width) {
+    clear();
+    if (width != 1 && width != 2 && width != 4) return false;
+
+    this->width = width;
+    valueCount = size / width;
+    snapshot.assign(data, data + size);
+    candidates.assign((valueCount + BLOCK_VALUES - 1) / BLOCK_VALUES, ~0ull);
+    if (valueCount % BLOCK_VALUES != 0) {
+        candidates.back() = (1ull << (valueCount % BLOCK_VALUES)) - 1;
+    }
+    candidateCount = valueCount;
+    return true;
+}
+
+int64_t MemorySearch::filter(const uint8_t* data, size_t size, Comparison comparison, bool againstValue, uint32_t value) {
+    if (!isActive() || size != snapshot.size()) return -1;
+
+    // A constant is compared through a block of it, so both cases share the kernels.
+    uint8_t constant[BLOCK_VALUES * 4];
+    if (againstValue) {
+        for (size_t i = 0; i < BLOCK_VALUES; i++) memcpy(constant + i * width, &value, width);
+    }
+
+    size_t blockBytes = BLOCK_VALUES * width;
+    size_t fullBlocks = valueCount / BLOCK_VALUES;
+    candidateCount = 0;
+    for (size_t block = 0; block < candidates.size(); block++) {
+        uint64_t bits = candidates[block];
+        if (bits == 0) continue;
+
+        const uint8_t* current = data + block * blockBytes;
+        const uint8_t* reference = againstValue ? constant : snapshot.data() + block * blockBytes;
+        uint64_t matches = block < fullBlocks
+            ? compareBlock(current, reference, width, comparison)
+            : compareScalar(current, reference, width, comparison, valueCount - block * BLOCK_VALUES);
+
+        candidates[block] = bits & matches;
+        candidateCount += popcount(candidates[block]);
+    }
+
+    memcpy(snapshot.data(), data, size);
+    return static_cast<int64_t>(candidateCount);
+}
+
+std::vector<uint32_t> MemorySearch::getCandidates(size_t skip, size_t max) const {
+    std::vector<uint32_t> result;
+    result.reserve(std::min(max, candidateCount > skip ? candidateCount - skip : 0));
+
+    for (size_t block = 0; block < candidates.size() && result.size() < max; block++) {
+        uint64_t bits = candidates[block];
+        size_t count = popcount(bits);
+        if (skip >= count) {
+            skip -= count;
+            continue;
+        }
+        while (bits != 0 && result.size() < max) {
+            size_t index = __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (skip > 0) {
+                skip--;
+                continue;
+            }
+            result.push_back(static_cast<uint32_t>((block * BLOCK_VALUES + index) * width));
+        }
+    }
+    return result;
+}
+
+void MemorySearch::clear() {
+    width = 0;
+    valueCount = 0;
+    candidateCount = 0;
+    snapshot.clear();
+    snapshot.shrink_to_fit();
+    candidates.clear();
+    candidates.shrink_to_fit();
+}
+
+uint64_t MemorySearch::compareScalar(const uint8_t* current, const uint8_t* reference, unsigned width,
+                                     Comparison comparison, size_t count) {
+    uint64_t matches = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = readValue(current + i * width, width);
+        uint32_t b = readValue(reference + i * width, width);
+        matches |= static_cast<uint64_t>(compare(a, b, comparison)) << i;
+    }
+    return matches;
+}
+
+#if defined(__ARM_NEON)
+
+namespace {
+
+inline uint8x16_t compare8(uint8x16_t a, uint8x16_t b, MemorySearch::Comparison comparison) {
+    switch (comparison) {
+        case MemorySearch::Comparison::EQUAL: return vceqq_u8(a, b);
+        case MemorySearch::Comparison::NOT_EQUAL: return vmvnq_u8(vceqq_u8(a, b));
+        case MemorySearch::Comparison::GREATER: return vcgtq_u8(a, b);
+        case MemorySearch::Comparison::LESS: return vcltq_u8(a, b);
+    }
+    return vdupq_n_u8(0);
+}
+
+inline uint16x8_t compare16(uint16x8_t a, uint16x8_t b, MemorySearch::Comparison comparison) {
+    switch (comparison) {
+        case MemorySearch::Comparison::EQUAL: return vceqq_u16(a, b);
+        case MemorySearch::Comparison::NOT_EQUAL: return vmvnq_u16(vceqq_u16(a, b));
+        case MemorySearch::Comparison::GREATER: return vcgtq_u16(a, b);
+        case MemorySearch::Comparison::LESS: return vcltq_u16(a, b);
+    }
+    return vdupq_n_u16(0);
+}
+
+inline uint32x4_t compare32(uint32x4_t a, uint32x4_t b, MemorySearch::Comparison comparison) {
+    switch (comparison) {
+        case MemorySearch::Comparison::EQUAL: return vceqq_u32(a, b);
+        case MemorySearch::Comparison::NOT_EQUAL: return vmvnq_u32(vceqq_u32(a, b));
+        case MemorySearch::Comparison::GREATER: return vcgtq_u32(a, b);
+        case MemorySearch::Comparison::LESS: return vcltq_u32(a, b);
+    }
+    return vdupq_n_u32(0);
+}
+
+// One bit per all-ones lane. Pairwise adds rather than vaddv, which armv7 lacks.
+inline uint64_t movemask(uint8x16_t lanes) {
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t bits = vandq_u8(lanes, vld1q_u8(weights));
+    uint8x8_t sum = vpadd_u8(vget_low_u8(bits), vget_high_u8(bits));
+    sum = vpadd_u8(sum, sum);
+    sum = vpadd_u8(sum, sum);
+    return vget_lane_u8(sum, 0) | (static_cast<uint64_t>(vget_lane_u8(sum, 1)) << 8);
+}
+
+// Compares 16 values and narrows the results to a byte each.
+inline uint8x16_t compareGroup(const uint8_t* a, const uint8_t* b, unsigned width, MemorySearch::Comparison comparison) {
+    switch (width) {
+        case 1:
+            return compare8(vld1q_u8(a), vld1q_u8(b), comparison);
+        case 2: {
+            uint16x8_t low = compare16(vreinterpretq_u16_u8(vld1q_u8(a)), vreinterpretq_u16_u8(vld1q_u8(b)), comparison);
+            uint16x8_t high = compare16(vreinterpretq_u16_u8(vld1q_u8(a + 16)), vreinterpretq_u16_u8(vld1q_u8(b + 16)), comparison);
+            return vcombine_u8(vmovn_u16(low), vmovn_u16(high));
+        }
+        default: {
+            uint16x4_t narrowed[4];
+            for (int i = 0; i < 4; i++) {
+                uint32x4_t result = compare32(vreinterpretq_u32_u8(vld1q_u8(a + i * 16)),
+                                              vreinterpretq_u32_u8(vld1q_u8(b + i * 16)), comparison);
+                narrowed[i] = vmovn_u32(result);
+            }
+            return vcombine_u8(vmovn_u16(vcombine_u16(narrowed[0], narrowed[1])),
+                               vmovn_u16(vcombine_u16(narrowed[2], narrowed[3])));
+        }
+    }
+}
+
+}
+
+uint64_t MemorySearch::compareBlock(const uint8_t* current, const uint8_t* reference, unsigned width, Comparison comparison) {
+    uint64_t matches = 0;
+    for (size_t group = 0; group < BLOCK_VALUES / 16; group++) {
+        size_t offset = group * 16 * width;
+        matches |= movemask(compareGroup(current + offset, reference + offset, width, comparison)) << (group * 16);
+    }
+    return matches;
+}
+
+#elif defined(__SSE2__)
+
+namespace {
+
+inline __m128i signBias(unsigned width) {
+    switch (width) {
+        case 1: return _mm_set1_epi8((char) 0x80);
+        case 2: return _mm_set1_epi16((short) 0x8000);
+        default: return _mm_set1_epi32((int) 0x80000000);
+    }
+}
+
+inline __m128i equal(__m128i a, __m128i b, unsigned width) {
+    switch (width) {
+        case 1: return _mm_cmpeq_epi8(a, b);
+        case 2: return _mm_cmpeq_epi16(a, b);
+        default: return _mm_cmpeq_epi32(a, b);
+    }
+}
+
+inline __m128i greaterSigned(__m128i a, __m128i b, unsigned width) {
+    switch (width) {
+        case 1: return _mm_cmpgt_epi8(a, b);
+        case 2: return _mm_cmpgt_epi16(a, b);
+        default: return _mm_cmpgt_epi32(a, b);
+    }
+}
+
+// SSE2 only compares signed lanes, so unsigned order comes from flipping the sign bits first.
+inline __m128i compareLanes(const uint8_t* a, const uint8_t* b, unsigned width, MemorySearch::Comparison comparison) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    switch (comparison) {
+        case MemorySearch::Comparison::EQUAL:
+            return equal(x, y, width);
+        case MemorySearch::Comparison::NOT_EQUAL:
+            return _mm_xor_si128(equal(x, y, width), _mm_set1_epi8((char) 0xFF));
+        case MemorySearch::Comparison::GREATER:
+            return greaterSigned(_mm_xor_si128(x, signBias(width)), _mm_xor_si128(y, signBias(width)), width);
+        case MemorySearch::Comparison::LESS:
+            return greaterSigned(_mm_xor_si128(y, signBias(width)), _mm_xor_si128(x, signBias(width)), width);
+    }
+    return _mm_setzero_si128();
+}
+
+// Compares 16 values and narrows the results to a byte each. Lanes are all ones or all zeros,
+// which the saturating packs keep as they are.
+inline __m128i compareGroup(const uint8_t* a, const uint8_t* b, unsigned width, MemorySearch::Comparison comparison) {
+    switch (width) {
+        case 1:
+            return compareLanes(a, b, 1, comparison);
+        case 2:
+            return _mm_packs_epi16(compareLanes(a, b, 2, comparison), compareLanes(a + 16, b + 16, 2, comparison));
+        default: {
+            __m128i low = _mm_packs_epi32(compareLanes(a, b, 4, comparison), compareLanes(a + 16, b + 16, 4, comparison));
+            __m128i high = _mm_packs_epi32(compareLanes(a + 32, b + 32, 4, comparison), compareLanes(a + 48, b + 48, 4, comparison));
+            return _mm_packs_epi16(low, high);
+        }
+    }
+}
+
+}
+
+uint64_t MemorySearch::compareBlock(const uint8_t* current, const uint8_t* reference, unsigned width, Comparison comparison) {
+    uint64_t matches = 0;
+    for (size_t group = 0; group < BLOCK_VALUES / 16; group++) {
+        size_t offset = group * 16 * width;
+        uint32_t bits = _mm_movemask_epi8(compareGroup(current + offset, reference + offset, width, comparison));
+        matches |= static_cast<uint64_t>(bits) << (group * 16);
+    }
+    return matches;
+}
+
+#else
+
+uint64_t MemorySearch::compareBlock(const uint8_t* current, const uint8_t* reference, unsigned width, Comparison comparison) {
+    return compareScalar(current, reference, width, comparison, BLOCK_VALUES);
+}
+
+#endif
+
+} //namespace libretrodroid
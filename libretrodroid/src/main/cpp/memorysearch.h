@@ -0,0 +1,81 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_MEMORYSEARCH_H
+#define LIBRETRODROID_MEMORYSEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Cheat style search over a block of core memory. Every aligned 8, 16 or 32 bit value starts out
+ * as a candidate; each filter keeps the ones whose current value compares as asked with the value
+ * they had at the previous pass, or with a constant, and snapshots memory for the next. Values
+ * are unsigned in host byte order.
+ *
+ * Candidates live in a bitmap, 64 values to a word. Words with any candidate left are compared
+ * whole by NEON or SSE2 kernels where the target has them and the scalar code otherwise; both
+ * produce identical results.
+ */
+class MemorySearch {
+public:
+    enum class Comparison {
+        EQUAL,
+        NOT_EQUAL,
+        GREATER,
+        LESS
+    };
+
+    /** Snapshots data and makes every value of width bytes a candidate. False for other widths. */
+    bool begin(const uint8_t* data, size_t size, unsigned width);
+
+    /**
+     * Keeps the candidates comparing as asked with their snapshotted value, or with value when
+     * againstValue is set. Returns the candidates left, or -1 if data is not the searched size.
+     */
+    int64_t filter(const uint8_t* data, size_t size, Comparison comparison, bool againstValue, uint32_t value);
+
+    /** Byte offsets of up to max candidates, skipping the first skip. */
+    std::vector<uint32_t> getCandidates(size_t skip, size_t max) const;
+
+    size_t getCandidateCount() const { return candidateCount; }
+    bool isActive() const { return width != 0; }
+    void clear();
+
+    // Compares 64 values of width bytes and returns one bit per value, lowest first.
+    static uint64_t compareBlock(const uint8_t* current, const uint8_t* reference, unsigned width, Comparison comparison);
+
+private:
+    static constexpr size_t BLOCK_VALUES = 64;
+
+    static uint64_t compareScalar(const uint8_t* current, const uint8_t* reference, unsigned width,
+                                  Comparison comparison, size_t count);
+
+private:
+    unsigned width = 0;
+    size_t valueCount = 0;
+    size_t candidateCount = 0;
+    std::vector<uint8_t> snapshot;
+    std::vector<uint64_t> candidates;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_MEMORYSEARCH_H
@@ -0,0 +1,127 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ */
+
+#include "memorysearch_test.h"
+#include "memorysearch.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace libretrodroid::test {
+
+namespace {
+
+using Comparison = MemorySearch::Comparison;
+
+const Comparison COMPARISONS[] = { Comparison::EQUAL, Comparison::NOT_EQUAL, Comparison::GREATER, Comparison::LESS };
+const unsigned WIDTHS[] = { 1, 2, 4 };
+
+uint32_t readValue(const uint8_t* data, unsigned width) {
+    uint32_t value = 0;
+    memcpy(&value, data, width);
+    return value;
+}
+
+bool expected(uint32_t current, uint32_t reference, Comparison comparison) {
+    switch (comparison) {
+        case Comparison::EQUAL: return current == reference;
+        case Comparison::NOT_EQUAL: return current != reference;
+        case Comparison::GREATER: return current > reference;
+        case Comparison::LESS: return current < reference;
+    }
+    return false;
+}
+
+// Values clustered around a few levels, so equal, sign bit and near miss lanes all come up.
+void fill(std::vector<uint8_t>& data, uint64_t& rng) {
+    for (auto& byte : data) {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        uint8_t pick = static_cast<uint8_t>(rng >> 56);
+        byte = (pick & 3) == 0 ? 0x80 : (pick & 3) == 1 ? 0x7f : static_cast<uint8_t>(rng >> 40);
+    }
+}
+
+}
+
+int runMemorySearchTests() {
+    int passed = 0;
+    uint64_t rng = 12345;
+
+    // The vector kernels agree with plain comparisons for every width and comparison.
+    {
+        bool ok = true;
+        std::vector<uint8_t> current(256), reference(256);
+        for (int round = 0; round < 64 && ok; round++) {
+            fill(current, rng);
+            fill(reference, rng);
+            if (round % 4 == 0) reference = current;
+            for (unsigned width : WIDTHS) {
+                for (Comparison comparison : COMPARISONS) {
+                    uint64_t bits = MemorySearch::compareBlock(current.data(), reference.data(), width, comparison);
+                    for (unsigned i = 0; i < 64; i++) {
+                        bool want = expected(readValue(&current[i * width], width),
+                                             readValue(&reference[i * width], width), comparison);
+                        if (((bits >> i) & 1) != want) ok = false;
+                    }
+                }
+            }
+        }
+        if (ok) ++passed;
+    }
+
+    // Changed then unchanged narrows down to the one value that moved, reported by byte offset.
+    // The region is not a whole number of blocks, so the tail goes through the scalar path.
+    {
+        std::vector<uint8_t> memory(1000 + 3, 0);
+        MemorySearch search;
+        bool ok = search.begin(memory.data(), memory.size(), 2) && search.getCandidateCount() == 501;
+        memory[2 * 499] = 7;
+        ok = ok && search.filter(memory.data(), memory.size(), Comparison::NOT_EQUAL, false, 0) == 1;
+        ok = ok && search.filter(memory.data(), memory.size(), Comparison::EQUAL, false, 0) == 1;
+        std::vector<uint32_t> offsets = search.getCandidates(0, 10);
+        ok = ok && offsets.size() == 1 && offsets[0] == 2 * 499;
+        if (ok) ++passed;
+    }
+
+    // Against a constant, and unsigned: 0x80000000 is greater than 5.
+    {
+        std::vector<uint8_t> memory(4 * 300, 0);
+        uint32_t big = 0x80000000u, five = 5;
+        memcpy(&memory[4 * 10], &big, 4);
+        memcpy(&memory[4 * 100], &five, 4);
+        memcpy(&memory[4 * 299], &five, 4);
+        MemorySearch search;
+        search.begin(memory.data(), memory.size(), 4);
+        bool ok = search.filter(memory.data(), memory.size(), Comparison::GREATER, true, 4) == 3;
+        ok = ok && search.filter(memory.data(), memory.size(), Comparison::EQUAL, true, 5) == 2;
+        std::vector<uint32_t> offsets = search.getCandidates(0, 10);
+        ok = ok && offsets == std::vector<uint32_t>({ 4 * 100, 4 * 299 });
+        if (ok) ++passed;
+    }
+
+    // Results page through skip and max, and a resized region or bad width is refused.
+    {
+        std::vector<uint8_t> memory(640, 1);
+        MemorySearch search;
+        bool ok = search.begin(memory.data(), memory.size(), 1);
+        for (size_t i = 0; i < memory.size(); i += 3) memory[i] = 2;
+        ok = ok && search.filter(memory.data(), memory.size(), Comparison::GREATER, false, 0) == 214;
+        std::vector<uint32_t> page = search.getCandidates(100, 5);
+        ok = ok && page == std::vector<uint32_t>({ 300, 303, 306, 309, 312 });
+        ok = ok && search.getCandidates(210, 10).size() == 4 && search.getCandidates(214, 10).empty();
+        ok = ok && search.filter(memory.data(), memory.size() - 1, Comparison::EQUAL, false, 0) == -1;
+        ok = ok && !search.begin(memory.data(), memory.size(), 3) && !search.isActive();
+        if (ok) ++passed;
+    }
+
+    return passed;
+}
+
+} // namespace libretrodroid::test
@@ -27,34 +27,60 @@ oboe::DataCallbackResult Microphone::onAudioReady(
     void* audioData,
     int32_t numFrames
 ) {
-    std::lock_guard<std::mutex> l(lock);
-    fifoBuffer->write(audioData, numFrames);
+    // Linear interpolation between the last sample of the previous callback and each new one.
+    auto* input = static_cast<const int16_t*>(audioData);
+    int32_t size = 0;
+    for (int32_t i = 0; i < numFrames; i++) {
+        int16_t sample = input[i];
+        while (phase < 1.0) {
+            chunk[size++] = static_cast<int16_t>(previous + (sample - previous) * phase);
+            if (size == CHUNK_SIZE) {
+                flushChunk(size);
+                size = 0;
+            }
+            phase += step;
+        }
+        phase -= 1.0;
+        previous = sample;
+    }
+    flushChunk(size);
     return oboe::DataCallbackResult::Continue;
 }
 
-Microphone::Microphone(int sampleRate):
+void Microphone::flushChunk(int32_t size) {
+    if (size > 0) {
+        fifoBuffer->write(chunk.data(), size);
+    }
+}
+
+Microphone::Microphone(int sampleRate, bool lowLatency):
     mSampleRate(sampleRate),
-    fifoBuffer(std::make_unique<oboe::FifoBuffer>(2, sampleRate / 2)) { }
+    mLowLatency(lowLatency),
+    fifoBuffer(std::make_unique<oboe::FifoBuffer>(2, lowLatency ? sampleRate / 10 : sampleRate / 2)),
+    maxBacklog(lowLatency ? sampleRate / 50 : sampleRate / 5) { }
 
 bool Microphone::open() {
-    std::lock_guard<std::mutex> l(lock);
-
     oboe::AudioStreamBuilder builder;
     builder.setDirection(oboe::Direction::Input);
     builder.setInputPreset(oboe::InputPreset::Generic);
-    builder.setPerformanceMode(oboe::PerformanceMode::PowerSaving);
+    builder.setPerformanceMode(mLowLatency ? oboe::PerformanceMode::LowLatency : oboe::PerformanceMode::PowerSaving);
     builder.setSharingMode(oboe::SharingMode::Exclusive);
-    builder.setSampleRate(mSampleRate);
     builder.setChannelCount(oboe::ChannelCount::Mono);
     builder.setFormat(oboe::AudioFormat::I16);
     builder.setCallback(this);
 
+    // No sample rate: some devices refuse anything but their native one.
     oboe::Result result = builder.openStream(inputStream);
     if (result != oboe::Result::OK) {
         LOGE("Failed to open microphone stream");
         return false;
     }
 
+    step = (double) inputStream->getSampleRate() / mSampleRate;
+    phase = 0.0;
+    previous = 0;
+    LOGI("Microphone capturing at %d Hz for a core rate of %d Hz", inputStream->getSampleRate(), mSampleRate);
+
     result = inputStream->requestStart();
     if (result != oboe::Result::OK) {
         LOGE("Failed to start stream");
@@ -65,7 +91,7 @@ bool Microphone::open() {
 }
 
 bool Microphone::close() {
-    std::lock_guard<std::mutex> l(lock);
+    // Closing waits for a running callback, after which nothing writes to the FIFO.
     oboe::Result result = inputStream->close();
     if (result != oboe::Result::OK) {
         LOGE("Failed to close stream");
@@ -88,7 +114,12 @@ bool Microphone::isRunning() const {
 }
 
 int Microphone::read(int16_t* samples, int numSamples) {
-    std::lock_guard<std::mutex> l(lock);
+    // The reader owns the read counter, so skipping stale input is safe without a lock.
+    uint32_t available = fifoBuffer->getFullFramesAvailable();
+    uint32_t keep = maxBacklog + numSamples;
+    if (available > keep) {
+        fifoBuffer->setReadCounter(fifoBuffer->getReadCounter() + (available - keep));
+    }
     return fifoBuffer->readNow(samples, numSamples);
 }
 
@@ -96,4 +127,4 @@ int Microphone::sampleRate() const {
     return mSampleRate;
 }
 
-} // libretrodroid
\ No newline at end of file
+} // libretrodroid
@@ -18,8 +18,8 @@
 #ifndef LIBRETRODROID_MICROPHONE_H
 #define LIBRETRODROID_MICROPHONE_H
 
+#include <array>
 #include <memory>
-#include <mutex>
 
 #include "libretro.h"
 #include "oboe/AudioStreamCallback.h"
@@ -27,9 +27,14 @@
 
 namespace libretrodroid {
 
+/**
+ * Captures at the device's native rate and converts to the rate the core asked for inside the
+ * input callback. The callback is the only writer and the core's read the only reader of the
+ * FIFO, which is single producer single consumer and wait free, so neither side ever locks.
+ */
 class Microphone: public oboe::AudioStreamCallback {
 public:
-    explicit Microphone(int sampleRate);
+    Microphone(int sampleRate, bool lowLatency);
     Microphone(const Microphone& other) = delete;
     Microphone& operator=(const Microphone& other) = delete;
 
@@ -48,12 +53,26 @@ public:
 
     int sampleRate() const;
 
+private:
+    static constexpr int32_t CHUNK_SIZE = 256;
+
+    void flushChunk(int32_t size);
+
 private:
     bool mIsRunning = false;
     int mSampleRate = 44100;
-    std::mutex lock;
+    bool mLowLatency = false;
     std::unique_ptr<oboe::FifoBuffer> fifoBuffer = nullptr;
     std::shared_ptr<oboe::AudioStream> inputStream;
+
+    // Samples older than this when the core reads are dropped, so drift can't build up lag.
+    uint32_t maxBacklog = 0;
+
+    // Rate conversion state, only touched by the input callback.
+    double step = 1.0;
+    double phase = 0.0;
+    int16_t previous = 0;
+    std::array<int16_t, CHUNK_SIZE> chunk {};
 };
 
 }
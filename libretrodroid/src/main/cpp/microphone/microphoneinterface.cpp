@@ -16,11 +16,22 @@
  */
 
 #include "microphoneinterface.h"
+
+#include <atomic>
+
 #include "../log.h"
 #include "microphone.h"
 
 namespace libretrodroid {
 
+namespace {
+    std::atomic<bool> lowLatency{false};
+}
+
+void MicrophoneInterface::setLowLatency(bool enabled) {
+    lowLatency = enabled;
+}
+
 retro_microphone_interface* MicrophoneInterface::getInterface() {
     LOGI("Fetching microphone interface");
 
@@ -37,7 +48,7 @@ retro_microphone_interface* MicrophoneInterface::getInterface() {
 
 retro_microphone_t* MicrophoneInterface::libretroOpenMicrophone(const retro_microphone_params_t* params) {
     LOGI("Opened microphone");
-    auto* result = new Microphone((int) params->rate);
+    auto* result = new Microphone((int) params->rate, lowLatency);
     result->open();
     return reinterpret_cast<retro_microphone_t*>(result);
 }
@@ -26,6 +26,9 @@ class MicrophoneInterface {
 public:
     static retro_microphone_interface* getInterface();
 
+    /** Applies to microphones the core opens afterwards. */
+    static void setLowLatency(bool enabled);
+
     static retro_microphone_t* libretroOpenMicrophone(const retro_microphone_params_t* params);
 
     static void libretroCloseMicrophone(retro_microphone_t* opaqueMicrophone);
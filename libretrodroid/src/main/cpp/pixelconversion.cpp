@@ -0,0 +1,394 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pixelconversion.h"
+
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "libretro/libretro-common/include/libretro.h"
+
+namespace libretrodroid {
+
+namespace {
+
+inline uint32_t packRGBA(uint32_t r, uint32_t g, uint32_t b) {
+    return r | (g << 8) | (b << 16) | 0xFF000000u;
+}
+
+inline uint32_t expand5(uint32_t value) {
+    return (value << 3) | (value >> 2);
+}
+
+inline uint32_t expand6(uint32_t value) {
+    return (value << 2) | (value >> 4);
+}
+
+inline uint32_t convertXRGB8888ToRGBA8888(uint32_t pixel) {
+    return packRGBA((pixel >> 16) & 0xFF, (pixel >> 8) & 0xFF, pixel & 0xFF);
+}
+
+inline uint32_t convert0RGB1555ToRGBA8888(uint16_t pixel) {
+    return packRGBA(expand5((pixel >> 10) & 0x1F), expand5((pixel >> 5) & 0x1F), expand5(pixel & 0x1F));
+}
+
+inline uint32_t convertRGB565ToRGBA8888(uint16_t pixel) {
+    return packRGBA(expand5(pixel >> 11), expand6((pixel >> 5) & 0x3F), expand5(pixel & 0x1F));
+}
+
+inline uint16_t convertXRGB8888ToRGB565(uint32_t pixel) {
+    return static_cast<uint16_t>(((pixel >> 8) & 0xF800) | ((pixel >> 5) & 0x07E0) | ((pixel >> 3) & 0x001F));
+}
+
+// Green keeps its five bits in the upper part of the six bit field, so pure white stays 0xFFDF.
+inline uint16_t convert0RGB1555ToRGB565(uint16_t pixel) {
+    return static_cast<uint16_t>((pixel & 0x001F) | ((pixel & 0x7FE0) << 1));
+}
+
+template <typename Source, typename Destination, typename RowKernel>
+void convertRows(
+    const void* source,
+    size_t sourcePitch,
+    void* destination,
+    size_t destinationPitch,
+    unsigned width,
+    unsigned height,
+    RowKernel kernel
+) {
+    auto sourceRow = static_cast<const uint8_t*>(source);
+    auto destinationRow = static_cast<uint8_t*>(destination);
+    for (unsigned y = 0; y < height; y++) {
+        kernel(
+            reinterpret_cast<const Source*>(sourceRow),
+            reinterpret_cast<Destination*>(destinationRow),
+            width
+        );
+        sourceRow += sourcePitch;
+        destinationRow += destinationPitch;
+    }
+}
+
+void copyRows(
+    const void* source,
+    size_t sourcePitch,
+    void* destination,
+    size_t destinationPitch,
+    size_t rowBytes,
+    unsigned height
+) {
+    if (sourcePitch == rowBytes && destinationPitch == rowBytes) {
+        memcpy(destination, source, rowBytes * height);
+        return;
+    }
+    auto sourceRow = static_cast<const uint8_t*>(source);
+    auto destinationRow = static_cast<uint8_t*>(destination);
+    for (unsigned y = 0; y < height; y++) {
+        memcpy(destinationRow, sourceRow, rowBytes);
+        sourceRow += sourcePitch;
+        destinationRow += destinationPitch;
+    }
+}
+
+}
+
+size_t PixelConversion::bytesPerPixel(int pixelFormat) {
+    return pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+}
+
+void PixelConversion::toRGBA8888(
+    int pixelFormat,
+    const void* source,
+    size_t sourcePitch,
+    void* destination,
+    size_t destinationPitch,
+    unsigned width,
+    unsigned height
+) {
+    switch (pixelFormat) {
+        case RETRO_PIXEL_FORMAT_XRGB8888:
+            convertRows<uint32_t, uint32_t>(source, sourcePitch, destination, destinationPitch, width, height,
+                rowXRGB8888ToRGBA8888);
+            break;
+        case RETRO_PIXEL_FORMAT_0RGB1555:
+            convertRows<uint16_t, uint32_t>(source, sourcePitch, destination, destinationPitch, width, height,
+                row0RGB1555ToRGBA8888);
+            break;
+        default:
+        case RETRO_PIXEL_FORMAT_RGB565:
+            convertRows<uint16_t, uint32_t>(source, sourcePitch, destination, destinationPitch, width, height,
+                rowRGB565ToRGBA8888);
+            break;
+    }
+}
+
+void PixelConversion::toRGB565(
+    int pixelFormat,
+    const void* source,
+    size_t sourcePitch,
+    void* destination,
+    size_t destinationPitch,
+    unsigned width,
+    unsigned height
+) {
+    switch (pixelFormat) {
+        case RETRO_PIXEL_FORMAT_XRGB8888:
+            convertRows<uint32_t, uint16_t>(source, sourcePitch, destination, destinationPitch, width, height,
+                rowXRGB8888ToRGB565);
+            break;
+        case RETRO_PIXEL_FORMAT_0RGB1555:
+            convertRows<uint16_t, uint16_t>(source, sourcePitch, destination, destinationPitch, width, height,
+                row0RGB1555ToRGB565);
+            break;
+        default:
+        case RETRO_PIXEL_FORMAT_RGB565:
+            copyRows(source, sourcePitch, destination, destinationPitch, (size_t) width * 2, height);
+            break;
+    }
+}
+
+#if defined(__ARM_NEON)
+
+void PixelConversion::rowXRGB8888ToRGBA8888(const uint32_t* source, uint32_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t bgrx = vld4q_u8(reinterpret_cast<const uint8_t*>(source + i));
+        uint8x16x4_t rgba;
+        rgba.val[0] = bgrx.val[2];
+        rgba.val[1] = bgrx.val[1];
+        rgba.val[2] = bgrx.val[0];
+        rgba.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(reinterpret_cast<uint8_t*>(destination + i), rgba);
+    }
+    for (; i < count; i++) {
+        destination[i] = convertXRGB8888ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::row0RGB1555ToRGBA8888(const uint16_t* source, uint32_t* destination, size_t count) {
+    const uint8x8_t topFive = vdup_n_u8(0xF8);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t pixels = vld1q_u16(source + i);
+        uint8x8_t r = vand_u8(vshrn_n_u16(pixels, 7), topFive);
+        uint8x8_t g = vand_u8(vshrn_n_u16(pixels, 2), topFive);
+        uint8x8_t b = vshl_n_u8(vmovn_u16(pixels), 3);
+        uint8x8x4_t rgba;
+        rgba.val[0] = vorr_u8(r, vshr_n_u8(r, 5));
+        rgba.val[1] = vorr_u8(g, vshr_n_u8(g, 5));
+        rgba.val[2] = vorr_u8(b, vshr_n_u8(b, 5));
+        rgba.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(reinterpret_cast<uint8_t*>(destination + i), rgba);
+    }
+    for (; i < count; i++) {
+        destination[i] = convert0RGB1555ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::rowRGB565ToRGBA8888(const uint16_t* source, uint32_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t pixels = vld1q_u16(source + i);
+        uint8x8_t r = vand_u8(vshrn_n_u16(pixels, 8), vdup_n_u8(0xF8));
+        uint8x8_t g = vand_u8(vshrn_n_u16(pixels, 3), vdup_n_u8(0xFC));
+        uint8x8_t b = vshl_n_u8(vmovn_u16(pixels), 3);
+        uint8x8x4_t rgba;
+        rgba.val[0] = vorr_u8(r, vshr_n_u8(r, 5));
+        rgba.val[1] = vorr_u8(g, vshr_n_u8(g, 6));
+        rgba.val[2] = vorr_u8(b, vshr_n_u8(b, 5));
+        rgba.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(reinterpret_cast<uint8_t*>(destination + i), rgba);
+    }
+    for (; i < count; i++) {
+        destination[i] = convertRGB565ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::rowXRGB8888ToRGB565(const uint32_t* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t bgrx = vld4_u8(reinterpret_cast<const uint8_t*>(source + i));
+        uint16x8_t r = vandq_u16(vshll_n_u8(bgrx.val[2], 8), vdupq_n_u16(0xF800));
+        uint16x8_t g = vshll_n_u8(vand_u8(bgrx.val[1], vdup_n_u8(0xFC)), 3);
+        uint16x8_t b = vmovl_u8(vshr_n_u8(bgrx.val[0], 3));
+        vst1q_u16(destination + i, vorrq_u16(vorrq_u16(r, g), b));
+    }
+    for (; i < count; i++) {
+        destination[i] = convertXRGB8888ToRGB565(source[i]);
+    }
+}
+
+void PixelConversion::row0RGB1555ToRGB565(const uint16_t* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t pixels = vld1q_u16(source + i);
+        uint16x8_t blue = vandq_u16(pixels, vdupq_n_u16(0x001F));
+        uint16x8_t redGreen = vshlq_n_u16(vandq_u16(pixels, vdupq_n_u16(0x7FE0)), 1);
+        vst1q_u16(destination + i, vorrq_u16(blue, redGreen));
+    }
+    for (; i < count; i++) {
+        destination[i] = convert0RGB1555ToRGB565(source[i]);
+    }
+}
+
+#elif defined(__SSE2__)
+
+namespace {
+
+// Turns eight 8 bit channel values held in 16 bit lanes into RGBA pixels.
+inline void storeRGBA(__m128i r, __m128i g, __m128i b, uint32_t* destination) {
+    __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    __m128i ba = _mm_or_si128(b, _mm_set1_epi16((short) 0xFF00));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 4), _mm_unpackhi_epi16(rg, ba));
+}
+
+inline __m128i expand5(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+inline __m128i expand6(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4));
+}
+
+inline __m128i convertXRGB8888ToRGB565x4(__m128i pixels) {
+    __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 8), _mm_set1_epi32(0xF800));
+    __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 5), _mm_set1_epi32(0x07E0));
+    __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 3), _mm_set1_epi32(0x001F));
+    __m128i result = _mm_or_si128(_mm_or_si128(r, g), b);
+    // Sign extend so the saturating pack below leaves every value untouched.
+    return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+}
+
+}
+
+void PixelConversion::rowXRGB8888ToRGBA8888(const uint32_t* source, uint32_t* destination, size_t count) {
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    const __m128i green = _mm_set1_epi32(0xFF00);
+    const __m128i alpha = _mm_set1_epi32((int) 0xFF000000);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i b = _mm_slli_epi32(_mm_and_si128(pixels, lowByte), 16);
+        __m128i g = _mm_and_si128(pixels, green);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 16), lowByte);
+        __m128i rgba = _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), rgba);
+    }
+    for (; i < count; i++) {
+        destination[i] = convertXRGB8888ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::row0RGB1555ToRGBA8888(const uint16_t* source, uint32_t* destination, size_t count) {
+    const __m128i fiveBits = _mm_set1_epi16(0x1F);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i r = expand5(_mm_and_si128(_mm_srli_epi16(pixels, 10), fiveBits));
+        __m128i g = expand5(_mm_and_si128(_mm_srli_epi16(pixels, 5), fiveBits));
+        __m128i b = expand5(_mm_and_si128(pixels, fiveBits));
+        storeRGBA(r, g, b, destination + i);
+    }
+    for (; i < count; i++) {
+        destination[i] = convert0RGB1555ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::rowRGB565ToRGBA8888(const uint16_t* source, uint32_t* destination, size_t count) {
+    const __m128i fiveBits = _mm_set1_epi16(0x1F);
+    const __m128i sixBits = _mm_set1_epi16(0x3F);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i r = expand5(_mm_srli_epi16(pixels, 11));
+        __m128i g = expand6(_mm_and_si128(_mm_srli_epi16(pixels, 5), sixBits));
+        __m128i b = expand5(_mm_and_si128(pixels, fiveBits));
+        storeRGBA(r, g, b, destination + i);
+    }
+    for (; i < count; i++) {
+        destination[i] = convertRGB565ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::rowXRGB8888ToRGB565(const uint32_t* source, uint16_t* destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 4));
+        __m128i packed = _mm_packs_epi32(convertXRGB8888ToRGB565x4(low), convertXRGB8888ToRGB565x4(high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), packed);
+    }
+    for (; i < count; i++) {
+        destination[i] = convertXRGB8888ToRGB565(source[i]);
+    }
+}
+
+void PixelConversion::row0RGB1555ToRGB565(const uint16_t* source, uint16_t* destination, size_t count) {
+    const __m128i blueMask = _mm_set1_epi16(0x001F);
+    const __m128i redGreenMask = _mm_set1_epi16(0x7FE0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i blue = _mm_and_si128(pixels, blueMask);
+        __m128i redGreen = _mm_slli_epi16(_mm_and_si128(pixels, redGreenMask), 1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_or_si128(blue, redGreen));
+    }
+    for (; i < count; i++) {
+        destination[i] = convert0RGB1555ToRGB565(source[i]);
+    }
+}
+
+#else
+
+void PixelConversion::rowXRGB8888ToRGBA8888(const uint32_t* source, uint32_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = convertXRGB8888ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::row0RGB1555ToRGBA8888(const uint16_t* source, uint32_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = convert0RGB1555ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::rowRGB565ToRGBA8888(const uint16_t* source, uint32_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = convertRGB565ToRGBA8888(source[i]);
+    }
+}
+
+void PixelConversion::rowXRGB8888ToRGB565(const uint32_t* source, uint16_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = convertXRGB8888ToRGB565(source[i]);
+    }
+}
+
+void PixelConversion::row0RGB1555ToRGB565(const uint16_t* source, uint16_t* destination, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        destination[i] = convert0RGB1555ToRGB565(source[i]);
+    }
+}
+
+#endif
+
+} //namespace libretrodroid
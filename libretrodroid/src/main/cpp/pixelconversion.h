@@ -0,0 +1,66 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_PIXELCONVERSION_H
+#define LIBRETRODROID_PIXELCONVERSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace libretrodroid {
+
+/**
+ * Conversions from every libretro pixel format to the two layouts we hand to GL: RGBA8888 (bytes
+ * in R, G, B, A order, alpha always opaque) and RGB565. Frames are converted row by row so source
+ * and destination may use different pitches. Rows run through NEON or SSE2 kernels where the
+ * target has them and the scalar code otherwise; both produce identical output.
+ */
+class PixelConversion {
+public:
+    static size_t bytesPerPixel(int pixelFormat);
+
+    static void toRGBA8888(
+        int pixelFormat,
+        const void* source,
+        size_t sourcePitch,
+        void* destination,
+        size_t destinationPitch,
+        unsigned width,
+        unsigned height
+    );
+
+    static void toRGB565(
+        int pixelFormat,
+        const void* source,
+        size_t sourcePitch,
+        void* destination,
+        size_t destinationPitch,
+        unsigned width,
+        unsigned height
+    );
+
+    // Single row kernels.
+    static void rowXRGB8888ToRGBA8888(const uint32_t* source, uint32_t* destination, size_t count);
+    static void row0RGB1555ToRGBA8888(const uint16_t* source, uint32_t* destination, size_t count);
+    static void rowRGB565ToRGBA8888(const uint16_t* source, uint32_t* destination, size_t count);
+    static void rowXRGB8888ToRGB565(const uint32_t* source, uint16_t* destination, size_t count);
+    static void row0RGB1555ToRGB565(const uint16_t* source, uint16_t* destination, size_t count);
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_PIXELCONVERSION_H
@@ -0,0 +1,178 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ */
+
+#include "pixelconversion_test.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "pixelconversion.h"
+#include "libretro/libretro-common/include/libretro.h"
+
+namespace libretrodroid::test {
+
+namespace {
+
+// Widths around every SIMD block size, so both the vector body and the scalar tail are covered.
+const unsigned WIDTHS[] = { 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 33, 256, 320 };
+const unsigned HEIGHT = 5;
+const size_t PADDING = 24;
+
+std::vector<uint8_t> makeFrame(size_t pitch, unsigned height, uint32_t seed) {
+    std::vector<uint8_t> frame(pitch * height);
+    uint32_t state = seed;
+    for (auto& byte : frame) {
+        state = state * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+    return frame;
+}
+
+// The per-pixel conversion Video::captureRawFrame used before the shared kernels.
+std::vector<uint8_t> referenceRGBA8888(int pixelFormat, const uint8_t* data, size_t pitch, int width, int height) {
+    std::vector<uint8_t> rgba((size_t) width * height * 4);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* srcRow = data + (size_t) y * pitch;
+        uint8_t* dstRow = rgba.data() + (size_t) y * width * 4;
+        for (int x = 0; x < width; x++) {
+            uint8_t r, g, b;
+            if (pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888) {
+                const uint8_t* p = srcRow + x * 4;
+                b = p[0]; g = p[1]; r = p[2];
+            } else if (pixelFormat == RETRO_PIXEL_FORMAT_0RGB1555) {
+                uint16_t p;
+                memcpy(&p, srcRow + x * 2, 2);
+                uint8_t r5 = (p >> 10) & 0x1F, g5 = (p >> 5) & 0x1F, b5 = p & 0x1F;
+                r = (r5 << 3) | (r5 >> 2); g = (g5 << 3) | (g5 >> 2); b = (b5 << 3) | (b5 >> 2);
+            } else {
+                uint16_t p;
+                memcpy(&p, srcRow + x * 2, 2);
+                uint8_t r5 = (p >> 11) & 0x1F, g6 = (p >> 5) & 0x3F, b5 = p & 0x1F;
+                r = (r5 << 3) | (r5 >> 2); g = (g6 << 2) | (g6 >> 4); b = (b5 << 3) | (b5 >> 2);
+            }
+            uint8_t* d = dstRow + x * 4;
+            d[0] = r; d[1] = g; d[2] = b; d[3] = 255;
+        }
+    }
+    return rgba;
+}
+
+// The in-place conversion the image renderers applied to 0RGB1555 frames.
+uint16_t reference0RGB1555ToRGB565(uint16_t pixel) {
+    return static_cast<uint16_t>(((0x1Fu) & pixel)
+        | (((0x1Fu << 5) & pixel) << 1)
+        | (((0x1Fu << 10) & pixel) << 1));
+}
+
+uint16_t referenceXRGB8888ToRGB565(uint32_t pixel) {
+    uint32_t r = (pixel >> 16) & 0xFF, g = (pixel >> 8) & 0xFF, b = pixel & 0xFF;
+    return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+bool checkRGBA8888(int pixelFormat) {
+    size_t bytesPerPixel = PixelConversion::bytesPerPixel(pixelFormat);
+    for (unsigned width : WIDTHS) {
+        size_t pitch = width * bytesPerPixel + PADDING;
+        std::vector<uint8_t> frame = makeFrame(pitch, HEIGHT, width);
+        std::vector<uint8_t> expected = referenceRGBA8888(pixelFormat, frame.data(), pitch, width, HEIGHT);
+
+        std::vector<uint8_t> actual(expected.size());
+        PixelConversion::toRGBA8888(pixelFormat, frame.data(), pitch, actual.data(), width * 4, width, HEIGHT);
+        if (actual != expected) return false;
+    }
+    return true;
+}
+
+bool checkRGB565(int pixelFormat) {
+    size_t bytesPerPixel = PixelConversion::bytesPerPixel(pixelFormat);
+    for (unsigned width : WIDTHS) {
+        size_t pitch = width * bytesPerPixel + PADDING;
+        std::vector<uint8_t> frame = makeFrame(pitch, HEIGHT, width * 7);
+
+        // Destination rows are padded too; the padding must come out untouched.
+        size_t destinationPitch = width * 2 + PADDING;
+        std::vector<uint8_t> actual(destinationPitch * HEIGHT, 0xAB);
+        PixelConversion::toRGB565(pixelFormat, frame.data(), pitch, actual.data(), destinationPitch, width, HEIGHT);
+
+        for (unsigned y = 0; y < HEIGHT; y++) {
+            for (unsigned x = 0; x < width; x++) {
+                const uint8_t* source = frame.data() + y * pitch + x * bytesPerPixel;
+                uint16_t expected;
+                if (pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888) {
+                    uint32_t pixel;
+                    memcpy(&pixel, source, 4);
+                    expected = referenceXRGB8888ToRGB565(pixel);
+                } else if (pixelFormat == RETRO_PIXEL_FORMAT_0RGB1555) {
+                    uint16_t pixel;
+                    memcpy(&pixel, source, 2);
+                    expected = reference0RGB1555ToRGB565(pixel);
+                } else {
+                    memcpy(&expected, source, 2);
+                }
+
+                uint16_t converted;
+                memcpy(&converted, actual.data() + y * destinationPitch + x * 2, 2);
+                if (converted != expected) return false;
+            }
+            const uint8_t* padding = actual.data() + y * destinationPitch + width * 2;
+            for (size_t i = 0; i < PADDING; i++) {
+                if (padding[i] != 0xAB) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Every 16 bit input value through a single row, compared with the scalar reference.
+bool checkExhaustive16Bit() {
+    std::vector<uint16_t> input(65536);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<uint16_t>(i);
+    }
+
+    std::vector<uint16_t> rgb565(input.size());
+    PixelConversion::row0RGB1555ToRGB565(input.data(), rgb565.data(), input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        if (rgb565[i] != reference0RGB1555ToRGB565(input[i])) return false;
+    }
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input.data());
+    std::vector<uint32_t> rgba(input.size());
+    for (int pixelFormat : { RETRO_PIXEL_FORMAT_0RGB1555, RETRO_PIXEL_FORMAT_RGB565 }) {
+        if (pixelFormat == RETRO_PIXEL_FORMAT_0RGB1555) {
+            PixelConversion::row0RGB1555ToRGBA8888(input.data(), rgba.data(), input.size());
+        } else {
+            PixelConversion::rowRGB565ToRGBA8888(input.data(), rgba.data(), input.size());
+        }
+        std::vector<uint8_t> expected = referenceRGBA8888(pixelFormat, bytes, input.size() * 2, input.size(), 1);
+        if (memcmp(rgba.data(), expected.data(), expected.size()) != 0) return false;
+    }
+    return true;
+}
+
+}
+
+int runPixelConversionTests() {
+    int passed = 0;
+
+    if (checkRGBA8888(RETRO_PIXEL_FORMAT_XRGB8888)) ++passed;
+    if (checkRGBA8888(RETRO_PIXEL_FORMAT_0RGB1555)) ++passed;
+    if (checkRGBA8888(RETRO_PIXEL_FORMAT_RGB565)) ++passed;
+
+    if (checkRGB565(RETRO_PIXEL_FORMAT_XRGB8888)) ++passed;
+    if (checkRGB565(RETRO_PIXEL_FORMAT_0RGB1555)) ++passed;
+    if (checkRGB565(RETRO_PIXEL_FORMAT_RGB565)) ++passed;
+
+    if (checkExhaustive16Bit()) ++passed;
+
+    return passed;
+}
+
+} // namespace libretrodroid::test
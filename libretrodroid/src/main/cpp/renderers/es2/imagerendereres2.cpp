@@ -16,13 +16,40 @@
  */
 
 #include "imagerendereres2.h"
+
+#include <cstring>
+
+#include "GLES2/gl2ext.h"
 #include "../../libretro-common/include/libretro.h"
+#include "../../pixelconversion.h"
 
 namespace libretrodroid {
 
+namespace {
+
+bool hasGLExtension(const char* name) {
+    auto extensions = (const char*) glGetString(GL_EXTENSIONS);
+    if (extensions == nullptr) return false;
+
+    size_t length = strlen(name);
+    for (const char* match = strstr(extensions, name); match != nullptr; match = strstr(match + length, name)) {
+        bool startsToken = match == extensions || match[-1] == ' ';
+        bool endsToken = match[length] == ' ' || match[length] == '\0';
+        if (startsToken && endsToken) return true;
+    }
+    return false;
+}
+
+}
+
 ImageRendererES2::ImageRendererES2() {
     glGenTextures(1, &currentTexture);
     glBindTexture(GL_TEXTURE_2D, currentTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    supportsUnpackSubimage = hasGLExtension("GL_EXT_unpack_subimage");
 }
 
 void ImageRendererES2::onNewFrame(const void *data, unsigned width, unsigned height, size_t pitch) {
@@ -30,30 +57,44 @@ void ImageRendererES2::onNewFrame(const void *data, unsigned width, unsigned hei
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, bytesPerPixel);
 
+    // ES2 has no swizzle, so XRGB8888 is reordered to RGBA and 0RGB1555 repacked as RGB565.
     if (pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888) {
-        convertDataFromRGB8888(data, pitch * height);
+        convertedFrame.resize((size_t) width * height * 4);
+        PixelConversion::toRGBA8888(pixelFormat, data, pitch, convertedFrame.data(), width * 4, width, height);
+        data = convertedFrame.data();
+        pitch = width * 4;
     } else if (pixelFormat == RETRO_PIXEL_FORMAT_0RGB1555) {
-        convertDataFrom0RGB1555(data, width, height, pitch);
+        convertedFrame.resize((size_t) width * height * 2);
+        PixelConversion::toRGB565(pixelFormat, data, pitch, convertedFrame.data(), width * 2, width, height);
+        data = convertedFrame.data();
+        pitch = width * 2;
     }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (appliedLinear != linear) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+        appliedLinear = linear;
+    }
 
     if (lastFrameSize.first != width || lastFrameSize.second != height) {
         glTexImage2D(GL_TEXTURE_2D, 0, glInternalFormat, width, height, 0, glFormat, glType, nullptr);
     }
 
-    // If the given texture has the correct size we just upload it.
-    if (bytesPerPixel * width == pitch) {
+    bool padded = bytesPerPixel * width != pitch;
+    if (padded && supportsUnpackSubimage && pitch % bytesPerPixel == 0) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, pitch / bytesPerPixel);
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, glType, data);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
     } else {
-        // Here we are forced to take the long and slow way to upload the padded texture.
-        for (int i = 0; i < height; i++) {
-            auto row = (char*) data + (pitch) * i;
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, i, width, 1, glFormat, glType, row);
+        // Without a row length the padding has to go. Converted frames are already packed, so only
+        // RGB565 frames straight from the core can get here.
+        if (padded) {
+            convertedFrame.resize((size_t) width * height * 2);
+            PixelConversion::toRGB565(RETRO_PIXEL_FORMAT_RGB565, data, pitch, convertedFrame.data(), width * 2, width, height);
+            data = convertedFrame.data();
+            pitch = width * 2;
         }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, glType, data);
     }
 
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -61,17 +102,6 @@ void ImageRendererES2::onNewFrame(const void *data, unsigned width, unsigned hei
     Renderer::onNewFrame(data, width, height, pitch);
 }
 
-void ImageRendererES2::convertDataFromRGB8888(const void *data, size_t size) {
-    char* pixelData = (char*) data;
-
-    for (int i = 0; i < size - 4; i += 4) {
-        auto currentRed = pixelData[i + 0];
-        auto currentBlue = pixelData[i + 2];
-        pixelData[i + 0] = currentBlue;
-        pixelData[i + 2] = currentRed;
-    }
-}
-
 uintptr_t ImageRendererES2::getTexture() {
     return currentTexture;
 }
@@ -102,16 +132,6 @@ void ImageRendererES2::setPixelFormat(int pixelFormat) {
     }
 }
 
-void ImageRendererES2::convertDataFrom0RGB1555(const void *data, unsigned int width, unsigned int height, size_t pitch) const {
-    auto castData = (uint16_t*) data;
-
-    for (int i = 0; i < height * pitch / bytesPerPixel; ++i) {
-         castData[i] = ((0x1Fu) & castData[i])
-            | (((0x1Fu << 5) & castData[i]) << 1)
-            | (((0x1Fu << 10) & castData[i]) << 1);
-    }
-}
-
 void ImageRendererES2::updateRenderedResolution(unsigned int width, unsigned int height) {}
 
 bool ImageRendererES2::rendersInVideoCallback() {
@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <utility>
 #include <vector>
+#include <optional>
 
 namespace libretrodroid {
 
@@ -43,10 +44,6 @@ public:
 
     PassData getPassData(unsigned int layer) override;
 
-private:
-    void convertDataFromRGB8888(const void* pixelData, size_t size);
-    void convertDataFrom0RGB1555(const void *data, unsigned int width, unsigned int height, size_t pitch) const;
-
 private:
     int pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
     unsigned int bytesPerPixel = 1;
@@ -55,8 +52,13 @@ private:
     unsigned int glFormat = 0;
 
     bool linear = false;
+    std::optional<bool> appliedLinear = std::nullopt;
+    bool supportsUnpackSubimage = false;
 
     unsigned int currentTexture = 0;
+
+    // Frames needing conversion land here, the core's buffer must stay untouched.
+    std::vector<uint8_t> convertedFrame;
 };
 
 }
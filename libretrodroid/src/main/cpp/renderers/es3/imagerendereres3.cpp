@@ -18,6 +18,7 @@
 #include "imagerendereres3.h"
 #include "../../libretro-common/include/libretro.h"
 #include "es3utils.h"
+#include "../../pixelconversion.h"
 
 namespace libretrodroid {
 
@@ -28,7 +29,10 @@ ImageRendererES3::ImageRendererES3() {
 
 void ImageRendererES3::onNewFrame(const void *data, unsigned width, unsigned height, size_t pitch) {
     if (pixelFormat == RETRO_PIXEL_FORMAT_0RGB1555) {
-        convertDataFrom0RGB1555(data, width, height, pitch);
+        convertedFrame.resize((size_t) width * height);
+        PixelConversion::toRGB565(pixelFormat, data, pitch, convertedFrame.data(), width * 2, width, height);
+        data = convertedFrame.data();
+        pitch = width * 2;
     }
 
     if (lastFrameSize.first != width || lastFrameSize.second != height || isDirty) {
@@ -113,16 +117,6 @@ void ImageRendererES3::setPixelFormat(int pixelFormat) {
     }
 }
 
-void ImageRendererES3::convertDataFrom0RGB1555(const void *data, unsigned int width, unsigned int height, size_t pitch) const {
-    auto castData = (uint16_t*) data;
-
-    for (int i = 0; i < height * pitch / bytesPerPixel; ++i) {
-        castData[i] = ((0x1Fu) & castData[i])
-            | (((0x1Fu << 5) & castData[i]) << 1)
-            | (((0x1Fu << 10) & castData[i]) << 1);
-    }
-}
-
 void ImageRendererES3::updateRenderedResolution(unsigned int width, unsigned int height) {}
 
 bool ImageRendererES3::rendersInVideoCallback() {
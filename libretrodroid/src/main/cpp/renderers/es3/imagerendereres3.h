@@ -49,7 +49,6 @@ public:
 private:
     void initializeTextures(unsigned int width, unsigned int height);
     void applyGLSwizzle(int r, int g, int b, int a);
-    void convertDataFrom0RGB1555(const void *data, unsigned int width, unsigned int height, size_t pitch) const;
 
 private:
     int pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
@@ -63,6 +62,9 @@ private:
 
     unsigned int currentTexture = 0;
 
+    // 0RGB1555 frames are converted here, the core's buffer must stay untouched.
+    std::vector<uint16_t> convertedFrame;
+
     ShaderManager::Chain shaders;
     std::unique_ptr<ES3Utils::Framebuffers> framebuffers = std::make_unique<ES3Utils::Framebuffers>();
 };
@@ -15,6 +15,7 @@
  *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
 #include <algorithm>
 #include "sincresampler.h"
 
@@ -52,7 +53,7 @@ void SincResampler::resample(const int16_t *source, int32_t inputFrames, int16_t
 }
 
 float SincResampler::sinc(float x) {
-    if (abs(x) < 1.0e-9) return 1.0;
+    if (std::fabs(x) < 1.0e-9) return 1.0;
     return sinf(x * PI_F) / (x * PI_F);
 }
 
@@ -0,0 +1,247 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "romhasher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <rc_hash.h>
+
+#include "log.h"
+
+namespace libretrodroid {
+
+namespace {
+
+struct FileStamp {
+    int64_t size;
+    int64_t mtime;
+};
+
+bool statFile(const std::string& path, FileStamp& stamp) {
+    struct stat st {};
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    stamp.size = static_cast<int64_t>(st.st_size);
+    stamp.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+}
+
+RomHasher::RomHasher(std::string cachePath) : cachePath(std::move(cachePath)) {
+    loadCache();
+}
+
+std::vector<std::string> RomHasher::hashAll(
+    const std::vector<Request>& requests,
+    unsigned int maxThreads,
+    const ProgressHandler& progressHandler
+) {
+    const size_t total = requests.size();
+    std::vector<std::string> results(total);
+    std::vector<FileStamp> stamps(total);
+    std::vector<size_t> pending;
+
+    size_t completed = 0;
+    for (size_t i = 0; i < total; i++) {
+        const Request& request = requests[i];
+        if (!statFile(request.path, stamps[i])) {
+            LOGW("Skipping hash of missing file %s", request.path.c_str());
+            completed++;
+            continue;
+        }
+
+        auto cached = cache.find(cacheKey(request.path, request.consoleId));
+        if (cached != cache.end() && cached->second.size == stamps[i].size && cached->second.mtime == stamps[i].mtime) {
+            results[i] = cached->second.hash;
+            completed++;
+            continue;
+        }
+
+        pending.push_back(i);
+    }
+
+    if (progressHandler && completed > 0) {
+        progressHandler(completed, total);
+    }
+
+    if (!pending.empty()) {
+        unsigned int threadCount = maxThreads > 0 ? maxThreads : DEFAULT_THREADS;
+        threadCount = std::min<unsigned int>(threadCount, std::max(1U, std::thread::hardware_concurrency()));
+        threadCount = std::min<unsigned int>(threadCount, pending.size());
+
+        std::mutex mutex;
+        std::condition_variable progressChanged;
+        std::atomic<size_t> nextPending { 0 };
+        size_t finished = 0;
+
+        auto worker = [&]() {
+            while (true) {
+                size_t slot = nextPending.fetch_add(1);
+                if (slot >= pending.size()) break;
+
+                // Warm the page cache for the file queued behind this one while we hash the current.
+                size_t lookahead = slot + threadCount;
+                if (lookahead < pending.size()) {
+                    size_t next = pending[lookahead];
+                    if (stamps[next].size <= PREFETCH_LIMIT) {
+                        int fd = open(requests[next].path.c_str(), O_RDONLY | O_CLOEXEC);
+                        if (fd >= 0) {
+                            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+                            close(fd);
+                        }
+                    }
+                }
+
+                size_t index = pending[slot];
+                std::string hash = hashFile(requests[index]);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                results[index] = std::move(hash);
+                finished++;
+                progressChanged.notify_one();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; i++) {
+            workers.emplace_back(worker);
+        }
+
+        size_t reported = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (reported < pending.size()) {
+            progressChanged.wait(lock, [&]() { return finished != reported; });
+            reported = finished;
+
+            lock.unlock();
+            if (progressHandler) {
+                progressHandler(completed + reported, total);
+            }
+            lock.lock();
+        }
+        lock.unlock();
+
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        for (size_t index : pending) {
+            if (results[index].empty() || requests[index].path.find('\n') != std::string::npos) continue;
+
+            cache[cacheKey(requests[index].path, requests[index].consoleId)] = CacheEntry {
+                stamps[index].size, stamps[index].mtime, results[index]
+            };
+            cacheDirty = true;
+        }
+    }
+
+    if (cacheDirty) {
+        saveCache();
+    }
+
+    return results;
+}
+
+std::string RomHasher::cacheKey(const std::string& path, uint32_t consoleId) {
+    return std::to_string(consoleId) + '\t' + path;
+}
+
+std::string RomHasher::hashFile(const Request& request) {
+    char hash[33] = {0};
+    if (rc_hash_generate_from_file(hash, request.consoleId, request.path.c_str()) == 0) {
+        LOGW("Failed to compute hash for %s (console %u)", request.path.c_str(), request.consoleId);
+        return std::string();
+    }
+    return std::string(hash);
+}
+
+void RomHasher::loadCache() {
+    if (cachePath.empty()) return;
+
+    std::ifstream input(cachePath);
+    if (!input.is_open()) return;
+
+    std::string line;
+    while (std::getline(input, line)) {
+        std::istringstream fields(line);
+        uint32_t consoleId;
+        CacheEntry entry {};
+        if (!(fields >> consoleId >> entry.size >> entry.mtime >> entry.hash)) continue;
+
+        fields.get();
+        std::string path;
+        std::getline(fields, path);
+        if (path.empty() || entry.hash.size() != 32) continue;
+
+        cache[cacheKey(path, consoleId)] = std::move(entry);
+    }
+
+    LOGI("Loaded %zu cached ROM hashes from %s", cache.size(), cachePath.c_str());
+}
+
+void RomHasher::saveCache() {
+    if (cachePath.empty()) return;
+
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream output(tempPath, std::ios::trunc);
+        if (!output.is_open()) {
+            LOGW("Unable to write ROM hash cache %s", tempPath.c_str());
+            return;
+        }
+
+        for (const auto& item : cache) {
+            size_t separator = item.first.find('\t');
+            output << item.first.substr(0, separator) << '\t'
+                   << item.second.size << '\t'
+                   << item.second.mtime << '\t'
+                   << item.second.hash << '\t'
+                   << item.first.substr(separator + 1) << '\n';
+        }
+
+        if (!output.good()) {
+            LOGW("Failed writing ROM hash cache %s", tempPath.c_str());
+            return;
+        }
+    }
+
+    if (rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+        LOGW("Unable to replace ROM hash cache %s", cachePath.c_str());
+        unlink(tempPath.c_str());
+        return;
+    }
+
+    cacheDirty = false;
+}
+
+} //namespace libretrodroid
@@ -0,0 +1,76 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_ROMHASHER_H
+#define LIBRETRODROID_ROMHASHER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Computes RetroAchievements hashes for many ROMs at once on a bounded pool of worker threads.
+ * Results are memoized in a plain text cache file keyed by (path, size, mtime, console id), so a
+ * library rescan only re-reads files that actually changed. Progress is always reported on the
+ * calling thread, which makes it safe to forward straight to JNI.
+ */
+class RomHasher {
+public:
+    struct Request {
+        std::string path;
+        uint32_t consoleId;
+    };
+
+    typedef std::function<void(size_t completed, size_t total)> ProgressHandler;
+
+    explicit RomHasher(std::string cachePath);
+
+    std::vector<std::string> hashAll(
+        const std::vector<Request>& requests,
+        unsigned int maxThreads,
+        const ProgressHandler& progressHandler
+    );
+
+private:
+    struct CacheEntry {
+        int64_t size;
+        int64_t mtime;
+        std::string hash;
+    };
+
+    static constexpr unsigned int DEFAULT_THREADS = 4;
+    static constexpr int64_t PREFETCH_LIMIT = 64 * 1024 * 1024;
+
+    static std::string cacheKey(const std::string& path, uint32_t consoleId);
+    static std::string hashFile(const Request& request);
+
+    void loadCache();
+    void saveCache();
+
+private:
+    std::string cachePath;
+    std::unordered_map<std::string, CacheEntry> cache;
+    bool cacheDirty = false;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_ROMHASHER_H
@@ -21,8 +21,8 @@
 
 namespace libretrodroid {
 
-void Rumble::fetchFromEnvironment() {
-    auto environmentStates = Environment::getInstance().getLastRumbleStates();
+void Rumble::fetchFromEnvironment(Environment& environment) {
+    auto environmentStates = environment.getLastRumbleStates();
 
     for (int i = 0; i < environmentStates.size(); ++i) {
         if (rumbleStates[i] == environmentStates[i]) {
@@ -23,11 +23,13 @@
 
 #include "rumblestate.h"
 
+class Environment;
+
 namespace libretrodroid {
 
 class Rumble {
 public:
-    void fetchFromEnvironment();
+    void fetchFromEnvironment(Environment& environment);
     void handleRumbleUpdates(const std::function<void(int, float, float)> &handler);
 
 private:
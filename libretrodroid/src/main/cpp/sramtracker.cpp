@@ -0,0 +1,90 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sramtracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libretrodroid {
+
+void SramTracker::reset(const uint8_t* data, size_t size) {
+    shadow.assign(data, data + size);
+    dirty.assign(pageCount(), 0);
+    dirtyCount = 0;
+}
+
+void SramTracker::markAllDirty() {
+    std::fill(dirty.begin(), dirty.end(), 1);
+    dirtyCount = dirty.size();
+}
+
+size_t SramTracker::scan(const uint8_t* data, size_t size) {
+    // A core that resized its save RAM leaves nothing in the shadow worth comparing against.
+    if (size != shadow.size()) {
+        shadow.resize(size);
+        dirty.resize(pageCount());
+        markAllDirty();
+        return dirtyCount;
+    }
+
+    // Pages stay dirty until flushed, so only the clean ones need comparing. memcmp is vectorized
+    // by libc and bails out at the first difference.
+    for (size_t page = 0; page < dirty.size(); page++) {
+        if (dirty[page]) continue;
+        size_t offset = page * PAGE_SIZE;
+        size_t length = std::min(PAGE_SIZE, size - offset);
+        if (memcmp(data + offset, shadow.data() + offset, length) != 0) {
+            dirty[page] = 1;
+            dirtyCount++;
+        }
+    }
+    return dirtyCount;
+}
+
+int64_t SramTracker::flush(const uint8_t* data, size_t size, const Sink& sink) {
+    scan(data, size);
+
+    int64_t written = 0;
+    size_t page = 0;
+    while (page < dirty.size()) {
+        if (!dirty[page]) {
+            page++;
+            continue;
+        }
+
+        size_t first = page;
+        while (page < dirty.size() && dirty[page]) page++;
+
+        size_t offset = first * PAGE_SIZE;
+        size_t length = std::min(page * PAGE_SIZE, size) - offset;
+        if (!sink(offset, data + offset, length)) return -1;
+        written += static_cast<int64_t>(length);
+    }
+
+    // Only now that the file matches memory may the shadow follow it.
+    for (size_t i = 0; i < dirty.size(); i++) {
+        if (!dirty[i]) continue;
+        size_t offset = i * PAGE_SIZE;
+        memcpy(shadow.data() + offset, data + offset, std::min(PAGE_SIZE, size - offset));
+        dirty[i] = 0;
+    }
+    dirtyCount = 0;
+    return written;
+}
+
+} //namespace libretrodroid
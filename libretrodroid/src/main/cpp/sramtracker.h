@@ -0,0 +1,70 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_SRAMTRACKER_H
+#define LIBRETRODROID_SRAMTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Finds the pages of a core's save RAM that changed since they were last written out. A shadow
+ * copy holds what the save file contains; scanning compares memory against it a page at a time,
+ * so an autosave only has to write the pages that differ. Not thread safe, callers serialize it
+ * with the core.
+ */
+class SramTracker {
+public:
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    /** Receives a run of dirty bytes and the offset they belong at in the save file. */
+    typedef std::function<bool(size_t offset, const uint8_t* data, size_t size)> Sink;
+
+    /** Takes data as what the save file holds, with no page dirty. */
+    void reset(const uint8_t* data, size_t size);
+
+    /** Marks every page dirty, for a save file that cannot be trusted to match the shadow. */
+    void markAllDirty();
+
+    /** Marks the pages that differ from the shadow. Returns the number of dirty pages. */
+    size_t scan(const uint8_t* data, size_t size);
+
+    /**
+     * Scans, then passes each run of dirty pages to sink. Once every write succeeded the written
+     * pages become the new shadow. Returns the number of bytes written, or -1 on failure.
+     */
+    int64_t flush(const uint8_t* data, size_t size, const Sink& sink);
+
+    size_t getDirtyPageCount() const { return dirtyCount; }
+    size_t getSize() const { return shadow.size(); }
+
+private:
+    size_t pageCount() const { return (shadow.size() + PAGE_SIZE - 1) / PAGE_SIZE; }
+
+private:
+    std::vector<uint8_t> shadow;
+    std::vector<uint8_t> dirty;
+    size_t dirtyCount = 0;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_SRAMTRACKER_H
@@ -0,0 +1,92 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ */
+
+#include "sramtracker_test.h"
+#include "sramtracker.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace libretrodroid::test {
+
+namespace {
+
+// Applies each flushed run to file at its offset, the way the pwrite sink does.
+SramTracker::Sink fileSink(std::vector<uint8_t>& file, size_t& runs) {
+    return [&file, &runs](size_t offset, const uint8_t* data, size_t size) {
+        if (offset + size > file.size()) file.resize(offset + size);
+        std::copy(data, data + size, file.begin() + offset);
+        runs++;
+        return true;
+    };
+}
+
+}
+
+int runSramTrackerTests() {
+    const size_t page = SramTracker::PAGE_SIZE;
+    int passed = 0;
+
+    // 16 pages and a partial one, as flash sizes are not always page multiples.
+    std::vector<uint8_t> sram(16 * page + 100);
+    for (size_t i = 0; i < sram.size(); i++) sram[i] = static_cast<uint8_t>(i * 7 + (i >> 12));
+    std::vector<uint8_t> file = sram;
+
+    SramTracker tracker;
+    tracker.reset(sram.data(), sram.size());
+    if (tracker.scan(sram.data(), sram.size()) == 0) {
+        ++passed;
+    }
+
+    // Adjacent dirty pages go out as one run, and only they do.
+    sram[3 * page + 10] ^= 0xff;
+    sram[4 * page] ^= 0xff;
+    sram[9 * page + 4095] ^= 0xff;
+    sram[sram.size() - 1] ^= 0xff;
+    size_t runs = 0;
+    if (tracker.scan(sram.data(), sram.size()) == 4) {
+        int64_t written = tracker.flush(sram.data(), sram.size(), fileSink(file, runs));
+        if (written == static_cast<int64_t>(3 * page + 100) && runs == 3 && file == sram
+            && tracker.getDirtyPageCount() == 0) {
+            ++passed;
+        }
+    }
+
+    // A page written back to what the file holds is still flushed, since the shadow is untouched
+    // until then, and a failed write leaves every page dirty for the next attempt.
+    sram[0] ^= 0x01;
+    tracker.scan(sram.data(), sram.size());
+    sram[0] ^= 0x01;
+    sram[5 * page] ^= 0x01;
+    int64_t failed = tracker.flush(sram.data(), sram.size(), [](size_t, const uint8_t*, size_t) { return false; });
+    runs = 0;
+    if (failed == -1 && tracker.getDirtyPageCount() == 2
+        && tracker.flush(sram.data(), sram.size(), fileSink(file, runs)) == static_cast<int64_t>(2 * page)
+        && runs == 2 && file == sram) {
+        ++passed;
+    }
+
+    // A resized save RAM and an untrusted file are written out whole.
+    sram.resize(sram.size() + page);
+    std::vector<uint8_t> fresh;
+    runs = 0;
+    if (tracker.flush(sram.data(), sram.size(), fileSink(fresh, runs)) == static_cast<int64_t>(sram.size())
+        && fresh == sram) {
+        tracker.markAllDirty();
+        std::vector<uint8_t> rewritten;
+        if (tracker.flush(sram.data(), sram.size(), fileSink(rewritten, runs)) == static_cast<int64_t>(sram.size())
+            && rewritten == sram) {
+            ++passed;
+        }
+    }
+
+    return passed;
+}
+
+} // namespace libretrodroid::test
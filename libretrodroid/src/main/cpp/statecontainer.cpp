@@ -0,0 +1,192 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "statecontainer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <zlib.h>
+
+#include "log.h"
+
+namespace libretrodroid {
+
+namespace {
+
+const uint8_t MAGIC[4] = { 'L', 'D', 'S', 'T' };
+
+const size_t VERSION_OFFSET = 4;
+const size_t CODEC_OFFSET = 6;
+const size_t STATE_SIZE_OFFSET = 8;
+const size_t CRC32_OFFSET = 16;
+const size_t CORE_ID_OFFSET = 24;
+
+// Header fields are little endian, which matches every ABI we ship.
+template <typename T>
+void putField(uint8_t* header, size_t offset, T value) {
+    memcpy(header + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T getField(const uint8_t* header, size_t offset) {
+    T value;
+    memcpy(&value, header + offset, sizeof(T));
+    return value;
+}
+
+}
+
+size_t StateContainer::maxContainerSize(size_t stateSize) {
+    return HEADER_SIZE + compressBound(stateSize);
+}
+
+bool StateContainer::write(const uint8_t* state, size_t stateSize, const std::string& coreId, const Sink& sink) {
+    uint8_t header[HEADER_SIZE] = {0};
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    putField<uint16_t>(header, VERSION_OFFSET, VERSION);
+    putField<uint16_t>(header, CODEC_OFFSET, CODEC_ZLIB);
+    putField<uint64_t>(header, STATE_SIZE_OFFSET, stateSize);
+    putField<uint32_t>(header, CRC32_OFFSET, crc32(0L, state, stateSize));
+    memcpy(header + CORE_ID_OFFSET, coreId.data(), std::min(coreId.size(), CORE_ID_SIZE));
+
+    if (!sink(header, HEADER_SIZE)) {
+        return false;
+    }
+
+    z_stream stream {};
+    if (deflateInit(&stream, COMPRESSION_LEVEL) != Z_OK) {
+        LOGE("Unable to initialize state compression");
+        return false;
+    }
+
+    std::vector<uint8_t> output(CHUNK_SIZE);
+    const uint8_t* input = state;
+    size_t remaining = stateSize;
+    int status = Z_OK;
+
+    while (status != Z_STREAM_END) {
+        if (stream.avail_in == 0 && remaining > 0) {
+            uInt chunk = static_cast<uInt>(std::min(remaining, CHUNK_SIZE));
+            stream.next_in = const_cast<Bytef*>(input);
+            stream.avail_in = chunk;
+            input += chunk;
+            remaining -= chunk;
+        }
+
+        stream.next_out = output.data();
+        stream.avail_out = static_cast<uInt>(output.size());
+        status = deflate(&stream, remaining == 0 ? Z_FINISH : Z_NO_FLUSH);
+        if (status == Z_STREAM_ERROR) {
+            break;
+        }
+
+        size_t produced = output.size() - stream.avail_out;
+        if (produced > 0 && !sink(output.data(), produced)) {
+            status = Z_STREAM_ERROR;
+            break;
+        }
+    }
+
+    LOGD("Compressed state %zu -> %lu bytes", stateSize, stream.total_out);
+    deflateEnd(&stream);
+    return status == Z_STREAM_END;
+}
+
+bool StateContainer::readHeader(const Source& source, Header& header) {
+    uint8_t raw[HEADER_SIZE];
+    if (!readFully(source, raw, HEADER_SIZE)) {
+        LOGE("State container is truncated");
+        return false;
+    }
+
+    if (memcmp(raw, MAGIC, sizeof(MAGIC)) != 0) {
+        LOGE("Not a state container");
+        return false;
+    }
+
+    header.version = getField<uint16_t>(raw, VERSION_OFFSET);
+    header.codec = getField<uint16_t>(raw, CODEC_OFFSET);
+    header.stateSize = getField<uint64_t>(raw, STATE_SIZE_OFFSET);
+    header.crc32 = getField<uint32_t>(raw, CRC32_OFFSET);
+
+    const char* coreId = reinterpret_cast<const char*>(raw + CORE_ID_OFFSET);
+    header.coreId = std::string(coreId, strnlen(coreId, CORE_ID_SIZE));
+
+    if (header.version != VERSION || header.codec != CODEC_ZLIB) {
+        LOGE("Unsupported state container version %u codec %u", header.version, header.codec);
+        return false;
+    }
+    if (header.stateSize == 0 || header.stateSize > MAX_STATE_SIZE) {
+        LOGE("State container claims an invalid state size %llu", (unsigned long long) header.stateSize);
+        return false;
+    }
+    return true;
+}
+
+bool StateContainer::readState(const Source& source, const Header& header, uint8_t* state) {
+    z_stream stream {};
+    if (inflateInit(&stream) != Z_OK) {
+        LOGE("Unable to initialize state decompression");
+        return false;
+    }
+
+    std::vector<uint8_t> input(CHUNK_SIZE);
+    stream.next_out = state;
+    stream.avail_out = static_cast<uInt>(header.stateSize);
+    int status = Z_OK;
+
+    while (status == Z_OK) {
+        if (stream.avail_in == 0) {
+            ssize_t count = source(input.data(), input.size());
+            if (count <= 0) {
+                status = Z_DATA_ERROR;
+                break;
+            }
+            stream.next_in = input.data();
+            stream.avail_in = static_cast<uInt>(count);
+        }
+        status = inflate(&stream, Z_NO_FLUSH);
+    }
+
+    bool success = status == Z_STREAM_END && stream.total_out == header.stateSize;
+    inflateEnd(&stream);
+
+    if (!success) {
+        LOGE("State container payload is corrupted (zlib status %d)", status);
+        return false;
+    }
+
+    if (crc32(0L, state, header.stateSize) != header.crc32) {
+        LOGE("State container checksum mismatch");
+        return false;
+    }
+    return true;
+}
+
+bool StateContainer::readFully(const Source& source, uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t count = source(data, size);
+        if (count <= 0) return false;
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+} //namespace libretrodroid
@@ -0,0 +1,74 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_STATECONTAINER_H
+#define LIBRETRODROID_STATECONTAINER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <sys/types.h>
+
+namespace libretrodroid {
+
+/**
+ * Compressed save-state format: a fixed 64 byte header (magic, version, codec, core id,
+ * uncompressed size, CRC32 of the raw state) followed by a single zlib stream. The stream is
+ * self-terminating, so containers can be written to pipes and sockets without seeking back.
+ * Both directions stream through caller supplied sinks and sources in fixed size chunks.
+ */
+class StateContainer {
+public:
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t CORE_ID_SIZE = 32;
+    // Larger states are rejected before anything is allocated for them; the size comes from the file.
+    static constexpr uint64_t MAX_STATE_SIZE = 256 * 1024 * 1024;
+
+    struct Header {
+        uint16_t version;
+        uint16_t codec;
+        std::string coreId;
+        uint64_t stateSize;
+        uint32_t crc32;
+    };
+
+    // Receives compressed output. Returns false to abort.
+    typedef std::function<bool(const uint8_t* data, size_t size)> Sink;
+    // Fills up to size bytes. Returns the number of bytes read, 0 at end of input, -1 on error.
+    typedef std::function<ssize_t(uint8_t* data, size_t size)> Source;
+
+    static size_t maxContainerSize(size_t stateSize);
+
+    static bool write(const uint8_t* state, size_t stateSize, const std::string& coreId, const Sink& sink);
+
+    static bool readHeader(const Source& source, Header& header);
+    static bool readState(const Source& source, const Header& header, uint8_t* state);
+
+private:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint16_t CODEC_ZLIB = 1;
+    static constexpr size_t CHUNK_SIZE = 256 * 1024;
+    static constexpr int COMPRESSION_LEVEL = 1;
+
+    static bool readFully(const Source& source, uint8_t* data, size_t size);
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_STATECONTAINER_H
@@ -0,0 +1,107 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ */
+
+#include "statecontainer_test.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "statecontainer.h"
+
+namespace libretrodroid::test {
+
+namespace {
+
+StateContainer::Sink vectorSink(std::vector<uint8_t>& output) {
+    return [&output](const uint8_t* data, size_t size) {
+        output.insert(output.end(), data, data + size);
+        return true;
+    };
+}
+
+// Hands out at most chunkSize bytes per call to exercise partial reads.
+StateContainer::Source vectorSource(const std::vector<uint8_t>& input, size_t& position, size_t chunkSize) {
+    return [&input, &position, chunkSize](uint8_t* data, size_t size) -> ssize_t {
+        size_t count = std::min({ size, chunkSize, input.size() - position });
+        std::copy_n(input.begin() + position, count, data);
+        position += count;
+        return static_cast<ssize_t>(count);
+    };
+}
+
+std::vector<uint8_t> makeState(size_t size) {
+    std::vector<uint8_t> state(size);
+    for (size_t i = 0; i < size; i++) {
+        state[i] = static_cast<uint8_t>((i % 251) ^ (i >> 12));
+    }
+    return state;
+}
+
+}
+
+int runStateContainerTests() {
+    int passed = 0;
+    std::vector<uint8_t> state = makeState(1024 * 1024 + 17);
+
+    std::vector<uint8_t> container;
+    if (StateContainer::write(state.data(), state.size(), "Test Core", vectorSink(container))
+        && container.size() < state.size()
+        && container.size() <= StateContainer::maxContainerSize(state.size())) {
+        ++passed;
+    }
+
+    size_t position = 0;
+    auto source = vectorSource(container, position, 4093);
+    StateContainer::Header header {};
+    std::vector<uint8_t> restored;
+    if (StateContainer::readHeader(source, header) && header.coreId == "Test Core" && header.stateSize == state.size()) {
+        restored.resize(header.stateSize);
+        if (StateContainer::readState(source, header, restored.data()) && restored == state) {
+            ++passed;
+        }
+    }
+
+    std::vector<uint8_t> corrupted = container;
+    corrupted[corrupted.size() / 2] ^= 0xFF;
+    position = 0;
+    source = vectorSource(corrupted, position, corrupted.size());
+    if (StateContainer::readHeader(source, header) && !StateContainer::readState(source, header, restored.data())) {
+        ++passed;
+    }
+
+    std::vector<uint8_t> truncated(container.begin(), container.begin() + container.size() / 2);
+    position = 0;
+    source = vectorSource(truncated, position, truncated.size());
+    if (StateContainer::readHeader(source, header) && !StateContainer::readState(source, header, restored.data())) {
+        ++passed;
+    }
+
+    std::vector<uint8_t> notContainer = makeState(StateContainer::HEADER_SIZE);
+    position = 0;
+    source = vectorSource(notContainer, position, notContainer.size());
+    if (!StateContainer::readHeader(source, header)) {
+        ++passed;
+    }
+
+    // A header claiming an absurd size is refused before anyone allocates for it.
+    std::vector<uint8_t> oversized = container;
+    uint64_t hugeSize = StateContainer::MAX_STATE_SIZE + 1; // The size field sits at offset 8.
+    memcpy(oversized.data() + 8, &hugeSize, sizeof(hugeSize));
+    position = 0;
+    source = vectorSource(oversized, position, oversized.size());
+    if (!StateContainer::readHeader(source, header)) {
+        ++passed;
+    }
+
+    return passed;
+}
+
+} // namespace libretrodroid::test
@@ -0,0 +1,159 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "statewriter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "log.h"
+
+namespace libretrodroid {
+
+StateWriter::~StateWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_one();
+    if (thread.joinable()) thread.join();
+}
+
+int StateWriter::write(int fd, size_t size, const Fill& fill) {
+    std::vector<uint8_t> buffer;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobFinished.wait(lock, [&]() { return buffersInUse < MAX_BUFFERS; });
+        if (!freeBuffers.empty()) {
+            buffer = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+        buffersInUse++;
+    }
+
+    // Only grows, so states of a steady size serialize without touching the allocator.
+    if (buffer.size() < size) buffer.resize(size);
+
+    int writeFd = -1;
+    bool filled = fill(buffer.data(), size);
+    if (filled) {
+        writeFd = dup(fd);
+        if (writeFd < 0) LOGE("Cannot write state: dup failed (%d)", errno);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (writeFd < 0) {
+        freeBuffers.push_back(std::move(buffer));
+        buffersInUse--;
+        lock.unlock();
+        jobFinished.notify_all();
+        return -1;
+    }
+
+    int ticket = nextTicket++;
+    jobs.push_back({ ticket, writeFd, std::move(buffer), size });
+    if (!thread.joinable()) {
+        thread = std::thread(&StateWriter::threadLoop, this);
+    }
+    lock.unlock();
+    jobAvailable.notify_one();
+    return ticket;
+}
+
+StateWriter::Status StateWriter::poll(int ticket) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto done = std::find_if(completed.begin(), completed.end(), [&](const auto& entry) {
+        return entry.first == ticket;
+    });
+    if (done != completed.end()) {
+        bool success = done->second;
+        completed.erase(done);
+        return success ? Status::DONE : Status::FAILED;
+    }
+
+    bool queued = std::any_of(jobs.begin(), jobs.end(), [&](const Job& job) { return job.ticket == ticket; });
+    return queued || ticket == writingTicket ? Status::PENDING : Status::FAILED;
+}
+
+void StateWriter::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [&]() { return jobs.empty() && writingTicket == 0; });
+}
+
+void StateWriter::releaseBuffers() {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.clear();
+}
+
+void StateWriter::threadLoop() {
+    pthread_setname_np(pthread_self(), "StateWriter");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        jobAvailable.wait(lock, [&]() { return stopping || !jobs.empty(); });
+        if (jobs.empty()) break;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        writingTicket = job.ticket;
+        lock.unlock();
+
+        bool success = writeFully(job.fd, job.buffer.data(), job.size);
+        // Pipes and sockets cannot be synced, and have nothing to sync either.
+        if (success && fsync(job.fd) != 0 && errno != EINVAL) {
+            LOGE("Cannot write state: fsync failed (%d)", errno);
+            success = false;
+        }
+        if (close(job.fd) != 0) success = false;
+
+        lock.lock();
+        addCompleted(job.ticket, success);
+        freeBuffers.push_back(std::move(job.buffer));
+        buffersInUse--;
+        writingTicket = 0;
+        jobFinished.notify_all();
+    }
+}
+
+bool StateWriter::writeFully(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t count = ::write(fd, data, size);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) {
+            LOGE("Cannot write state: write failed (%d)", errno);
+            return false;
+        }
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+void StateWriter::addCompleted(int ticket, bool success) {
+    completed.emplace_back(ticket, success);
+    if (completed.size() > MAX_COMPLETED) {
+        LOGW("Dropping unclaimed state write %d", completed.front().first);
+        completed.pop_front();
+    }
+}
+
+} //namespace libretrodroid
@@ -0,0 +1,101 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_STATEWRITER_H
+#define LIBRETRODROID_STATEWRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Writes save states to file descriptors off the emulation thread. The state is serialized
+ * straight into one of two reusable buffers on the caller's thread, then a worker writes and
+ * syncs it while emulation carries on. The caller only waits for a buffer when two writes are
+ * already in flight. Completion is polled by ticket, like frame captures.
+ */
+class StateWriter {
+public:
+    /** Fills the buffer with the state, returning false if the core could not serialize. */
+    typedef std::function<bool(uint8_t* data, size_t size)> Fill;
+
+    enum class Status {
+        PENDING,
+        DONE,
+        FAILED
+    };
+
+    StateWriter() = default;
+    ~StateWriter();
+
+    StateWriter(const StateWriter&) = delete;
+    StateWriter& operator=(const StateWriter&) = delete;
+
+    /**
+     * Serializes size bytes through fill and queues them for fd, which is duplicated so the
+     * caller may close its copy. Returns a ticket, or -1 if nothing was queued.
+     */
+    int write(int fd, size_t size, const Fill& fill);
+
+    /** DONE and FAILED are reported once, after which the ticket is forgotten. */
+    Status poll(int ticket);
+
+    /** Blocks until every queued write has finished. */
+    void waitIdle();
+
+    /** Frees the buffers no write is using, for when no state is due for a while. */
+    void releaseBuffers();
+
+private:
+    static constexpr size_t MAX_BUFFERS = 2;
+    static constexpr size_t MAX_COMPLETED = 8;
+
+    struct Job {
+        int ticket;
+        int fd;
+        std::vector<uint8_t> buffer;
+        size_t size;
+    };
+
+    void threadLoop();
+    static bool writeFully(int fd, const uint8_t* data, size_t size);
+    void addCompleted(int ticket, bool success);
+
+private:
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobFinished;
+    std::deque<Job> jobs;
+    std::vector<std::vector<uint8_t>> freeBuffers;
+    std::deque<std::pair<int, bool>> completed;
+    size_t buffersInUse = 0;
+    int nextTicket = 1;
+    int writingTicket = 0;
+    bool stopping = false;
+    std::thread thread;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_STATEWRITER_H
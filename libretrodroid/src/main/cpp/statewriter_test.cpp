@@ -0,0 +1,116 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ */
+
+#include "statewriter_test.h"
+#include "statewriter.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
+namespace libretrodroid::test {
+
+namespace {
+
+std::vector<uint8_t> makeState(size_t size, uint8_t seed) {
+    std::vector<uint8_t> state(size);
+    for (size_t i = 0; i < size; i++) state[i] = static_cast<uint8_t>(i * 13 + seed + (i >> 11));
+    return state;
+}
+
+StateWriter::Fill copyFrom(const std::vector<uint8_t>& state) {
+    return [&state](uint8_t* data, size_t size) {
+        memcpy(data, state.data(), size);
+        return true;
+    };
+}
+
+bool readBack(FILE* file, std::vector<uint8_t>& contents) {
+    contents.clear();
+    if (fseek(file, 0, SEEK_SET) != 0) return false;
+    uint8_t chunk[4096];
+    size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        contents.insert(contents.end(), chunk, chunk + count);
+    }
+    return true;
+}
+
+}
+
+int runStateWriterTests() {
+    int passed = 0;
+    StateWriter writer;
+
+    // The caller's descriptor may be closed as soon as write returns.
+    std::vector<uint8_t> state = makeState(3 * 1024 * 1024 + 17, 1);
+    FILE* file = tmpfile();
+    if (file != nullptr) {
+        int fd = dup(fileno(file));
+        int ticket = writer.write(fd, state.size(), copyFrom(state));
+        close(fd);
+        writer.waitIdle();
+
+        std::vector<uint8_t> contents;
+        if (ticket > 0 && writer.poll(ticket) == StateWriter::Status::DONE
+            && writer.poll(ticket) == StateWriter::Status::FAILED
+            && readBack(file, contents) && contents == state) {
+            ++passed;
+        }
+        fclose(file);
+    }
+
+    // More writes than buffers queue up in order, each with the state it was handed.
+    std::vector<std::vector<uint8_t>> states;
+    for (uint8_t seed = 0; seed < 5; seed++) states.push_back(makeState(256 * 1024, seed));
+    std::vector<FILE*> files;
+    std::vector<int> tickets;
+    for (const auto& queued : states) {
+        FILE* target = tmpfile();
+        if (target == nullptr) break;
+        files.push_back(target);
+        tickets.push_back(writer.write(fileno(target), queued.size(), copyFrom(queued)));
+    }
+    writer.waitIdle();
+    bool allWritten = files.size() == states.size();
+    for (size_t i = 0; i < files.size(); i++) {
+        std::vector<uint8_t> contents;
+        allWritten = allWritten && writer.poll(tickets[i]) == StateWriter::Status::DONE
+            && readBack(files[i], contents) && contents == states[i];
+        fclose(files[i]);
+    }
+    if (allWritten) {
+        ++passed;
+    }
+
+    // A core that fails to serialize queues nothing.
+    int refused = writer.write(STDOUT_FILENO, 1024, [](uint8_t*, size_t) { return false; });
+    if (refused == -1) {
+        ++passed;
+    }
+
+    // A descriptor that cannot be written reports failure rather than hanging.
+    int pipeFds[2];
+    if (pipe(pipeFds) == 0) {
+        close(pipeFds[1]);
+        int ticket = writer.write(pipeFds[0], state.size(), copyFrom(state));
+        writer.waitIdle();
+        if (ticket > 0 && writer.poll(ticket) == StateWriter::Status::FAILED) {
+            ++passed;
+        }
+        close(pipeFds[0]);
+    }
+
+    return passed;
+}
+
+} // namespace libretrodroid::test
@@ -0,0 +1,12 @@
+#ifndef LIBRETRODROID_ANDROID_INPUT_HOST_H
+#define LIBRETRODROID_ANDROID_INPUT_HOST_H
+
+// The subset of the NDK's android/input.h needed to build input.cpp on the host.
+
+enum {
+    AKEY_EVENT_ACTION_DOWN = 0,
+    AKEY_EVENT_ACTION_UP = 1,
+    AKEY_EVENT_ACTION_MULTIPLE = 2
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef LIBRETRODROID_ANDROID_KEYCODES_HOST_H
+#define LIBRETRODROID_ANDROID_KEYCODES_HOST_H
+
+// The subset of the NDK's android/keycodes.h needed to build input.cpp on the host.
+
+enum {
+    AKEYCODE_DPAD_UP = 19,
+    AKEYCODE_DPAD_DOWN = 20,
+    AKEYCODE_DPAD_LEFT = 21,
+    AKEYCODE_DPAD_RIGHT = 22,
+    AKEYCODE_BUTTON_A = 96,
+    AKEYCODE_BUTTON_B = 97,
+    AKEYCODE_BUTTON_X = 99,
+    AKEYCODE_BUTTON_Y = 100,
+    AKEYCODE_BUTTON_L1 = 102,
+    AKEYCODE_BUTTON_R1 = 103,
+    AKEYCODE_BUTTON_L2 = 104,
+    AKEYCODE_BUTTON_R2 = 105,
+    AKEYCODE_BUTTON_THUMBL = 106,
+    AKEYCODE_BUTTON_THUMBR = 107,
+    AKEYCODE_BUTTON_START = 108,
+    AKEYCODE_BUTTON_SELECT = 109,
+    AKEYCODE_DPAD_UP_LEFT = 268,
+    AKEYCODE_DPAD_DOWN_LEFT = 269,
+    AKEYCODE_DPAD_UP_RIGHT = 270,
+    AKEYCODE_DPAD_DOWN_RIGHT = 271
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef LIBRETRODROID_ANDROID_LOG_HOST_H
+#define LIBRETRODROID_ANDROID_LOG_HOST_H
+
+// Host replacement for the NDK's android/log.h, so modules that include log.h build unchanged.
+
+#include <cstdarg>
+#include <cstdio>
+
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+} android_LogPriority;
+
+inline int __android_log_vprint(int prio, const char* tag, const char* fmt, va_list ap) {
+    static const char* const LEVELS = "??VDIWEFS";
+    fprintf(stderr, "%c/%s: ", LEVELS[prio < 0 || prio > ANDROID_LOG_SILENT ? 0 : prio], tag);
+    int written = vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    return written;
+}
+
+inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int written = __android_log_vprint(prio, tag, fmt, ap);
+    va_end(ap);
+    return written;
+}
+
+#endif
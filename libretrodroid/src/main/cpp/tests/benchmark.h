@@ -0,0 +1,129 @@
+#ifndef LIBRETRODROID_BENCHMARK_H
+#define LIBRETRODROID_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace libretrodroid {
+namespace bench {
+
+/** Keeps the compiler from discarding a value the benchmark only computes. */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double meanNs = 0;
+    double medianNs = 0;
+    double minNs = 0;
+    double stddevNs = 0;
+    double bytesPerSecond = 0;
+};
+
+/**
+ * Small in-tree harness. Each benchmark first calibrates how many iterations fill minTime, then
+ * runs that many in every repetition. Results are reported per operation; when a benchmark
+ * declares how many bytes one operation touches, throughput is reported as well.
+ */
+class Harness {
+public:
+    typedef std::function<void()> Operation;
+
+    double minTimeSeconds = 0.2;
+    int repetitions = 5;
+    std::string filter;
+
+    void run(const std::string& name, uint64_t bytesPerOp, const Operation& operation) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+        uint64_t iterations = calibrate(operation);
+        std::vector<double> samples;
+        for (int i = 0; i < repetitions; i++) {
+            samples.push_back(timeIterations(operation, iterations) / iterations);
+        }
+
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        summarize(samples, result);
+        if (bytesPerOp > 0) {
+            result.bytesPerSecond = bytesPerOp * 1e9 / result.medianNs;
+        }
+
+        fprintf(stderr, "%-48s %12.1f ns/op %10llu it\n",
+            name.c_str(), result.medianNs, (unsigned long long) iterations);
+        results.push_back(result);
+    }
+
+    void writeJson(FILE* out, const std::string& context) const {
+        fprintf(out, "{\n  \"context\": %s,\n  \"benchmarks\": [\n", context.c_str());
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            fprintf(out,
+                "    {\"name\": \"%s\", \"iterations\": %llu, \"repetitions\": %d, "
+                "\"time_unit\": \"ns\", \"mean\": %.3f, \"median\": %.3f, \"min\": %.3f, "
+                "\"stddev\": %.3f, \"bytes_per_second\": %.0f}%s\n",
+                r.name.c_str(), (unsigned long long) r.iterations, repetitions,
+                r.meanNs, r.medianNs, r.minNs, r.stddevNs, r.bytesPerSecond,
+                i + 1 < results.size() ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+
+private:
+    static double timeIterations(const Operation& operation, uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            operation();
+        }
+        clobberMemory();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    uint64_t calibrate(const Operation& operation) const {
+        const double targetNs = minTimeSeconds * 1e9;
+        uint64_t iterations = 1;
+        while (true) {
+            double elapsed = timeIterations(operation, iterations);
+            if (elapsed >= targetNs || iterations >= (1ull << 40)) break;
+            double scale = elapsed > 0 ? targetNs / elapsed * 1.2 : 10.0;
+            iterations = std::max<uint64_t>(iterations + 1, iterations * std::min(scale, 10.0));
+        }
+        return iterations;
+    }
+
+    static void summarize(std::vector<double> samples, Result& result) {
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double s : samples) sum += s;
+        result.meanNs = sum / samples.size();
+        result.minNs = samples.front();
+        size_t mid = samples.size() / 2;
+        result.medianNs = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2;
+
+        double variance = 0;
+        for (double s : samples) variance += (s - result.meanNs) * (s - result.meanNs);
+        result.stddevNs = samples.size() > 1 ? std::sqrt(variance / (samples.size() - 1)) : 0;
+    }
+
+    std::vector<Result> results;
+};
+
+} //namespace bench
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_BENCHMARK_H
@@ -0,0 +1,324 @@
+#include "benchmark.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "environment.h"
+#include "input.h"
+#include "pixelconversion.h"
+#include "rewindbuffer.h"
+#include "stateloadpolicy.h"
+#include "resamplers/linearresampler.h"
+#include "resamplers/sincresampler.h"
+#include "libretro/libretro-common/include/libretro.h"
+
+#ifdef HAVE_RCHEEVOS
+#include <rc_consoles.h>
+#include <rc_libretro.h>
+#endif
+
+using namespace libretrodroid;
+using libretrodroid::bench::Harness;
+using libretrodroid::bench::doNotOptimize;
+
+namespace {
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+    std::vector<uint8_t> data(size);
+    std::mt19937 rng(seed);
+    for (auto& b : data) b = static_cast<uint8_t>(rng());
+    return data;
+}
+
+std::string sizeLabel(size_t bytes) {
+    if (bytes >= 1024 * 1024) return std::to_string(bytes / (1024 * 1024)) + "MiB";
+    return std::to_string(bytes / 1024) + "KiB";
+}
+
+// Serialized state sizes of typical cores: 8/16-bit consoles, PS1 and N64.
+const size_t STATE_SIZES[] = { 64 * 1024, 512 * 1024, 2 * 1024 * 1024, 16 * 1024 * 1024 };
+const size_t REWIND_SLOTS = 60;
+const size_t REWIND_BUDGET = 256 * 1024 * 1024;
+
+void benchRewind(Harness& harness) {
+    for (size_t stateSize : STATE_SIZES) {
+        auto state = randomBytes(stateSize, 1);
+        std::vector<uint8_t> restored(stateSize);
+        size_t slots = std::min(REWIND_SLOTS, REWIND_BUDGET / stateSize);
+        RewindBuffer buffer(slots, stateSize);
+
+        harness.run("rewind/push/" + sizeLabel(stateSize), stateSize, [&]() {
+            buffer.push(state.data(), state.size());
+        });
+
+        // One rewind step: the frontend pops the previous state, then records the rewound one.
+        for (size_t i = 0; i < slots; i++) buffer.push(state.data(), state.size());
+        harness.run("rewind/pop_push/" + sizeLabel(stateSize), stateSize * 2, [&]() {
+            size_t size = 0;
+            buffer.pop(restored.data(), &size);
+            buffer.push(restored.data(), size);
+        });
+    }
+}
+
+void benchResamplers(Harness& harness) {
+    // One 60 Hz frame of core audio resampled to the output stream rate.
+    const int32_t inputFrames = 32040 / 60;
+    const int32_t outputFrames = 48000 / 60;
+    auto source = randomBytes(inputFrames * 2 * sizeof(int16_t), 2);
+    std::vector<int16_t> sink(outputFrames * 2);
+    auto input = reinterpret_cast<const int16_t*>(source.data());
+
+    LinearResampler linear;
+    harness.run("resampler/linear/534to800", 0, [&]() {
+        linear.resample(input, inputFrames, sink.data(), outputFrames);
+        doNotOptimize(sink[0]);
+    });
+
+    for (int taps : { 8, 32 }) {
+        SincResampler sinc(taps);
+        harness.run("resampler/sinc" + std::to_string(taps) + "/534to800", 0, [&]() {
+            sinc.resample(input, inputFrames, sink.data(), outputFrames);
+            doNotOptimize(sink[0]);
+        });
+    }
+}
+
+void benchPixelConversion(Harness& harness) {
+    struct Resolution { unsigned width; unsigned height; };
+    const Resolution resolutions[] = { { 320, 240 }, { 640, 480 } };
+
+    struct Format { int format; const char* name; };
+    const Format formats[] = {
+        { RETRO_PIXEL_FORMAT_XRGB8888, "xrgb8888" },
+        { RETRO_PIXEL_FORMAT_RGB565, "rgb565" },
+        { RETRO_PIXEL_FORMAT_0RGB1555, "0rgb1555" },
+    };
+
+    for (const auto& res : resolutions) {
+        std::string size = std::to_string(res.width) + "x" + std::to_string(res.height);
+        auto source = randomBytes(res.width * res.height * 4, 3);
+        std::vector<uint8_t> destination(res.width * res.height * 4);
+
+        for (const auto& fmt : formats) {
+            size_t sourcePitch = res.width * PixelConversion::bytesPerPixel(fmt.format);
+            size_t frameBytes = sourcePitch * res.height;
+
+            harness.run("pixels/" + std::string(fmt.name) + "_to_rgba8888/" + size, frameBytes, [&]() {
+                PixelConversion::toRGBA8888(
+                    fmt.format, source.data(), sourcePitch,
+                    destination.data(), res.width * 4, res.width, res.height);
+                doNotOptimize(destination[0]);
+            });
+
+            if (fmt.format == RETRO_PIXEL_FORMAT_RGB565) continue;
+            harness.run("pixels/" + std::string(fmt.name) + "_to_rgb565/" + size, frameBytes, [&]() {
+                PixelConversion::toRGB565(
+                    fmt.format, source.data(), sourcePitch,
+                    destination.data(), res.width * 2, res.width, res.height);
+                doNotOptimize(destination[0]);
+            });
+        }
+    }
+}
+
+void benchInput(Harness& harness) {
+    Input input;
+    input.setInputPortState(0, (1u << RETRO_DEVICE_ID_JOYPAD_A) | (1u << RETRO_DEVICE_ID_JOYPAD_RIGHT));
+    input.onMotionEvent(0, Input::MOTION_SOURCE_ANALOG_LEFT, 0.5f, -0.25f);
+
+    // Cores that poll every button individually, as most do, ask 16 times per port per frame.
+    harness.run("input/joypad_buttons", 0, [&]() {
+        int16_t state = 0;
+        for (unsigned id = 0; id <= RETRO_DEVICE_ID_JOYPAD_R3; id++) {
+            state |= input.getInputState(0, RETRO_DEVICE_JOYPAD, 0, id);
+        }
+        doNotOptimize(state);
+    });
+
+    harness.run("input/joypad_mask", 0, [&]() {
+        doNotOptimize(input.getInputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_MASK));
+    });
+
+    harness.run("input/analog", 0, [&]() {
+        doNotOptimize(input.getInputState(
+            0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_X));
+    });
+}
+
+// Many cores look their options up every frame, so this is on the per-frame path.
+void benchEnvironment(Harness& harness) {
+    static const char* const KEYS[] = {
+        "bench_renderer", "bench_resolution", "bench_frameskip", "bench_audio_quality",
+        "bench_region", "bench_dithering", "bench_overclock", "bench_widescreen",
+    };
+    std::vector<retro_variable> variables;
+    for (const char* key : KEYS) variables.push_back({ key, "Option; first|second|third" });
+    variables.push_back({ nullptr, nullptr });
+
+    Environment environment;
+    environment.handle_callback_environment(RETRO_ENVIRONMENT_SET_VARIABLES, variables.data());
+
+    harness.run("environment/get_variable", 0, [&]() {
+        retro_variable variable = { "bench_frameskip", nullptr };
+        environment.handle_callback_environment(RETRO_ENVIRONMENT_GET_VARIABLE, &variable);
+        doNotOptimize(variable.value);
+    });
+
+    // A key built in a buffer rather than a literal, which the address cache has to verify.
+    char key[32];
+    strcpy(key, "bench_widescreen");
+    harness.run("environment/get_variable_buffer_key", 0, [&]() {
+        retro_variable variable = { key, nullptr };
+        environment.handle_callback_environment(RETRO_ENVIRONMENT_GET_VARIABLE, &variable);
+        doNotOptimize(variable.value);
+    });
+
+    harness.run("environment/get_variable_update", 0, [&]() {
+        bool updated = false;
+        environment.handle_callback_environment(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated);
+        doNotOptimize(updated);
+    });
+}
+
+void benchStateLoad(Harness& harness) {
+    for (size_t stateSize : STATE_SIZES) {
+        auto state = randomBytes(stateSize, 4);
+        std::vector<uint8_t> coreState(stateSize);
+        StateUnserializer unserialize = [&](const void* data, size_t size) {
+            memcpy(coreState.data(), data, size);
+            return true;
+        };
+
+        harness.run("state_load/strict/" + sizeLabel(stateSize), stateSize, [&]() {
+            doNotOptimize(attemptStateLoad(
+                state.data(), stateSize, stateSize, StateLoadPolicy::StrictSize, unserialize));
+        });
+    }
+
+    // Rejections should cost nothing next to a load.
+    auto state = randomBytes(1024, 5);
+    StateUnserializer unserialize = [](const void*, size_t) { return true; };
+    harness.run("state_load/strict_size_mismatch", 0, [&]() {
+        doNotOptimize(attemptStateLoad(
+            state.data(), state.size(), state.size() + 1, StateLoadPolicy::StrictSize, unserialize));
+    });
+}
+
+#ifdef HAVE_RCHEEVOS
+std::vector<uint8_t> achievementRam;
+
+void getBenchMemoryInfo(uint32_t id, rc_libretro_core_memory_info_t* info) {
+    bool systemRam = id == RETRO_MEMORY_SYSTEM_RAM;
+    info->data = systemRam ? achievementRam.data() : nullptr;
+    info->size = systemRam ? achievementRam.size() : 0;
+}
+
+// Same read Achievements::peekMemory performs once memory regions are initialized. The method
+// itself reaches the frontend singleton, which does not exist in a host build.
+void benchAchievementPeek(Harness& harness) {
+    achievementRam = randomBytes(128 * 1024, 6);
+
+    rc_libretro_memory_regions_t regions = {};
+    if (rc_libretro_memory_init(&regions, nullptr, getBenchMemoryInfo, RC_CONSOLE_SUPER_NINTENDO) != 1) {
+        fprintf(stderr, "Skipping achievement benchmarks: memory regions unavailable\n");
+        return;
+    }
+
+    // A typical set evaluates a few hundred memrefs per frame.
+    std::vector<uint32_t> addresses(256);
+    std::mt19937 rng(7);
+    for (auto& a : addresses) a = rng() % (achievementRam.size() - 4);
+
+    for (uint32_t numBytes : { 1u, 2u, 4u }) {
+        harness.run("achievements/peek" + std::to_string(numBytes) + "x256", 0, [&]() {
+            uint32_t sum = 0;
+            for (uint32_t address : addresses) {
+                uint8_t buffer[4] = {0};
+                uint32_t read = rc_libretro_memory_read(&regions, address, buffer, numBytes);
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < read; i++) {
+                    value |= static_cast<uint32_t>(buffer[i]) << (i * 8);
+                }
+                sum += value;
+            }
+            doNotOptimize(sum);
+        });
+    }
+
+    rc_libretro_memory_destroy(&regions);
+}
+#endif
+
+std::string context() {
+    std::string arch =
+#if defined(__aarch64__)
+        "arm64";
+#elif defined(__arm__)
+        "arm";
+#elif defined(__x86_64__)
+        "x86_64";
+#else
+        "unknown";
+#endif
+    std::string buildType =
+#ifdef NDEBUG
+        "release";
+#else
+        "debug";
+#endif
+    return "{\"arch\": \"" + arch + "\", \"build_type\": \"" + buildType +
+        "\", \"compiler\": \"" + __VERSION__ + "\"}";
+}
+
+void usage(const char* program) {
+    fprintf(stderr,
+        "usage: %s [--filter=SUBSTRING] [--min-time=SECONDS] [--repetitions=N] [--out=FILE]\n",
+        program);
+}
+
+}
+
+int main(int argc, char** argv) {
+    Harness harness;
+    std::string outPath;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strncmp(arg, "--filter=", 9) == 0) {
+            harness.filter = arg + 9;
+        } else if (strncmp(arg, "--min-time=", 11) == 0) {
+            harness.minTimeSeconds = atof(arg + 11);
+        } else if (strncmp(arg, "--repetitions=", 14) == 0) {
+            harness.repetitions = std::max(1, atoi(arg + 14));
+        } else if (strncmp(arg, "--out=", 6) == 0) {
+            outPath = arg + 6;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    benchRewind(harness);
+    benchResamplers(harness);
+    benchPixelConversion(harness);
+    benchInput(harness);
+    benchEnvironment(harness);
+    benchStateLoad(harness);
+#ifdef HAVE_RCHEEVOS
+    benchAchievementPeek(harness);
+#endif
+
+    FILE* out = outPath.empty() ? stdout : fopen(outPath.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "Unable to open %s\n", outPath.c_str());
+        return EXIT_FAILURE;
+    }
+    harness.writeJson(out, context());
+    if (out != stdout) fclose(out);
+    return EXIT_SUCCESS;
+}
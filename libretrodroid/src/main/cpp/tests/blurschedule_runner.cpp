@@ -0,0 +1,10 @@
+#include "blurschedule_test.h"
+#include <cstdio>
+#include <cstdlib>
+
+int main() {
+    const int expected = 3;
+    int passed = libretrodroid::test::runBlurScheduleTests();
+    printf("blur schedule: %d/%d passed\n", passed, expected);
+    return (passed == expected) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
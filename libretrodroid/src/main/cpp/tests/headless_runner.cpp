@@ -0,0 +1,383 @@
+// Headless frontend: drives a core through Core, Environment, Input, RewindBuffer and (when
+// rcheevos is checked out) Achievements with the real libretro callbacks, but null audio and video
+// sinks and no EGL or Oboe. Input comes from a recorded list of per-frame port bitmasks or from a
+// seeded generator, so a run is reproducible and its final state checksum can be asserted in CI.
+// Timings and peak memory are printed as JSON.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <zlib.h>
+
+#include "core.h"
+#include "environment.h"
+#include "input.h"
+#include "rewindbuffer.h"
+
+#ifdef HAVE_RCHEEVOS
+#include <rc_consoles.h>
+#include "achievements.h"
+#endif
+
+using namespace libretrodroid;
+
+namespace {
+
+const unsigned PORTS = 4;
+
+struct Options {
+    std::string corePath = STUB_CORE_PATH;
+    unsigned frames = 3600;
+    std::string inputPath;
+    std::string dumpInputPath;
+    uint32_t seed = 1;
+    unsigned rewindInterval = 1;
+    unsigned rewindSlots = 600;
+    unsigned rewindBurstEvery = 0;
+    unsigned rewindBurstLength = 60;
+    unsigned fastForward = 1;
+    bool achievements = true;
+    std::string expectCrc;
+    std::vector<std::pair<std::string, std::string>> variables;
+};
+
+typedef std::array<uint16_t, PORTS> FrameInput;
+
+struct Counters {
+    uint64_t videoFrames = 0;
+    uint64_t videoBytes = 0;
+    uint64_t audioFrames = 0;
+};
+
+std::unique_ptr<Input> input;
+Counters counters;
+
+void videoSink(const void* data, unsigned, unsigned height, size_t pitch) {
+    if (data == nullptr) return;
+    counters.videoFrames++;
+    counters.videoBytes += pitch * height;
+}
+
+void audioSampleSink(int16_t, int16_t) {
+    counters.audioFrames++;
+}
+
+size_t audioBatchSink(const int16_t*, size_t frames) {
+    counters.audioFrames += frames;
+    return frames;
+}
+
+void inputPoll() { }
+
+int16_t inputState(unsigned port, unsigned device, unsigned index, unsigned id) {
+    return input->getInputState(port, device, index, id);
+}
+
+// One line per frame with up to four hexadecimal port bitmasks. The last line repeats once the
+// recording runs out. Lines starting with # are comments.
+std::vector<FrameInput> readRecording(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) throw std::runtime_error("Cannot open input recording " + path);
+
+    std::vector<FrameInput> recording;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        FrameInput frame = {};
+        char* cursor = line;
+        for (unsigned port = 0; port < PORTS; port++) {
+            char* end = nullptr;
+            unsigned long value = strtoul(cursor, &end, 16);
+            if (end == cursor) break;
+            frame[port] = static_cast<uint16_t>(value);
+            cursor = end;
+        }
+        recording.push_back(frame);
+    }
+    fclose(file);
+    return recording;
+}
+
+// Holds a random button combination on port 0 for a random number of frames, like a player would.
+std::vector<FrameInput> generateRecording(unsigned frames, uint32_t seed) {
+    std::vector<FrameInput> recording(frames);
+    uint64_t rng = seed;
+    FrameInput current = {};
+    unsigned holdFor = 0;
+    for (auto& frame : recording) {
+        if (holdFor == 0) {
+            rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+            current[0] = static_cast<uint16_t>(rng >> 48) & 0x0fff;
+            holdFor = 1 + static_cast<unsigned>((rng >> 20) % 45);
+        }
+        frame = current;
+        holdFor--;
+    }
+    return recording;
+}
+
+void writeRecording(const std::string& path, const std::vector<FrameInput>& recording) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) throw std::runtime_error("Cannot write input recording " + path);
+    fprintf(file, "# port0 port1 port2 port3\n");
+    for (const auto& frame : recording) {
+        fprintf(file, "%04x %04x %04x %04x\n", frame[0], frame[1], frame[2], frame[3]);
+    }
+    fclose(file);
+}
+
+struct Stats {
+    double mean = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+Stats summarize(std::vector<double> samples) {
+    Stats stats;
+    if (samples.empty()) return stats;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) sum += s;
+    auto at = [&](double fraction) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+    };
+    stats.mean = sum / samples.size();
+    stats.p50 = at(0.50);
+    stats.p95 = at(0.95);
+    stats.p99 = at(0.99);
+    stats.max = samples.back();
+    return stats;
+}
+
+void printStats(const char* name, const Stats& stats, bool last = false) {
+    printf("  \"%s\": {\"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f}%s\n",
+        name, stats.mean, stats.p50, stats.p95, stats.p99, stats.max, last ? "" : ",");
+}
+
+double microsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void usage(const char* program) {
+    fprintf(stderr,
+        "usage: %s [--core=PATH] [--frames=N] [--input=FILE | --seed=N] [--dump-input=FILE]\n"
+        "          [--rewind-interval=N] [--rewind-slots=N] [--rewind-burst-every=N]\n"
+        "          [--rewind-burst-length=N] [--fast-forward=N] [--no-achievements] [--expect-crc=HEX]\n"
+        "          [--option=KEY=VALUE]...\n",
+        program);
+}
+
+bool parseArguments(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t length = strlen(prefix);
+            return arg.compare(0, length, prefix) == 0 ? argv[i] + length : nullptr;
+        };
+
+        if (const char* v = value("--core=")) options.corePath = v;
+        else if (const char* v = value("--frames=")) options.frames = strtoul(v, nullptr, 10);
+        else if (const char* v = value("--input=")) options.inputPath = v;
+        else if (const char* v = value("--dump-input=")) options.dumpInputPath = v;
+        else if (const char* v = value("--seed=")) options.seed = strtoul(v, nullptr, 10);
+        else if (const char* v = value("--rewind-interval=")) options.rewindInterval = strtoul(v, nullptr, 10);
+        else if (const char* v = value("--rewind-slots=")) options.rewindSlots = strtoul(v, nullptr, 10);
+        else if (const char* v = value("--rewind-burst-every=")) options.rewindBurstEvery = strtoul(v, nullptr, 10);
+        else if (const char* v = value("--rewind-burst-length=")) options.rewindBurstLength = strtoul(v, nullptr, 10);
+        else if (const char* v = value("--fast-forward=")) options.fastForward = strtoul(v, nullptr, 10);
+        else if (const char* v = value("--expect-crc=")) options.expectCrc = v;
+        else if (arg == "--no-achievements") options.achievements = false;
+        else if (const char* v = value("--option=")) {
+            std::string option = v;
+            size_t separator = option.find('=');
+            if (separator == std::string::npos) return false;
+            options.variables.emplace_back(option.substr(0, separator), option.substr(separator + 1));
+        } else {
+            return false;
+        }
+    }
+    return options.rewindSlots > 0 && options.fastForward > 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        auto recording = options.inputPath.empty()
+            ? generateRecording(options.frames, options.seed)
+            : readRecording(options.inputPath);
+        if (recording.empty()) recording.emplace_back();
+        if (!options.dumpInputPath.empty()) writeRecording(options.dumpInputPath, recording);
+
+        // A session of its own, the way a preview or verification run sits next to the game.
+        Environment environment;
+        Environment::bindToCurrentThread(&environment);
+        environment.initialize(".", ".", nullptr);
+        environment.setEnableVirtualFileSystem(false);
+        environment.setEnableMicrophone(false);
+        for (const auto& variable : options.variables) {
+            environment.updateVariable(variable.first, variable.second);
+        }
+
+        auto core = std::make_unique<Core>(options.corePath);
+        input = std::make_unique<Input>();
+
+        core->retro_set_environment(&Environment::callback_environment);
+        core->retro_init();
+        core->retro_set_video_refresh(&videoSink);
+        core->retro_set_audio_sample(&audioSampleSink);
+        core->retro_set_audio_sample_batch(&audioBatchSink);
+        core->retro_set_input_poll(&inputPoll);
+        core->retro_set_input_state(&inputState);
+
+        if (!core->retro_load_game(nullptr)) {
+            throw std::runtime_error("Core refused to start without content");
+        }
+
+        size_t stateSize = core->retro_serialize_size();
+        std::vector<uint8_t> state(stateSize);
+        std::unique_ptr<RewindBuffer> rewindBuffer;
+        if (options.rewindInterval > 0) {
+            rewindBuffer = std::make_unique<RewindBuffer>(options.rewindSlots, stateSize);
+        }
+
+#ifdef HAVE_RCHEEVOS
+        // The stub core keeps port 0 buttons at 0x0000 and the frame counter at 0x0002. Its memory
+        // map has no real console addresses, so regions come from the SYSTEM_RAM fallback.
+        Achievements achievements;
+        std::vector<uint32_t> unlocked;
+        if (options.achievements) {
+            achievements.setCore(core.get());
+            achievements.init({ { 1, "0xH0000=1" }, { 2, "0xX0002>=1800" } });
+            achievements.initMemory(RC_CONSOLE_SUPER_NINTENDO, nullptr);
+        }
+#endif
+
+        // A headless run is never paced, so report fast-forward at its nominal rate.
+        struct retro_system_av_info avInfo {};
+        core->retro_get_system_av_info(&avInfo);
+        environment.setThrottleState({
+            options.fastForward > 1 ? unsigned(RETRO_THROTTLE_FAST_FORWARD) : unsigned(RETRO_THROTTLE_NONE),
+            static_cast<float>(avInfo.timing.fps * options.fastForward)
+        });
+
+        std::vector<double> runTimes;
+        std::vector<double> rewindTimes;
+        std::vector<double> achievementTimes;
+        runTimes.reserve(options.frames);
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned frame = 0; frame < options.frames; frame++) {
+            const FrameInput& frameInput = recording[std::min<size_t>(frame, recording.size() - 1)];
+            for (unsigned port = 0; port < PORTS; port++) {
+                input->setInputPortState(port, frameInput[port]);
+            }
+
+            // Like the frontend at N times speed, only every Nth frame asks the core for video.
+            bool shown = (frame + 1) % options.fastForward == 0;
+            environment.setAudioVideoEnable(shown
+                ? Environment::AV_ENABLE_VIDEO | Environment::AV_ENABLE_AUDIO
+                : Environment::AV_ENABLE_AUDIO);
+
+            const auto& frameTime = environment.getFrameTimeCallback();
+            if (frameTime.callback) frameTime.callback(frameTime.reference);
+
+            auto runStart = std::chrono::steady_clock::now();
+            core->retro_run();
+            runTimes.push_back(microsSince(runStart));
+
+#ifdef HAVE_RCHEEVOS
+            if (achievements.isActive()) {
+                auto achievementStart = std::chrono::steady_clock::now();
+                achievements.evaluateFrame();
+                achievementTimes.push_back(microsSince(achievementStart));
+                achievements.handleUnlocks([&](uint32_t id) { unlocked.push_back(id); });
+            }
+#endif
+
+            if (rewindBuffer && frame % options.rewindInterval == 0) {
+                auto rewindStart = std::chrono::steady_clock::now();
+                if (core->retro_serialize(state.data(), stateSize)) {
+                    rewindBuffer->push(state.data(), stateSize);
+                }
+                rewindTimes.push_back(microsSince(rewindStart));
+            }
+
+            // Rewinding drops the most recent states and resumes from the oldest one popped.
+            if (rewindBuffer && options.rewindBurstEvery > 0 && frame > 0 && frame % options.rewindBurstEvery == 0) {
+                size_t size = 0;
+                bool popped = false;
+                for (unsigned i = 0; i < options.rewindBurstLength && rewindBuffer->pop(state.data(), &size); i++) {
+                    popped = true;
+                }
+                if (popped && !core->retro_unserialize(state.data(), size)) {
+                    throw std::runtime_error("Core rejected a rewind state");
+                }
+            }
+        }
+
+        double totalMs = microsSince(start) / 1000.0;
+
+        core->retro_serialize(state.data(), stateSize);
+        char crc[9];
+        snprintf(crc, sizeof(crc), "%08lx", crc32(0L, state.data(), stateSize));
+
+        struct rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+
+        printf("{\n");
+        printf("  \"core\": \"%s\",\n", options.corePath.c_str());
+        printf("  \"frames\": %u,\n", options.frames);
+        printf("  \"total_ms\": %.3f,\n", totalMs);
+        printf("  \"state_size\": %zu,\n", stateSize);
+        printf("  \"state_crc32\": \"%s\",\n", crc);
+        printf("  \"video_frames\": %llu,\n", (unsigned long long) counters.videoFrames);
+        printf("  \"video_bytes\": %llu,\n", (unsigned long long) counters.videoBytes);
+        printf("  \"audio_frames\": %llu,\n", (unsigned long long) counters.audioFrames);
+        printf("  \"peak_rss_kb\": %ld,\n", usage.ru_maxrss);
+#ifdef HAVE_RCHEEVOS
+        printf("  \"achievements_unlocked\": %zu,\n", unlocked.size());
+        printStats("achievements_us", summarize(achievementTimes));
+#endif
+        printStats("rewind_push_us", summarize(rewindTimes));
+        printStats("run_us", summarize(runTimes), true);
+        printf("}\n");
+
+#ifdef HAVE_RCHEEVOS
+        achievements.clear();
+        achievements.setCore(nullptr);
+#endif
+        core->retro_unload_game();
+        core->retro_deinit();
+        core.reset();
+        environment.deinitialize();
+        Environment::bindToCurrentThread(nullptr);
+
+        if (!options.expectCrc.empty() && options.expectCrc != crc) {
+            fprintf(stderr, "State checksum %s does not match expected %s\n", crc, options.expectCrc.c_str());
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Headless run failed: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
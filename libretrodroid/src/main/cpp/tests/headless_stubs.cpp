@@ -0,0 +1,23 @@
+// Link-time stand-ins for the Android-only pieces Environment refers to. The headless driver keeps
+// the virtual file system, microphone and hardware rendering disabled, so none of these are reached.
+
+#include <EGL/egl.h>
+
+#include "vfs/vfs.h"
+#include "microphone/microphoneinterface.h"
+
+namespace libretrodroid {
+
+retro_vfs_interface* VFS::getInterface() {
+    return nullptr;
+}
+
+retro_microphone_interface* MicrophoneInterface::getInterface() {
+    return nullptr;
+}
+
+} //namespace libretrodroid
+
+extern "C" __eglMustCastToProperFunctionPointerType eglGetProcAddress(const char*) {
+    return nullptr;
+}
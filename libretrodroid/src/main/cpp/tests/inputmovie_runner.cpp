@@ -0,0 +1,10 @@
+#include "inputmovie_test.h"
+#include <cstdio>
+#include <cstdlib>
+
+int main() {
+    const int expected = 6;
+    int passed = libretrodroid::test::runInputMovieTests();
+    printf("input movie: %d/%d passed\n", passed, expected);
+    return (passed == expected) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,10 @@
+#include "memorysearch_test.h"
+#include <cstdio>
+#include <cstdlib>
+
+int main() {
+    const int expected = 4;
+    int passed = libretrodroid::test::runMemorySearchTests();
+    printf("memory search: %d/%d passed\n", passed, expected);
+    return (passed == expected) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
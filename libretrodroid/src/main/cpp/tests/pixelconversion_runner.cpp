@@ -0,0 +1,10 @@
+#include "pixelconversion_test.h"
+#include <cstdio>
+#include <cstdlib>
+
+int main() {
+    const int expected = 7;
+    int passed = libretrodroid::test::runPixelConversionTests();
+    printf("pixel conversion: %d/%d passed\n", passed, expected);
+    return (passed == expected) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,10 @@
+#include "sramtracker_test.h"
+#include <cstdio>
+#include <cstdlib>
+
+int main() {
+    const int expected = 4;
+    int passed = libretrodroid::test::runSramTrackerTests();
+    printf("sram tracker: %d/%d passed\n", passed, expected);
+    return (passed == expected) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
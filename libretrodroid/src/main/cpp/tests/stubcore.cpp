@@ -0,0 +1,270 @@
+// A libretro core that emulates nothing. It exists so the headless driver can exercise the frontend
+// through real libretro callbacks on a host without any actual core. Everything it produces is a
+// pure function of the input it polls, so replays are bit exact. Behaviour is set through core
+// options, which the driver passes as variables before loading.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "libretro.h"
+
+#define STUB_EXPORT extern "C" __attribute__((visibility("default")))
+
+namespace {
+
+struct Config {
+    unsigned width = 320;
+    unsigned height = 240;
+    retro_pixel_format pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
+    size_t stateSize = 64 * 1024;
+    double sampleRate = 48000.0;
+    unsigned cpuLoad = 0;
+};
+
+// Serialized as is, ahead of the RAM.
+struct Header {
+    uint64_t frame;
+    uint64_t rng;
+    double audioRemainder;
+    uint32_t audioPhase;
+    uint32_t reserved;
+};
+
+const double FPS = 60.0;
+const unsigned SAMPLES_PER_FRAME_MAX = 4096;
+
+retro_environment_t environ_cb = nullptr;
+retro_video_refresh_t video_cb = nullptr;
+retro_audio_sample_batch_t audio_batch_cb = nullptr;
+retro_input_poll_t input_poll_cb = nullptr;
+retro_input_state_t input_state_cb = nullptr;
+
+Config config;
+Header header;
+std::vector<uint8_t> ram;
+std::vector<uint8_t> framebuffer;
+std::vector<int16_t> audio;
+
+const retro_variable VARIABLES[] = {
+    { "stub_width", "Frame width; 320|256|640|1280" },
+    { "stub_height", "Frame height; 240|224|480|720" },
+    { "stub_pixel_format", "Pixel format; rgb565|xrgb8888|0rgb1555" },
+    { "stub_state_size_kb", "State size in KiB; 64|16|512|2048|16384" },
+    { "stub_sample_rate", "Audio sample rate; 48000|32040|44100" },
+    { "stub_cpu_load", "Busy work per frame; 0|1000|100000|1000000" },
+    { nullptr, nullptr },
+};
+
+const char* getVariable(const char* key) {
+    retro_variable variable = { key, nullptr };
+    if (!environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &variable)) return nullptr;
+    return variable.value;
+}
+
+unsigned getUnsigned(const char* key, unsigned fallback) {
+    const char* value = getVariable(key);
+    return value ? static_cast<unsigned>(strtoul(value, nullptr, 10)) : fallback;
+}
+
+void readConfig() {
+    config.width = getUnsigned("stub_width", config.width);
+    config.height = getUnsigned("stub_height", config.height);
+    config.stateSize = std::max<size_t>(getUnsigned("stub_state_size_kb", 64) * 1024, sizeof(Header) + 64);
+    config.sampleRate = getUnsigned("stub_sample_rate", 48000);
+    config.cpuLoad = getUnsigned("stub_cpu_load", 0);
+
+    const char* format = getVariable("stub_pixel_format");
+    if (format && strcmp(format, "xrgb8888") == 0) {
+        config.pixelFormat = RETRO_PIXEL_FORMAT_XRGB8888;
+    } else if (format && strcmp(format, "0rgb1555") == 0) {
+        config.pixelFormat = RETRO_PIXEL_FORMAT_0RGB1555;
+    } else {
+        config.pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
+    }
+}
+
+unsigned bytesPerPixel() {
+    return config.pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+}
+
+inline uint64_t next(uint64_t x) {
+    return x * 6364136223846793005ull + 1442695040888963407ull;
+}
+
+void runGameLogic(const uint16_t* pads) {
+    uint64_t x = header.rng ^ (static_cast<uint64_t>(pads[0]) << 48 | static_cast<uint64_t>(pads[1]) << 32 |
+        static_cast<uint64_t>(pads[2]) << 16 | pads[3]);
+
+    // Scattered writes across RAM, like a core touching its working set.
+    for (int i = 0; i < 256; i++) {
+        x = next(x);
+        ram[(x >> 16) % ram.size()] ^= static_cast<uint8_t>(x >> 40);
+    }
+
+    for (unsigned i = 0; i < config.cpuLoad; i++) {
+        x = next(x) ^ (x >> 29);
+    }
+
+    // Fixed locations achievements and tests can watch: port 0 buttons and the frame counter.
+    ram[0] = static_cast<uint8_t>(pads[0]);
+    ram[1] = static_cast<uint8_t>(pads[0] >> 8);
+    memcpy(ram.data() + 2, &header.frame, sizeof(header.frame));
+
+    header.rng = x;
+}
+
+void renderFrame() {
+    size_t pitch = config.width * bytesPerPixel();
+    for (unsigned y = 0; y < config.height; y++) {
+        uint32_t color = static_cast<uint32_t>(header.rng >> (y % 32)) + y + static_cast<uint32_t>(header.frame);
+        uint8_t* row = framebuffer.data() + y * pitch;
+        if (bytesPerPixel() == 4) {
+            auto* pixels = reinterpret_cast<uint32_t*>(row);
+            for (unsigned x = 0; x < config.width; x++) pixels[x] = color + x;
+        } else {
+            auto* pixels = reinterpret_cast<uint16_t*>(row);
+            for (unsigned x = 0; x < config.width; x++) pixels[x] = static_cast<uint16_t>(color + x);
+        }
+    }
+    video_cb(framebuffer.data(), config.width, config.height, pitch);
+}
+
+void renderAudio() {
+    double exact = config.sampleRate / FPS + header.audioRemainder;
+    unsigned frames = std::min(static_cast<unsigned>(exact), SAMPLES_PER_FRAME_MAX);
+    header.audioRemainder = exact - frames;
+
+    // A quiet sawtooth, so resampling has something non-trivial to chew on.
+    for (unsigned i = 0; i < frames; i++) {
+        header.audioPhase += 440u * 65536u / static_cast<unsigned>(config.sampleRate);
+        auto sample = static_cast<int16_t>((header.audioPhase & 0xffff) / 8 - 4096);
+        audio[i * 2] = sample;
+        audio[i * 2 + 1] = sample;
+    }
+    if (frames > 0) audio_batch_cb(audio.data(), frames);
+}
+
+}
+
+STUB_EXPORT void retro_set_environment(retro_environment_t cb) {
+    environ_cb = cb;
+    bool noGame = true;
+    cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &noGame);
+    cb(RETRO_ENVIRONMENT_SET_VARIABLES, const_cast<retro_variable*>(VARIABLES));
+}
+
+STUB_EXPORT void retro_set_video_refresh(retro_video_refresh_t cb) { video_cb = cb; }
+STUB_EXPORT void retro_set_audio_sample(retro_audio_sample_t) { }
+STUB_EXPORT void retro_set_audio_sample_batch(retro_audio_sample_batch_t cb) { audio_batch_cb = cb; }
+STUB_EXPORT void retro_set_input_poll(retro_input_poll_t cb) { input_poll_cb = cb; }
+STUB_EXPORT void retro_set_input_state(retro_input_state_t cb) { input_state_cb = cb; }
+
+STUB_EXPORT void retro_init(void) { }
+STUB_EXPORT void retro_deinit(void) { }
+STUB_EXPORT unsigned retro_api_version(void) { return RETRO_API_VERSION; }
+
+STUB_EXPORT void retro_get_system_info(retro_system_info* info) {
+    memset(info, 0, sizeof(*info));
+    info->library_name = "Stub";
+    info->library_version = "1";
+    info->valid_extensions = "";
+    info->need_fullpath = false;
+}
+
+STUB_EXPORT void retro_get_system_av_info(retro_system_av_info* info) {
+    memset(info, 0, sizeof(*info));
+    info->geometry.base_width = config.width;
+    info->geometry.base_height = config.height;
+    info->geometry.max_width = config.width;
+    info->geometry.max_height = config.height;
+    info->geometry.aspect_ratio = static_cast<float>(config.width) / config.height;
+    info->timing.fps = FPS;
+    info->timing.sample_rate = config.sampleRate;
+}
+
+STUB_EXPORT void retro_set_controller_port_device(unsigned, unsigned) { }
+
+STUB_EXPORT void retro_reset(void) {
+    header = Header();
+    std::fill(ram.begin(), ram.end(), 0);
+}
+
+STUB_EXPORT bool retro_load_game(const retro_game_info*) {
+    readConfig();
+    if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &config.pixelFormat)) return false;
+
+    ram.assign(config.stateSize - sizeof(Header), 0);
+    framebuffer.assign(config.width * config.height * bytesPerPixel(), 0);
+    audio.assign(SAMPLES_PER_FRAME_MAX * 2, 0);
+    header = Header();
+
+    retro_memory_descriptor descriptor = {};
+    descriptor.flags = RETRO_MEMDESC_SYSTEM_RAM;
+    descriptor.ptr = ram.data();
+    descriptor.len = ram.size();
+    retro_memory_map map = { &descriptor, 1 };
+    environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &map);
+    return true;
+}
+
+STUB_EXPORT bool retro_load_game_special(unsigned, const retro_game_info*, size_t) { return false; }
+
+STUB_EXPORT void retro_unload_game(void) {
+    ram.clear();
+    framebuffer.clear();
+    audio.clear();
+}
+
+STUB_EXPORT unsigned retro_get_region(void) { return RETRO_REGION_NTSC; }
+
+STUB_EXPORT void retro_run(void) {
+    input_poll_cb();
+
+    uint16_t pads[4];
+    for (unsigned port = 0; port < 4; port++) {
+        pads[port] = static_cast<uint16_t>(
+            input_state_cb(port, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_MASK));
+    }
+
+    int enable = 3;
+    if (!environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &enable)) enable = 3;
+
+    header.frame++;
+    runGameLogic(pads);
+    if (enable & 1) {
+        renderFrame();
+    } else {
+        video_cb(nullptr, config.width, config.height, 0);
+    }
+    renderAudio();
+}
+
+STUB_EXPORT size_t retro_serialize_size(void) { return config.stateSize; }
+
+STUB_EXPORT bool retro_serialize(void* data, size_t size) {
+    if (size < config.stateSize) return false;
+    memcpy(data, &header, sizeof(header));
+    memcpy(static_cast<uint8_t*>(data) + sizeof(header), ram.data(), ram.size());
+    return true;
+}
+
+STUB_EXPORT bool retro_unserialize(const void* data, size_t size) {
+    if (size != config.stateSize) return false;
+    memcpy(&header, data, sizeof(header));
+    memcpy(ram.data(), static_cast<const uint8_t*>(data) + sizeof(header), ram.size());
+    return true;
+}
+
+STUB_EXPORT void retro_cheat_reset(void) { }
+STUB_EXPORT void retro_cheat_set(unsigned, bool, const char*) { }
+
+STUB_EXPORT void* retro_get_memory_data(unsigned id) {
+    return id == RETRO_MEMORY_SYSTEM_RAM ? ram.data() : nullptr;
+}
+
+STUB_EXPORT size_t retro_get_memory_size(unsigned id) {
+    return id == RETRO_MEMORY_SYSTEM_RAM ? ram.size() : 0;
+}
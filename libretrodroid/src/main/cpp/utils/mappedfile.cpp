@@ -0,0 +1,105 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "mappedfile.h"
+#include "../log.h"
+
+namespace libretrodroid {
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& filePath) {
+    int fileDescriptor = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0) {
+        LOGE("Cannot open %s: %s", filePath.c_str(), strerror(errno));
+        throw std::runtime_error("Cannot open game file");
+    }
+
+    try {
+        auto result = open(fileDescriptor);
+        ::close(fileDescriptor);
+        return result;
+    } catch (...) {
+        ::close(fileDescriptor);
+        throw;
+    }
+}
+
+std::unique_ptr<MappedFile> MappedFile::open(int fileDescriptor) {
+    std::unique_ptr<MappedFile> result(new MappedFile());
+
+    struct stat fileStat {};
+    if (fstat(fileDescriptor, &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > 0) {
+        auto fileSize = (size_t) fileStat.st_size;
+        void* address = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+        if (address != MAP_FAILED) {
+            madvise(address, fileSize, MADV_SEQUENTIAL);
+            madvise(address, fileSize, MADV_WILLNEED);
+            result->data = address;
+            result->size = fileSize;
+            result->mapped = true;
+            LOGD("Mapped game file of %zu bytes", fileSize);
+            return result;
+        }
+        LOGW("Cannot map game file, falling back to a heap copy: %s", strerror(errno));
+    }
+
+    uint8_t chunk[64 * 1024];
+    off_t offset = 0;
+    while (true) {
+        ssize_t count = pread(fileDescriptor, chunk, sizeof(chunk), offset);
+        if (count < 0 && errno == ESPIPE) {
+            count = read(fileDescriptor, chunk, sizeof(chunk));
+        }
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            LOGE("Cannot read game file: %s", strerror(errno));
+            throw std::runtime_error("Cannot read game file");
+        }
+        if (count == 0) {
+            break;
+        }
+        result->heapCopy.insert(result->heapCopy.end(), chunk, chunk + count);
+        offset += count;
+    }
+
+    result->data = result->heapCopy.data();
+    result->size = result->heapCopy.size();
+    return result;
+}
+
+MappedFile::~MappedFile() {
+    if (mapped && data != nullptr) {
+        munmap(data, size);
+    }
+}
+
+void MappedFile::adviseRandomAccess() {
+    if (mapped && data != nullptr) {
+        madvise(data, size, MADV_NORMAL);
+    }
+}
+
+} //namespace libretrodroid
@@ -0,0 +1,68 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_MAPPEDFILE_H
+#define LIBRETRODROID_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Owns the bytes handed to retro_load_game for cores that do not need a full path.
+ *
+ * Regular files are mapped privately, so pages are faulted in straight from the page cache and a
+ * core that patches its ROM in place only copies the pages it touches. Descriptors that cannot be
+ * mapped (pipes, some providers) fall back to a heap copy. Either way the buffer lives until the
+ * session is destroyed, since cores are allowed to keep pointers into retro_game_info.data.
+ */
+class MappedFile {
+public:
+    static std::unique_ptr<MappedFile> open(const std::string& filePath);
+    static std::unique_ptr<MappedFile> open(int fileDescriptor);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* getData() const { return data; }
+    size_t getSize() const { return size; }
+    bool isMapped() const { return mapped; }
+
+    /**
+     * Drops the sequential read-ahead hint once the core has finished loading, so that cores
+     * reading the ROM randomly during emulation do not have their pages evicted early.
+     */
+    void adviseRandomAccess();
+
+private:
+    MappedFile() = default;
+
+    void* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::vector<uint8_t> heapCopy;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_MAPPEDFILE_H
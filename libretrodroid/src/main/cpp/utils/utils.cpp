@@ -18,34 +18,13 @@
 #include <iostream>
 #include <fstream>
 #include <unistd.h>
+#include <algorithm>
 
 #include "utils.h"
 #include "../log.h"
 
 namespace libretrodroid {
 
-Utils::ReadResult Utils::readFileAsBytes(const std::string &filePath) {
-    std::ifstream fileStream(filePath);
-    fileStream.seekg(0, std::ios::end);
-    size_t size = fileStream.tellg();
-    char* bytes = new char[size];
-    fileStream.seekg(0, std::ios::beg);
-    fileStream.read(bytes, size);
-    fileStream.close();
-
-    return ReadResult { size, bytes };
-}
-
-Utils::ReadResult Utils::readFileAsBytes(const int fileDescriptor) {
-    FILE* file = fdopen(fileDescriptor, "r");
-    size_t size = getFileSize(file);
-
-    char* bytes = new char[size];
-    fread(bytes, sizeof(char), size, file);
-    close(fileDescriptor);
-    return ReadResult { size, bytes };
-}
-
 size_t Utils::getFileSize(FILE* file) {
     fseek(file, 0, SEEK_SET);
     fseek(file, 0, SEEK_END);
@@ -60,4 +39,24 @@ const char* Utils::cloneToCString(const std::string &input) {
     return result;
 }
 
+std::string Utils::getExtension(const std::string &path) {
+    auto dot = path.find_last_of('.');
+    auto separator = path.find_last_of('/');
+    if (dot == std::string::npos || (separator != std::string::npos && dot < separator)) {
+        return "";
+    }
+
+    std::string result = path.substr(dot + 1);
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    return result;
+}
+
+bool Utils::hasExtension(const char* extensionList, const std::string &extension) {
+    if (extensionList == nullptr || extension.empty()) {
+        return false;
+    }
+    std::string haystack = "|" + std::string(extensionList) + "|";
+    return haystack.find("|" + extension + "|") != std::string::npos;
+}
+
 } //namespace libretrodroid
\ No newline at end of file
@@ -22,16 +22,11 @@ namespace libretrodroid {
 
 class Utils {
 public:
-    struct ReadResult {
-        size_t size;
-        char* data;
-    };
-
-    static ReadResult readFileAsBytes(const std::string &filePath);
-    static ReadResult readFileAsBytes(const int fileDescriptor);
-
     static const char* cloneToCString(const std::string &input);
 
+    static std::string getExtension(const std::string &path);
+    static bool hasExtension(const char* extensionList, const std::string &extension);
+
     static size_t getFileSize(FILE* file);
 };
 
@@ -0,0 +1,231 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "archivereader.h"
+
+#include <linux/memfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "file/archive_file.h"
+#include "streams/file_stream.h"
+#include "../log.h"
+
+namespace libretrodroid {
+
+namespace {
+
+const uint32_t LOCAL_FILE_HEADER_SIGNATURE = 0x04034b50;
+const size_t LOCAL_FILE_HEADER_SIZE = 30;
+const size_t INFLATE_CHUNK_SIZE = 128 * 1024;
+
+enum CompressionMode {
+    COMPRESSION_STORED = 0,
+    COMPRESSION_DEFLATED = 8
+};
+
+uint32_t readLE(const uint8_t* data, size_t bytes) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        result |= (uint32_t) data[i] << (i * 8);
+    }
+    return result;
+}
+
+int createMemFD(const char* name) {
+    return (int) syscall(__NR_memfd_create, name, MFD_CLOEXEC);
+}
+
+int collectEntry(
+    const char* name,
+    const char* validExtensions,
+    const uint8_t* cdata,
+    unsigned compressionMode,
+    uint32_t compressedSize,
+    uint32_t size,
+    uint32_t crc32,
+    struct archive_extract_userdata* userdata
+) {
+    size_t nameLength = strlen(name);
+    if (nameLength == 0 || name[nameLength - 1] == '/' || name[nameLength - 1] == '\\') {
+        return 1;
+    }
+
+    auto entries = static_cast<std::vector<ArchiveReader::Entry>*>(userdata->cb_data);
+    entries->push_back(ArchiveReader::Entry {
+        name,
+        size,
+        compressedSize,
+        crc32,
+        (uint32_t) (size_t) cdata,
+        compressionMode
+    });
+    return 1;
+}
+
+} // namespace
+
+bool ArchiveReader::isArchive(int fd) {
+    uint8_t signature[4];
+    if (fd < 0 || pread(fd, signature, sizeof(signature), 0) != (ssize_t) sizeof(signature)) {
+        return false;
+    }
+    return readLE(signature, 4) == LOCAL_FILE_HEADER_SIGNATURE;
+}
+
+ArchiveReader::ArchiveReader(int fd) : fd(fd) {
+    std::string path = "/proc/self/fd/" + std::to_string(fd);
+
+    file_archive_transfer_t transfer {};
+    transfer.backend = file_archive_get_zlib_file_backend();
+    transfer.archive_file = filestream_open(
+        path.c_str(),
+        RETRO_VFS_FILE_ACCESS_READ,
+        RETRO_VFS_FILE_ACCESS_HINT_NONE
+    );
+
+    if (transfer.backend == nullptr || transfer.archive_file == nullptr) {
+        throw std::runtime_error("Cannot open archive");
+    }
+
+    transfer.archive_size = filestream_get_size(transfer.archive_file);
+
+    int result = transfer.backend->archive_parse_file_init(&transfer, path.c_str());
+    if (result == 0) {
+        struct archive_extract_userdata userdata {};
+        userdata.transfer = &transfer;
+        userdata.cb_data = &entries;
+
+        while (transfer.backend->archive_parse_file_iterate_step(
+            transfer.context, nullptr, &userdata, collectEntry) == 1) { }
+
+        transfer.backend->archive_parse_file_free(transfer.context);
+    }
+
+    filestream_close(transfer.archive_file);
+
+    if (result != 0) {
+        throw std::runtime_error("Cannot read archive directory");
+    }
+
+    LOGD("Archive contains %zu entries", entries.size());
+}
+
+int ArchiveReader::extract(const Entry& entry) const {
+    uint8_t localHeader[LOCAL_FILE_HEADER_SIZE];
+    if (!readFully(localHeader, sizeof(localHeader), entry.headerOffset)
+        || readLE(localHeader, 4) != LOCAL_FILE_HEADER_SIGNATURE) {
+        throw std::runtime_error("Invalid archive entry header");
+    }
+
+    uint64_t dataOffset = (uint64_t) entry.headerOffset + LOCAL_FILE_HEADER_SIZE
+        + readLE(localHeader + 26, 2) + readLE(localHeader + 28, 2);
+
+    int memFD = createMemFD(entry.name.c_str());
+    if (memFD < 0 || ftruncate(memFD, entry.size) != 0) {
+        LOGE("Cannot allocate memory file for %s: %s", entry.name.c_str(), strerror(errno));
+        if (memFD >= 0) close(memFD);
+        throw std::runtime_error("Cannot allocate memory file");
+    }
+
+    if (entry.size == 0) {
+        return memFD;
+    }
+
+    void* mapping = mmap(nullptr, entry.size, PROT_READ | PROT_WRITE, MAP_SHARED, memFD, 0);
+    if (mapping == MAP_FAILED) {
+        close(memFD);
+        throw std::runtime_error("Cannot map memory file");
+    }
+
+    auto output = static_cast<uint8_t*>(mapping);
+    bool success = false;
+    if (entry.compressionMode == COMPRESSION_STORED) {
+        success = entry.compressedSize == entry.size && readFully(output, entry.size, dataOffset);
+    } else if (entry.compressionMode == COMPRESSION_DEFLATED) {
+        success = inflateEntry(entry, dataOffset, output);
+    } else {
+        LOGE("Unsupported compression mode %u for %s", entry.compressionMode, entry.name.c_str());
+    }
+
+    success = success && ::crc32(0L, output, entry.size) == entry.crc32;
+    munmap(mapping, entry.size);
+
+    if (!success) {
+        close(memFD);
+        LOGE("Cannot extract archive entry %s", entry.name.c_str());
+        throw std::runtime_error("Cannot extract archive entry");
+    }
+
+    return memFD;
+}
+
+bool ArchiveReader::inflateEntry(const Entry& entry, uint64_t dataOffset, uint8_t* output) const {
+    z_stream stream {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return false;
+    }
+
+    stream.next_out = output;
+    stream.avail_out = entry.size;
+
+    std::vector<uint8_t> chunk(INFLATE_CHUNK_SIZE);
+    uint64_t consumed = 0;
+    int status = Z_OK;
+
+    while (consumed < entry.compressedSize && status != Z_STREAM_END) {
+        auto length = (size_t) std::min<uint64_t>(chunk.size(), entry.compressedSize - consumed);
+        if (!readFully(chunk.data(), length, dataOffset + consumed)) {
+            break;
+        }
+        consumed += length;
+
+        stream.next_in = chunk.data();
+        stream.avail_in = (uInt) length;
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END) {
+            break;
+        }
+    }
+
+    bool success = status == Z_STREAM_END && stream.total_out == entry.size;
+    inflateEnd(&stream);
+    return success;
+}
+
+bool ArchiveReader::readFully(uint8_t* output, size_t length, uint64_t offset) const {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t count = pread(fd, output + done, length - done, (off_t) (offset + done));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        done += count;
+    }
+    return true;
+}
+
+} //namespace libretrodroid
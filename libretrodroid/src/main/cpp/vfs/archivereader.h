@@ -0,0 +1,66 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_ARCHIVEREADER_H
+#define LIBRETRODROID_ARCHIVEREADER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libretrodroid {
+
+/**
+ * Extracts ZIP entries from a descriptor into anonymous memory, never touching storage.
+ *
+ * The central directory is walked with libretro-common's zlib archive backend. Each entry is then
+ * inflated straight into a memfd sized up front, so the decompressed bytes are written exactly once
+ * and can be mapped as retro_game_info.data or served through the VFS to need_fullpath cores.
+ */
+class ArchiveReader {
+public:
+    struct Entry {
+        std::string name;
+        uint32_t size;
+        uint32_t compressedSize;
+        uint32_t crc32;
+        uint32_t headerOffset;
+        unsigned compressionMode;
+    };
+
+    static bool isArchive(int fd);
+
+    explicit ArchiveReader(int fd);
+
+    const std::vector<Entry>& getEntries() const { return entries; }
+
+    /**
+     * Returns a new memfd holding the decompressed entry. The caller owns the descriptor.
+     */
+    int extract(const Entry& entry) const;
+
+private:
+    bool inflateEntry(const Entry& entry, uint64_t dataOffset, uint8_t* output) const;
+    bool readFully(uint8_t* output, size_t length, uint64_t offset) const;
+
+    int fd;
+    std::vector<Entry> entries;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_ARCHIVEREADER_H
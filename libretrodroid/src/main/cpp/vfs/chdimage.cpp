@@ -0,0 +1,465 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "chdimage.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "libchdr/chd.h"
+#include "../log.h"
+
+namespace libretrodroid {
+
+namespace {
+
+const char CHD_MAGIC[] = "MComprHD";
+const uint32_t CD_TRACK_PAD = 4;
+
+// libchdr is built with its zlib codecs only. It still opens images using the others and only
+// fails once a hunk compressed with them is read, so those are refused up front.
+bool hasSupportedCodecs(const chd_header* header) {
+    for (uint32_t codec : header->compression) {
+        if (header->version < 5) {
+            if (codec != CHDCOMPRESSION_NONE && codec != CHDCOMPRESSION_ZLIB && codec != CHDCOMPRESSION_ZLIB_PLUS) {
+                return false;
+            }
+            // Older versions only use the first slot.
+            break;
+        }
+        if (codec != 0 && codec != CHD_CODEC_ZLIB && codec != CHD_CODEC_CD_ZLIB) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct TrackMetadata {
+    uint32_t track = 0;
+    uint32_t frames = 0;
+    uint32_t pad = 0;
+    uint32_t pregap = 0;
+    uint32_t postgap = 0;
+    char type[64] = { 0 };
+    char subtype[32] = { 0 };
+    char pgtype[32] = { 0 };
+    char pgsub[32] = { 0 };
+};
+
+struct SectorFormat {
+    const char* chdType;
+    const char* cueType;
+    uint32_t sectorSize;
+};
+
+const SectorFormat SECTOR_FORMATS[] = {
+    { "MODE1", "MODE1/2048", 2048 },
+    { "MODE1_RAW", "MODE1/2352", 2352 },
+    { "MODE2", "MODE2/2336", 2336 },
+    { "MODE2_FORM1", "MODE2/2048", 2048 },
+    { "MODE2_FORM2", "MODE2/2324", 2324 },
+    { "MODE2_FORM_MIX", "MODE2/2336", 2336 },
+    { "MODE2_RAW", "MODE2/2352", 2352 },
+    { "AUDIO", "AUDIO", 2352 },
+};
+
+bool readTrackMetadata(chd_file* chd, uint32_t index, TrackMetadata& metadata) {
+    char buffer[256] = { 0 };
+    uint32_t resultLength = 0;
+    metadata = TrackMetadata();
+
+    if (chd_get_metadata(chd, CDROM_TRACK_METADATA2_TAG, index, buffer, sizeof(buffer) - 1,
+                         &resultLength, nullptr, nullptr) == CHDERR_NONE) {
+        sscanf(buffer, CDROM_TRACK_METADATA2_FORMAT, &metadata.track, metadata.type,
+               metadata.subtype, &metadata.frames, &metadata.pregap, metadata.pgtype,
+               metadata.pgsub, &metadata.postgap);
+        return true;
+    }
+
+    if (chd_get_metadata(chd, CDROM_TRACK_METADATA_TAG, index, buffer, sizeof(buffer) - 1,
+                         &resultLength, nullptr, nullptr) == CHDERR_NONE) {
+        sscanf(buffer, CDROM_TRACK_METADATA_FORMAT, &metadata.track, metadata.type,
+               metadata.subtype, &metadata.frames);
+        return true;
+    }
+
+    if (chd_get_metadata(chd, GDROM_TRACK_METADATA_TAG, index, buffer, sizeof(buffer) - 1,
+                         &resultLength, nullptr, nullptr) == CHDERR_NONE) {
+        sscanf(buffer, GDROM_TRACK_METADATA_FORMAT, &metadata.track, metadata.type,
+               metadata.subtype, &metadata.frames, &metadata.pad, &metadata.pregap,
+               metadata.pgtype, metadata.pgsub, &metadata.postgap);
+        return true;
+    }
+
+    return false;
+}
+
+std::string formatMSF(uint32_t frames) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%02u:%02u:%02u", frames / (60 * 75), (frames / 75) % 60, frames % 75);
+    return buffer;
+}
+
+std::string baseName(const std::string& path) {
+    auto separator = path.find_last_of('/');
+    return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+std::string stripExtension(const std::string& path) {
+    auto dot = path.find_last_of('.');
+    auto separator = path.find_last_of('/');
+    if (dot == std::string::npos || (separator != std::string::npos && dot < separator)) {
+        return path;
+    }
+    return path.substr(0, dot);
+}
+
+chd_file* openHandle(const std::string& path) {
+    chd_file* chd = nullptr;
+    chd_error error = chd_open(path.c_str(), CHD_OPEN_READ, nullptr, &chd);
+    if (error != CHDERR_NONE) {
+        LOGE("Cannot open CHD %s: %s", path.c_str(), chd_error_string(error));
+        return nullptr;
+    }
+    return chd;
+}
+
+} // namespace
+
+bool CHDImage::isCHD(int fd) {
+    char magic[sizeof(CHD_MAGIC) - 1];
+    if (fd < 0 || pread(fd, magic, sizeof(magic), 0) != (ssize_t) sizeof(magic)) {
+        return false;
+    }
+    return memcmp(magic, CHD_MAGIC, sizeof(magic)) == 0;
+}
+
+std::string CHDImage::cueSheetPath(const std::string& chdPath) {
+    return stripExtension(chdPath) + ".cue";
+}
+
+CHDImage::CHDImage(int fd, const std::string& chdPath)
+    : procPath("/proc/self/fd/" + std::to_string(fd)) {
+
+    chd_file* chd = openHandle(procPath);
+    if (chd == nullptr) {
+        throw std::runtime_error("Cannot open CHD image");
+    }
+
+    const chd_header* header = chd_get_header(chd);
+    hunkBytes = header->hunkbytes;
+    unitBytes = header->unitbytes;
+    totalHunks = header->totalhunks;
+    framesPerHunk = unitBytes > 0 ? hunkBytes / unitBytes : 0;
+
+    try {
+        if (framesPerHunk == 0) {
+            throw std::runtime_error("CHD image has an invalid hunk layout");
+        }
+        if (!hasSupportedCodecs(header)) {
+            throw std::runtime_error("CHD image uses a codec that is not built in");
+        }
+        parseTracks(chd);
+    } catch (...) {
+        chd_close(chd);
+        throw;
+    }
+
+    handles.push_back(chd);
+    buildCueSheet(chdPath);
+
+    LOGI("CHD image %s: %zu tracks, %u bytes per hunk", chdPath.c_str(), tracks.size(), hunkBytes);
+}
+
+CHDImage::~CHDImage() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (auto handle : handles) {
+        chd_close(handle);
+    }
+}
+
+void CHDImage::parseTracks(chd_file* chd) {
+    TrackMetadata metadata;
+    uint32_t frameOffset = 0;
+
+    for (uint32_t i = 0; readTrackMetadata(chd, i, metadata); ++i) {
+        auto format = std::find_if(
+            std::begin(SECTOR_FORMATS),
+            std::end(SECTOR_FORMATS),
+            [&](const SectorFormat& f) { return strcmp(f.chdType, metadata.type) == 0; }
+        );
+
+        if (format == std::end(SECTOR_FORMATS)) {
+            LOGE("Unsupported CHD track type: %s", metadata.type);
+            throw std::runtime_error("Unsupported CHD track type");
+        }
+
+        bool pregapInData = metadata.pgtype[0] == 'V';
+
+        Track track;
+        track.number = metadata.track;
+        track.type = metadata.type;
+        track.cueType = format->cueType;
+        track.chdFrame = frameOffset;
+        track.frames = metadata.frames;
+        track.pregapFrames = pregapInData ? 0 : metadata.pregap;
+        track.indexFrame = metadata.pregap;
+        track.sectorSize = format->sectorSize;
+        track.swapBytes = strcmp(metadata.type, "AUDIO") == 0;
+        tracks.push_back(track);
+
+        uint32_t padding = ((metadata.frames + CD_TRACK_PAD - 1) & ~(CD_TRACK_PAD - 1)) - metadata.frames;
+        frameOffset += metadata.frames + padding;
+    }
+
+    if (tracks.empty()) {
+        throw std::runtime_error("CHD image has no CD track metadata");
+    }
+}
+
+void CHDImage::buildCueSheet(const std::string& chdPath) {
+    std::string stem = stripExtension(chdPath);
+    cuePath = stem + ".cue";
+
+    for (const auto& track : tracks) {
+        char suffix[32];
+        if (tracks.size() == 1) {
+            snprintf(suffix, sizeof(suffix), ".bin");
+        } else {
+            snprintf(suffix, sizeof(suffix), " (Track %02u).bin", track.number);
+        }
+        std::string trackPath = stem + suffix;
+
+        char trackLine[32];
+        snprintf(trackLine, sizeof(trackLine), "  TRACK %02u ", track.number);
+
+        cueSheet += "FILE \"" + baseName(trackPath) + "\" BINARY\n";
+        cueSheet += trackLine + track.cueType + "\n";
+        if (track.indexFrame > 0) {
+            cueSheet += "    INDEX 00 00:00:00\n";
+        }
+        cueSheet += "    INDEX 01 " + formatMSF(track.indexFrame) + "\n";
+
+        trackPaths.push_back(std::move(trackPath));
+    }
+}
+
+const std::string& CHDImage::getEntryPath(int entry) const {
+    return entry == CUE_SHEET ? cuePath : trackPaths[entry];
+}
+
+uint64_t CHDImage::getEntrySize(int entry) const {
+    return entry == CUE_SHEET ? cueSheet.size() : tracks[entry].getSize();
+}
+
+int64_t CHDImage::read(int entry, uint64_t offset, void* dest, uint64_t length) {
+    uint64_t size = getEntrySize(entry);
+    if (offset >= size) {
+        return 0;
+    }
+    length = std::min(length, size - offset);
+
+    auto out = static_cast<uint8_t*>(dest);
+
+    if (entry == CUE_SHEET) {
+        memcpy(out, cueSheet.data() + offset, length);
+        return (int64_t) length;
+    }
+
+    const Track& track = tracks[entry];
+    HunkData hunkData;
+    uint32_t loadedHunk = UINT32_MAX;
+    uint64_t done = 0;
+
+    while (done < length) {
+        uint64_t position = offset + done;
+        auto frame = (uint32_t) (position / track.sectorSize);
+        auto frameOffset = (uint32_t) (position % track.sectorSize);
+        auto amount = (uint32_t) std::min<uint64_t>(track.sectorSize - frameOffset, length - done);
+
+        if (frame < track.pregapFrames) {
+            memset(out + done, 0, amount);
+        } else {
+            uint32_t chdFrame = track.chdFrame + frame - track.pregapFrames;
+            uint32_t hunk = chdFrame / framesPerHunk;
+
+            if (hunk != loadedHunk) {
+                hunkData = acquireHunk(hunk);
+                if (hunkData == nullptr) {
+                    return done > 0 ? (int64_t) done : -1;
+                }
+                loadedHunk = hunk;
+            }
+
+            const uint8_t* sector = hunkData->data() + (chdFrame % framesPerHunk) * unitBytes;
+            if (track.swapBytes) {
+                for (uint32_t i = 0; i < amount; ++i) {
+                    out[done + i] = sector[(frameOffset + i) ^ 1];
+                }
+            } else {
+                memcpy(out + done, sector + frameOffset, amount);
+            }
+        }
+
+        done += amount;
+    }
+
+    return (int64_t) done;
+}
+
+CHDImage::HunkData CHDImage::acquireHunk(uint32_t hunk) {
+    if (hunk >= totalHunks) {
+        return nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ensureWorkersLocked();
+
+    auto it = cache.find(hunk);
+    if (it == cache.end()) {
+        enqueueLocked(hunk, true);
+    } else {
+        lru.splice(lru.begin(), lru, it->second.lruPosition);
+    }
+
+    for (uint32_t i = 1; i <= PREFETCH_HUNKS && hunk + i < totalHunks; ++i) {
+        if (pendingHunks.size() >= CACHE_HUNKS / 2) break;
+        if (cache.find(hunk + i) == cache.end()) {
+            enqueueLocked(hunk + i, false);
+        }
+    }
+
+    hunkReady.wait(lock, [&]() {
+        auto entry = cache.find(hunk);
+        return entry == cache.end() || entry->second.state != HunkState::PENDING;
+    });
+
+    it = cache.find(hunk);
+    if (it == cache.end() || it->second.state == HunkState::FAILED) {
+        if (it != cache.end()) {
+            lru.erase(it->second.lruPosition);
+            cache.erase(it);
+        }
+        LOGE("Cannot decompress CHD hunk %u", hunk);
+        return nullptr;
+    }
+
+    return it->second.data;
+}
+
+void CHDImage::enqueueLocked(uint32_t hunk, bool urgent) {
+    lru.push_front(hunk);
+
+    CachedHunk entry;
+    entry.lruPosition = lru.begin();
+    cache.emplace(hunk, std::move(entry));
+
+    if (urgent) {
+        pendingHunks.push_front(hunk);
+    } else {
+        pendingHunks.push_back(hunk);
+    }
+    workAvailable.notify_one();
+
+    evictLocked();
+}
+
+void CHDImage::evictLocked() {
+    auto it = lru.end();
+    while (cache.size() > CACHE_HUNKS && it != lru.begin()) {
+        --it;
+        auto entry = cache.find(*it);
+        if (entry->second.state == HunkState::PENDING) {
+            continue;
+        }
+
+        if (entry->second.data != nullptr && entry->second.data.use_count() == 1) {
+            freeBuffers.push_back(std::move(entry->second.data));
+        }
+        cache.erase(entry);
+        it = lru.erase(it);
+    }
+}
+
+void CHDImage::ensureWorkersLocked() {
+    if (!workers.empty()) {
+        return;
+    }
+
+    unsigned workerCount = std::max(1U, std::min(MAX_WORKERS, std::thread::hardware_concurrency() / 2));
+
+    while (handles.size() < workerCount) {
+        chd_file* chd = openHandle(procPath);
+        if (chd == nullptr) break;
+        handles.push_back(chd);
+    }
+
+    for (auto handle : handles) {
+        workers.emplace_back(&CHDImage::workerLoop, this, handle);
+    }
+
+    LOGD("CHD worker pool started with %zu threads", workers.size());
+}
+
+void CHDImage::workerLoop(chd_file* chd) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        workAvailable.wait(lock, [&]() { return stopping || !pendingHunks.empty(); });
+        if (stopping) {
+            return;
+        }
+
+        uint32_t hunk = pendingHunks.front();
+        pendingHunks.pop_front();
+
+        HunkData buffer;
+        if (!freeBuffers.empty()) {
+            buffer = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+
+        lock.unlock();
+        if (buffer == nullptr) {
+            buffer = std::make_shared<std::vector<uint8_t>>(hunkBytes);
+        }
+        bool success = chd_read(chd, hunk, buffer->data()) == CHDERR_NONE;
+        lock.lock();
+
+        auto entry = cache.find(hunk);
+        if (entry != cache.end()) {
+            entry->second.state = success ? HunkState::READY : HunkState::FAILED;
+            entry->second.data = success ? std::move(buffer) : nullptr;
+        }
+        evictLocked();
+        hunkReady.notify_all();
+    }
+}
+
+} // namespace libretrodroid
@@ -0,0 +1,127 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_CHDIMAGE_H
+#define LIBRETRODROID_CHDIMAGE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+typedef struct _chd_file chd_file;
+
+namespace libretrodroid {
+
+/**
+ * Presents a CD image stored in a CHD as a cue sheet plus one raw BIN per track, so cores that only
+ * understand BIN/CUE can run compressed images straight from the file descriptor.
+ *
+ * Hunks are decompressed on a small worker pool, each worker owning its own chd_file since libchdr
+ * handles are not thread safe. Decoded hunks live in an LRU cache and every read queues the next
+ * few hunks behind the current one, so sequential streaming (FMV, CDDA) rarely waits on zlib.
+ */
+class CHDImage {
+public:
+    static constexpr int CUE_SHEET = -1;
+
+    struct Track {
+        uint32_t number;
+        std::string type;
+        std::string cueType;
+        uint32_t chdFrame;
+        uint32_t frames;
+        uint32_t pregapFrames;
+        uint32_t indexFrame;
+        uint32_t sectorSize;
+        bool swapBytes;
+
+        uint64_t getSize() const { return (uint64_t) (pregapFrames + frames) * sectorSize; }
+    };
+
+    static bool isCHD(int fd);
+    static std::string cueSheetPath(const std::string& chdPath);
+
+    CHDImage(int fd, const std::string& chdPath);
+    ~CHDImage();
+
+    CHDImage(const CHDImage&) = delete;
+    CHDImage& operator=(const CHDImage&) = delete;
+
+    const std::vector<Track>& getTracks() const { return tracks; }
+    const std::string& getEntryPath(int entry) const;
+    uint64_t getEntrySize(int entry) const;
+
+    int64_t read(int entry, uint64_t offset, void* dest, uint64_t length);
+
+private:
+    typedef std::shared_ptr<std::vector<uint8_t>> HunkData;
+
+    enum class HunkState { PENDING, READY, FAILED };
+
+    struct CachedHunk {
+        HunkState state = HunkState::PENDING;
+        HunkData data;
+        std::list<uint32_t>::iterator lruPosition;
+    };
+
+    static constexpr size_t CACHE_HUNKS = 64;
+    static constexpr uint32_t PREFETCH_HUNKS = 8;
+    static constexpr unsigned MAX_WORKERS = 4;
+
+    void parseTracks(chd_file* chd);
+    void buildCueSheet(const std::string& chdPath);
+
+    HunkData acquireHunk(uint32_t hunk);
+    void enqueueLocked(uint32_t hunk, bool urgent);
+    void evictLocked();
+    void ensureWorkersLocked();
+    void workerLoop(chd_file* chd);
+
+private:
+    std::string procPath;
+    uint32_t hunkBytes = 0;
+    uint32_t unitBytes = 0;
+    uint32_t framesPerHunk = 0;
+    uint32_t totalHunks = 0;
+
+    std::vector<Track> tracks;
+    std::vector<std::string> trackPaths;
+    std::string cuePath;
+    std::string cueSheet;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable hunkReady;
+    std::deque<uint32_t> pendingHunks;
+    std::unordered_map<uint32_t, CachedHunk> cache;
+    std::list<uint32_t> lru;
+    std::vector<HunkData> freeBuffers;
+    std::vector<chd_file*> handles;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+};
+
+} // namespace libretrodroid
+
+#endif //LIBRETRODROID_CHDIMAGE_H
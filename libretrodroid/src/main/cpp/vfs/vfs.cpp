@@ -18,7 +18,9 @@
 #include "vfs.h"
 
 #include <unistd.h>
+#include <atomic>
 #include <optional>
+#include <utility>
 
 #include "vfs/vfs_implementation.h"
 #include "../log.h"
@@ -26,6 +28,31 @@
 
 namespace libretrodroid {
 
+namespace {
+
+thread_local VFS* currentVFS = nullptr;
+std::atomic<VFS*> defaultVFS { nullptr };
+
+}
+
+VFS& VFS::getInstance() {
+    if (currentVFS != nullptr) return *currentVFS;
+
+    VFS* fallback = defaultVFS.load(std::memory_order_acquire);
+    if (fallback != nullptr) return *fallback;
+
+    static VFS instance;
+    return instance;
+}
+
+VFS* VFS::bindToCurrentThread(VFS* vfs) {
+    return std::exchange(currentVFS, vfs);
+}
+
+void VFS::setDefault(VFS* vfs) {
+    defaultVFS.store(vfs, std::memory_order_release);
+}
+
 const char *VFS::path(struct retro_vfs_file_handle* stream) {
     LOGV("VFS Calling path");
     return retro_vfs_file_get_path_impl(stream);
@@ -43,36 +70,75 @@ struct retro_vfs_file_handle* VFS::open(const char* path, unsigned int mode, uns
 
 int VFS::close(struct retro_vfs_file_handle *stream) {
     LOGV("VFS Calling close");
+    if (VFS::getInstance().closeCHDStream(stream)) {
+        return 0;
+    }
     return retro_vfs_file_close_impl(stream);
 }
 
 int64_t VFS::size(struct retro_vfs_file_handle *stream) {
     LOGV("VFS Calling size");
+    auto chdStream = VFS::getInstance().findCHDStream(stream);
+    if (chdStream != nullptr) {
+        return (int64_t) chdStream->image->getEntrySize(chdStream->entry);
+    }
     return retro_vfs_file_size_impl(stream);
 }
 
 int64_t VFS::tell(struct retro_vfs_file_handle *stream) {
     LOGV("VFS Calling tell");
+    auto chdStream = VFS::getInstance().findCHDStream(stream);
+    if (chdStream != nullptr) {
+        return chdStream->position;
+    }
     return retro_vfs_file_tell_impl(stream);
 }
 
 int64_t VFS::seek(struct retro_vfs_file_handle *stream, int64_t offset, int seek_position) {
     LOGV("VFS Calling seek");
+    auto chdStream = VFS::getInstance().findCHDStream(stream);
+    if (chdStream != nullptr) {
+        int64_t base = 0;
+        if (seek_position == RETRO_VFS_SEEK_POSITION_CURRENT) {
+            base = chdStream->position;
+        } else if (seek_position == RETRO_VFS_SEEK_POSITION_END) {
+            base = (int64_t) chdStream->image->getEntrySize(chdStream->entry);
+        }
+        if (base + offset < 0) {
+            return -1;
+        }
+        chdStream->position = base + offset;
+        return 0;
+    }
     return retro_vfs_file_seek_impl(stream, offset, seek_position);
 }
 
 int64_t VFS::read(struct retro_vfs_file_handle *stream, void *s, uint64_t len) {
     LOGV("VFS Calling read");
+    auto chdStream = VFS::getInstance().findCHDStream(stream);
+    if (chdStream != nullptr) {
+        int64_t result = chdStream->image->read(chdStream->entry, chdStream->position, s, len);
+        if (result > 0) {
+            chdStream->position += result;
+        }
+        return result;
+    }
     return retro_vfs_file_read_impl(stream, s, len);
 }
 
 int64_t VFS::write(struct retro_vfs_file_handle *stream, const void *s, uint64_t len) {
     LOGV("VFS Calling write");
+    if (VFS::getInstance().findCHDStream(stream) != nullptr) {
+        return -1;
+    }
     return retro_vfs_file_write_impl(stream, s, len);
 }
 
 int VFS::flush(struct retro_vfs_file_handle *stream) {
     LOGV("VFS Calling flush");
+    if (VFS::getInstance().findCHDStream(stream) != nullptr) {
+        return 0;
+    }
     return retro_vfs_file_flush_impl(stream);
 }
 
@@ -88,6 +154,9 @@ int VFS::rename(const char *old_path, const char *new_path) {
 
 int64_t VFS::truncate(struct retro_vfs_file_handle* stream, int64_t length) {
     LOGV("VFS Calling truncate");
+    if (VFS::getInstance().findCHDStream(stream) != nullptr) {
+        return -1;
+    }
     return retro_vfs_file_truncate_impl(stream, length);
 }
 
@@ -112,13 +181,49 @@ retro_vfs_interface * VFS::getInterface() {
 }
 
 void VFS::initialize(std::vector<VFSFile> files) {
+    std::vector<VFSFile> chdEntries;
+    for (const auto& file : files) {
+        addCHDEntries(file, chdEntries);
+    }
+
     this->virtualFiles = std::move(files);
+    for (auto& entry : chdEntries) {
+        virtualFiles.push_back(std::move(entry));
+    }
 }
 
 void VFS::deinitialize() {
+    {
+        std::lock_guard<std::mutex> lock(chdStreamsMutex);
+        for (auto& chdStream : chdStreams) {
+            free(chdStream.first->orig_path);
+            delete chdStream.first;
+        }
+        chdStreams.clear();
+    }
     virtualFiles.clear();
 }
 
+bool VFS::hasVirtualFile(const std::string& path) {
+    return findVirtualFile(path.c_str()) != nullptr;
+}
+
+void VFS::addCHDEntries(const VFSFile& file, std::vector<VFSFile>& outEntries) {
+    if (file.getCHDImage() != nullptr || !CHDImage::isCHD(file.getFD())) {
+        return;
+    }
+
+    try {
+        auto image = std::make_shared<CHDImage>(file.getFD(), file.getFileName());
+        outEntries.emplace_back(image, CHDImage::CUE_SHEET);
+        for (int i = 0; i < (int) image->getTracks().size(); ++i) {
+            outEntries.emplace_back(image, i);
+        }
+    } catch (std::exception& exception) {
+        LOGE("CHD %s cannot be presented as BIN/CUE: %s", file.getFileName().c_str(), exception.what());
+    }
+}
+
 struct retro_vfs_file_handle* VFS::virtualOpen(const char *path, unsigned int mode, unsigned int hints) {
     LOGV("VFS Calling open: %s %i", path, mode);
 
@@ -130,6 +235,10 @@ struct retro_vfs_file_handle* VFS::virtualOpen(const char *path, unsigned int mo
 
     LOGD("VFS Performing virtual file open: %s", virtualFile->getFileName().data());
 
+    if (virtualFile->getCHDImage() != nullptr) {
+        return openCHDEntry(virtualFile, hints);
+    }
+
     auto stream = new retro_vfs_file_handle;
 
     int duplicateFD = dup(virtualFile->getFD());
@@ -152,6 +261,45 @@ struct retro_vfs_file_handle* VFS::virtualOpen(const char *path, unsigned int mo
     return stream;
 }
 
+struct retro_vfs_file_handle* VFS::openCHDEntry(VFSFile* virtualFile, unsigned int hints) {
+    auto stream = new retro_vfs_file_handle;
+
+    stream->fd = -1;
+    stream->hints = hints;
+    stream->size = (int64_t) virtualFile->getCHDImage()->getEntrySize(virtualFile->getCHDEntry());
+    stream->buf = nullptr;
+    stream->fp = nullptr;
+    stream->orig_path = strdup(virtualFile->getFileName().data());
+    stream->mappos = 0;
+    stream->mapsize = 0;
+    stream->mapped = nullptr;
+    stream->scheme = VFS_SCHEME_NONE;
+
+    std::lock_guard<std::mutex> lock(chdStreamsMutex);
+    chdStreams[stream] = CHDStream { virtualFile->getCHDImage(), virtualFile->getCHDEntry(), 0 };
+
+    return stream;
+}
+
+VFS::CHDStream* VFS::findCHDStream(struct retro_vfs_file_handle* stream) {
+    std::lock_guard<std::mutex> lock(chdStreamsMutex);
+    auto it = chdStreams.find(stream);
+    return it != chdStreams.end() ? &it->second : nullptr;
+}
+
+bool VFS::closeCHDStream(struct retro_vfs_file_handle* stream) {
+    std::lock_guard<std::mutex> lock(chdStreamsMutex);
+    auto it = chdStreams.find(stream);
+    if (it == chdStreams.end()) {
+        return false;
+    }
+
+    chdStreams.erase(it);
+    free(stream->orig_path);
+    delete stream;
+    return true;
+}
+
 VFSFile* VFS::findVirtualFile(const char *path) {
     for (auto& virtualFile : virtualFiles) {
         if (strcmp(path, virtualFile.getFileName().data()) == 0) {
@@ -27,31 +27,45 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 
 namespace libretrodroid {
 
 class VFS {
 public:
     static const int SUPPORTED_VERSION = 2;
-    static VFS& getInstance()
-    {
-        static VFS instance;
-        return instance;
-    }
+
+    VFS() {}
     VFS(VFS const&) = delete;
     void operator=(VFS const&) = delete;
 
+    /** The file system bound to the calling thread, else the process default. */
+    static VFS& getInstance();
+    static VFS* bindToCurrentThread(VFS* vfs);
+    static void setDefault(VFS* vfs);
+
     static retro_vfs_interface* getInterface();
     void initialize(std::vector<VFSFile> files);
     void deinitialize();
 
+    bool hasVirtualFile(const std::string& path);
+
 private:
-    VFS() {}
+    struct CHDStream {
+        CHDImage* image;
+        int entry;
+        int64_t position;
+    };
 
     struct retro_vfs_file_handle* virtualOpen(const char *path, unsigned mode, unsigned hints);
+    struct retro_vfs_file_handle* openCHDEntry(VFSFile* virtualFile, unsigned hints);
+    void addCHDEntries(const VFSFile& file, std::vector<VFSFile>& outEntries);
 
     VFSFile* findVirtualFile(const char* path);
+    CHDStream* findCHDStream(struct retro_vfs_file_handle* stream);
+    bool closeCHDStream(struct retro_vfs_file_handle* stream);
 
 public:
 
@@ -72,6 +86,9 @@ public:
 private:
     std::vector<VFSFile> virtualFiles;
 
+    std::mutex chdStreamsMutex;
+    std::unordered_map<struct retro_vfs_file_handle*, CHDStream> chdStreams;
+
 };
 
 } // namespace libretrodroid
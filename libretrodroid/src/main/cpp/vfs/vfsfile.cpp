@@ -25,6 +25,13 @@ libretrodroid::VFSFile::VFSFile(std::string path, const int fd)
     , fd(new FDWrapper(fd))
 { }
 
+libretrodroid::VFSFile::VFSFile(std::shared_ptr<CHDImage> image, int entry)
+    : virtualPath(image->getEntryPath(entry))
+    , fd(new FDWrapper(-1))
+    , chdImage(std::move(image))
+    , chdEntry(entry)
+{ }
+
 const std::string &libretrodroid::VFSFile::getFileName() const {
     return virtualPath;
 }
@@ -32,3 +39,11 @@ const std::string &libretrodroid::VFSFile::getFileName() const {
 int libretrodroid::VFSFile::getFD() const {
     return fd->getFD();
 }
+
+libretrodroid::CHDImage* libretrodroid::VFSFile::getCHDImage() const {
+    return chdImage.get();
+}
+
+int libretrodroid::VFSFile::getCHDEntry() const {
+    return chdEntry;
+}
@@ -19,14 +19,17 @@
 #define LIBRETRODROID_VFSFILE_H
 
 #include <string>
+#include <memory>
 
 #include "fdwrapper.h"
+#include "chdimage.h"
 
 namespace libretrodroid {
 
 class VFSFile {
 public:
     VFSFile(std::string path, const int fd);
+    VFSFile(std::shared_ptr<CHDImage> image, int entry);
 
     VFSFile(VFSFile&& other) = default;
     VFSFile& operator=(VFSFile&&) = default;
@@ -38,9 +41,15 @@ public:
     const std::string& getFileName() const;
     int getFD() const;
 
+    // Entries synthesized from a CHD image have no descriptor and are served from the image.
+    CHDImage* getCHDImage() const;
+    int getCHDEntry() const;
+
 private:
     std::string virtualPath;
     std::unique_ptr<FDWrapper> fd;
+    std::shared_ptr<CHDImage> chdImage;
+    int chdEntry = CHDImage::CUE_SHEET;
 };
 
 }
@@ -29,6 +29,7 @@
 #include "libretro/libretro-common/include/libretro.h"
 
 #include "video.h"
+#include "pixelconversion.h"
 #include "renderers/es3/framebufferrenderer.h"
 #include "renderers/es3/imagerendereres3.h"
 #include "renderers/es2/imagerendereres2.h"
@@ -193,10 +194,30 @@ void Video::updateProgram() {
 }
 
 void Video::renderFrame() {
+    if (threadedVideo) {
+        FrameTripleBuffer::Frame* frame = frameTripleBuffer.consume();
+        if (frame != nullptr) {
+            uploadFrame(frame->data.data(), frame->width, frame->height, frame->pitch);
+        }
+    }
+
+    if (threadedHWRendering) {
+        HWFrameRing::Frame frame;
+        if (hwFrameRing.acquireFrame(frame)) {
+            updateHWFrameSize(frame.width, frame.height);
+            isDirty = true;
+        }
+    }
+
+    if (hwAccelerated) {
+        frameReadback.process(getHWSourceTexture(), (int) getTextureWidth(), (int) getTextureHeight());
+    }
+
     bool shaderPending = !loadedShaderType.has_value() || !(loadedShaderType.value() == requestedShaderConfig);
     if (skipDuplicateFrames && !bfiEnabled && !isDirty && !shaderPending) {
         return;
     }
+    bool frameChanged = isDirty;
     isDirty = false;
     frameCount++;
 
@@ -210,10 +231,11 @@ void Video::renderFrame() {
     glClearColor(0.0F, 0.0F, 0.0F, 1.0F);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // For HW cores, use the shared hwRenderTexture; for SW cores, use renderer texture
-    GLuint sourceTexture = (hwRenderTexture != 0)
-        ? hwRenderTexture
-        : renderer->getTexture();
+    // For HW cores, use the shared render target; for SW cores, use renderer texture
+    GLuint sourceTexture = getHWSourceTexture();
+    if (sourceTexture == 0) {
+        sourceTexture = renderer->getTexture();
+    }
 
     if (!backgroundFrame.hasImage() && immersiveModeEnabled) {
         immersiveMode.renderBackground(
@@ -221,8 +243,10 @@ void Video::renderFrame() {
             videoLayout.getScreenHeight(),
             videoLayout.getBackgroundVertices(),
             videoLayout.getRelativeForegroundBounds(),
+            videoLayout.getForegroundVertices(),
             videoLayout.getFramebufferVertices().data(),
-            sourceTexture
+            sourceTexture,
+            frameChanged
         );
     }
 
@@ -334,6 +358,10 @@ void Video::renderFrame() {
         );
         glDisable(GL_BLEND);
     }
+
+    if (threadedHWRendering) {
+        hwFrameRing.releaseDisplayedFrame();
+    }
 }
 
 float Video::getScreenDensity() {
@@ -355,27 +383,8 @@ std::vector<uint8_t> Video::captureRawFrame(int& outWidth, int& outHeight) {
             outWidth = lastFrameWidth;
             outHeight = lastFrameHeight;
             std::vector<uint8_t> rgba((size_t) outWidth * outHeight * 4);
-            for (int y = 0; y < outHeight; y++) {
-                const uint8_t* srcRow = lastFrameData.data() + (size_t) y * lastFramePitch;
-                uint8_t* dstRow = rgba.data() + (size_t) y * outWidth * 4;
-                for (int x = 0; x < outWidth; x++) {
-                    uint8_t r, g, b;
-                    if (framePixelFormat == RETRO_PIXEL_FORMAT_XRGB8888) {
-                        const uint8_t* p = srcRow + x * 4;
-                        b = p[0]; g = p[1]; r = p[2];
-                    } else if (framePixelFormat == RETRO_PIXEL_FORMAT_0RGB1555) {
-                        uint16_t p = *reinterpret_cast<const uint16_t*>(srcRow + x * 2);
-                        uint8_t r5 = (p >> 10) & 0x1F, g5 = (p >> 5) & 0x1F, b5 = p & 0x1F;
-                        r = (r5 << 3) | (r5 >> 2); g = (g5 << 3) | (g5 >> 2); b = (b5 << 3) | (b5 >> 2);
-                    } else {
-                        uint16_t p = *reinterpret_cast<const uint16_t*>(srcRow + x * 2);
-                        uint8_t r5 = (p >> 11) & 0x1F, g6 = (p >> 5) & 0x3F, b5 = p & 0x1F;
-                        r = (r5 << 3) | (r5 >> 2); g = (g6 << 2) | (g6 >> 4); b = (b5 << 3) | (b5 >> 2);
-                    }
-                    uint8_t* d = dstRow + x * 4;
-                    d[0] = r; d[1] = g; d[2] = b; d[3] = 255;
-                }
-            }
+            PixelConversion::toRGBA8888(framePixelFormat, lastFrameData.data(), lastFramePitch,
+                                        rgba.data(), (size_t) outWidth * 4, outWidth, outHeight);
             return rgba;
         }
     }
@@ -384,11 +393,15 @@ std::vector<uint8_t> Video::captureRawFrame(int& outWidth, int& outHeight) {
     outHeight = (int)getTextureHeight();
     if (outWidth == 0 || outHeight == 0) return {};
 
+    GLuint sourceTexture = getHWSourceTexture();
+    if (sourceTexture == 0) {
+        sourceTexture = renderer->getTexture();
+    }
+
     GLuint fbo;
     glGenFramebuffers(1, &fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-        GL_TEXTURE_2D, (hwRenderTexture != 0) ? hwRenderTexture : renderer->getTexture(), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sourceTexture, 0);
 
     std::vector<uint8_t> pixels(outWidth * outHeight * 4);
     glReadPixels(0, 0, outWidth, outHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
@@ -411,37 +424,75 @@ std::vector<uint8_t> Video::captureRawFrame(int& outWidth, int& outHeight) {
     return pixels;
 }
 
+int Video::requestCapture() {
+    if (!hwAccelerated) {
+        // Software frames are already in memory, there is no GPU work to wait for.
+        FrameReadback::Capture capture;
+        capture.pixels = captureRawFrame(capture.width, capture.height);
+        return frameReadback.store(std::move(capture));
+    }
+    return frameReadback.request();
+}
+
+FrameReadback::Status Video::pollCapture(int ticket, FrameReadback::Capture& capture) {
+    return frameReadback.poll(ticket, capture);
+}
+
 void Video::onNewFrame(const void *data, unsigned width, unsigned height, size_t pitch) {
     if (data != nullptr && data != RETRO_HW_FRAME_BUFFER_VALID) {
-        renderer->onNewFrame(data, width, height, pitch);
-        videoLayout.updateContentSize(width, height);
-        {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            int bytesPerPixel = framePixelFormat == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
-            size_t frameBytes = height > 0
-                ? (size_t) (height - 1) * pitch + (size_t) width * bytesPerPixel
-                : 0;
-            const auto* src = static_cast<const uint8_t*>(data);
-            lastFrameData.assign(src, src + frameBytes);
-            lastFrameWidth = (int) width;
-            lastFrameHeight = (int) height;
-            lastFramePitch = pitch;
+        if (threadedVideo) {
+            frameTripleBuffer.publish(data, width, height, pitch, PixelConversion::bytesPerPixel(framePixelFormat));
+            return;
         }
-        isDirty = true;
+        uploadFrame(data, width, height, pitch);
     } else if (data == RETRO_HW_FRAME_BUFFER_VALID) {
-        renderer->lastFrameSize = { (int)width, (int)height };
-        videoLayout.updateContentSize(width, height);
-        if (hwFBOWidth > 0 && hwFBOHeight > 0) {
-            float usedWidth = std::min(1.0f, (float)width / (float)hwFBOWidth);
-            float usedHeight = std::min(1.0f, (float)height / (float)hwFBOHeight);
-            videoLayout.setHWFrameCrop(0.0f, 1.0f - usedWidth, 0.0f, 1.0f - usedHeight);
-        } else {
-            videoLayout.setHWFrameCrop(0.0f, 0.0f, 0.0f, 0.0f);
+        if (threadedHWRendering) {
+            // Layout is only touched by the presenter, once it picks this frame up.
+            hwFrameRing.markFrame(width, height);
+            return;
         }
+        updateHWFrameSize(width, height);
         isDirty = true;
     }
 }
 
+void Video::uploadFrame(const void *data, unsigned width, unsigned height, size_t pitch) {
+    renderer->onNewFrame(data, width, height, pitch);
+    videoLayout.updateContentSize(width, height);
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        size_t bytesPerPixel = PixelConversion::bytesPerPixel(framePixelFormat);
+        size_t frameBytes = height > 0
+            ? (size_t) (height - 1) * pitch + (size_t) width * bytesPerPixel
+            : 0;
+        const auto* src = static_cast<const uint8_t*>(data);
+        lastFrameData.assign(src, src + frameBytes);
+        lastFrameWidth = (int) width;
+        lastFrameHeight = (int) height;
+        lastFramePitch = pitch;
+    }
+    isDirty = true;
+}
+
+void Video::updateHWFrameSize(unsigned width, unsigned height) {
+    renderer->lastFrameSize = { (int)width, (int)height };
+    videoLayout.updateContentSize(width, height);
+    if (hwFBOWidth > 0 && hwFBOHeight > 0) {
+        float usedWidth = std::min(1.0f, (float)width / (float)hwFBOWidth);
+        float usedHeight = std::min(1.0f, (float)height / (float)hwFBOHeight);
+        videoLayout.setHWFrameCrop(0.0f, 1.0f - usedWidth, 0.0f, 1.0f - usedHeight);
+    } else {
+        videoLayout.setHWFrameCrop(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+}
+
+GLuint Video::getHWSourceTexture() {
+    if (threadedHWRendering) {
+        return hwFrameRing.getDisplayedTexture();
+    }
+    return hwRenderTexture;
+}
+
 void Video::updateScreenSize(unsigned width, unsigned height) {
     videoLayout.updateScreenSize(width, height);
     if (hwAccelerated && eglDisplay != EGL_NO_DISPLAY) {
@@ -506,6 +557,8 @@ Video::~Video() {
     delete renderer;
     renderer = nullptr;
 
+    frameReadback.destroy();
+
     if (hwAccelerated && eglDisplay != EGL_NO_DISPLAY) {
         if (hwRenderFBO != 0) {
             glDeleteFramebuffers(1, &hwRenderFBO);
@@ -582,7 +635,7 @@ void Video::bindMainContext() {
 }
 
 void Video::initializeHWRenderContext(unsigned int width, unsigned int height,
-                                       bool useDepth, bool useStencil) {
+                                       bool useDepth, bool useStencil, bool threaded) {
     eglDisplay = eglGetCurrentDisplay();
     eglSurface = eglGetCurrentSurface(EGL_DRAW);
     mainCtx = eglGetCurrentContext();
@@ -603,8 +656,25 @@ void Video::initializeHWRenderContext(unsigned int width, unsigned int height,
     }
     LOGI("Shared EGL context created for HW core");
 
+    hwFBOWidth = width;
+    hwFBOHeight = height;
+    hwUseDepth = useDepth;
+    hwUseStencil = useStencil;
+
+    // The render thread builds its own targets once it owns the context.
+    if (threaded) return;
+
     // Switch to hw context to create the FBO
     eglMakeCurrent(eglDisplay, eglSurface, eglSurface, hwCtx);
+    createHWRenderTarget();
+
+    // Switch back to main context
+    eglMakeCurrent(eglDisplay, eglSurface, eglSurface, mainCtx);
+}
+
+void Video::createHWRenderTarget() {
+    unsigned width = hwFBOWidth;
+    unsigned height = hwFBOHeight;
 
     glGenFramebuffers(1, &hwRenderFBO);
     glGenTextures(1, &hwRenderTexture);
@@ -615,13 +685,13 @@ void Video::initializeHWRenderContext(unsigned int width, unsigned int height,
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hwRenderTexture, 0);
 
-    if (useDepth) {
+    if (hwUseDepth) {
         glGenRenderbuffers(1, &hwRenderDepthStencil);
         glBindRenderbuffer(GL_RENDERBUFFER, hwRenderDepthStencil);
         glRenderbufferStorage(GL_RENDERBUFFER,
-            useStencil ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT16, width, height);
+            hwUseStencil ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT16, width, height);
         glFramebufferRenderbuffer(GL_FRAMEBUFFER,
-            useStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+            hwUseStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
             GL_RENDERBUFFER, hwRenderDepthStencil);
     }
 
@@ -637,22 +707,72 @@ void Video::initializeHWRenderContext(unsigned int width, unsigned int height,
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    hwFBOWidth = width;
-    hwFBOHeight = height;
-    hwUseDepth = useDepth;
-    hwUseStencil = useStencil;
     LOGI("HW render FBO created: fbo=%u tex=%u %ux%u depth=%d stencil=%d",
-         hwRenderFBO, hwRenderTexture, width, height, useDepth, useStencil);
+         hwRenderFBO, hwRenderTexture, width, height, hwUseDepth, hwUseStencil);
+}
 
-    // Switch back to main context
+bool Video::attachHWContext() {
+    if (hwCtx == EGL_NO_CONTEXT) return false;
+
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, hwCtx)) {
+        LOGW("Surfaceless HW context unavailable (0x%x), keeping core on the GL thread", eglGetError());
+        return false;
+    }
+
+    if (!hwFrameRing.initialize(hwFBOWidth, hwFBOHeight, hwUseDepth, hwUseStencil)) {
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        return false;
+    }
+
+    threadedHWRendering = true;
+    return true;
+}
+
+void Video::detachHWContext() {
+    if (!threadedHWRendering) return;
+
+    hwFrameRing.destroy();
+    threadedHWRendering = false;
+    eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+void Video::disableThreadedHWRendering() {
+    if (hwCtx == EGL_NO_CONTEXT || hwRenderFBO != 0) return;
+
+    eglMakeCurrent(eglDisplay, eglSurface, eglSurface, hwCtx);
+    createHWRenderTarget();
     eglMakeCurrent(eglDisplay, eglSurface, eglSurface, mainCtx);
 }
 
+void Video::beginHWFrame() {
+    if (threadedHWRendering) {
+        hwFrameRing.beginFrame();
+    }
+}
+
+void Video::endHWFrame() {
+    if (threadedHWRendering) {
+        hwFrameRing.endFrame();
+    }
+}
+
 void Video::resizeHWRenderTarget(unsigned int width, unsigned int height) {
     if (!hwAccelerated || hwCtx == EGL_NO_CONTEXT) return;
     if (width == 0 || height == 0) return;
     if (width == hwFBOWidth && height == hwFBOHeight) return;
 
+    if (threadedHWRendering) {
+        // Called on the render thread, which already owns the core context.
+        hwFrameRing.resize(width, height);
+        hwFBOWidth = width;
+        hwFBOHeight = height;
+        LOGI("HW frame ring resized to %ux%u", width, height);
+        if (renderer != nullptr) {
+            renderer->updateRenderedResolution(width, height);
+        }
+        return;
+    }
+
     eglMakeCurrent(eglDisplay, eglSurface, eglSurface, hwCtx);
 
     glBindFramebuffer(GL_FRAMEBUFFER, hwRenderFBO);
@@ -695,7 +815,8 @@ void Video::initializeRenderer(RenderingOptions renderingOptions) {
         hwAccelerated = true;
         initializeHWRenderContext(
             renderingOptions.width, renderingOptions.height,
-            renderingOptions.useDepth, renderingOptions.useStencil
+            renderingOptions.useDepth, renderingOptions.useStencil,
+            renderingOptions.threadedHWRendering
         );
         renderer = new FramebufferRenderer(
             renderingOptions.width,
@@ -715,6 +836,7 @@ void Video::initializeRenderer(RenderingOptions renderingOptions) {
 
     renderer->setPixelFormat(renderingOptions.pixelFormat);
     framePixelFormat = renderingOptions.pixelFormat;
+    threadedVideo = renderingOptions.threadedVideo && !hwAccelerated;
     updateProgram();
 }
 
@@ -32,6 +32,9 @@
 #include "immersivemode.h"
 #include "videolayout.h"
 #include "backgroundframe.h"
+#include "hwframering.h"
+#include "frametriplebuffer.h"
+#include "framereadback.h"
 
 namespace libretrodroid {
 
@@ -46,6 +49,8 @@ public:
         bool useStencil;
         int openglESVersion;
         int pixelFormat;
+        bool threadedHWRendering = false;
+        bool threadedVideo = false;
     };
 
     struct ShaderChainEntry {
@@ -99,7 +104,15 @@ public:
 
     std::vector<uint8_t> captureRawFrame(int& outWidth, int& outHeight);
 
+    /**
+     * Asynchronous counterpart of captureRawFrame(). Hardware frames are read back over the next
+     * frames without stalling rendering; poll the returned ticket until it stops being pending.
+     */
+    int requestCapture();
+    FrameReadback::Status pollCapture(int ticket, FrameReadback::Capture& capture);
+
     uintptr_t getCurrentFramebuffer() {
+        if (threadedHWRendering) return hwFrameRing.getWriteFramebuffer();
         if (hwRenderFBO != 0) return hwRenderFBO;
         return renderer->getFramebuffer();
     };
@@ -115,6 +128,22 @@ public:
     void bindHWContext();
     void bindMainContext();
 
+    /**
+     * Makes the core context current on the calling thread, without a surface, and renders into a
+     * ring of targets from then on. Returns false if the driver cannot do surfaceless contexts, in
+     * which case the caller should fall back with disableThreadedHWRendering().
+     */
+    bool attachHWContext();
+    void detachHWContext();
+    void disableThreadedHWRendering();
+
+    bool isThreadedHWRendering() const {
+        return threadedHWRendering;
+    }
+
+    void beginHWFrame();
+    void endHWFrame();
+
     /**
      * Reallocates the hardware render target when the core raises its maximum framebuffer size,
      * which is how an internal-resolution change reaches the GPU without restarting the session.
@@ -131,7 +160,11 @@ private:
 
     void initializeRenderer(RenderingOptions renderingOptions);
     void initializeHWRenderContext(unsigned int width, unsigned int height,
-                                   bool useDepth, bool useStencil);
+                                   bool useDepth, bool useStencil, bool threaded);
+    void createHWRenderTarget();
+    void updateHWFrameSize(unsigned width, unsigned height);
+    void uploadFrame(const void *data, unsigned width, unsigned height, size_t pitch);
+    GLuint getHWSourceTexture();
 
 private:
     ShaderManager::Config requestedShaderConfig = ShaderManager::Config {
@@ -165,6 +198,10 @@ private:
     int lastFrameHeight = 0;
     size_t lastFramePitch = 0;
 
+    // Software frames produced on the emulation thread and uploaded by the GL thread.
+    bool threadedVideo = false;
+    FrameTripleBuffer frameTripleBuffer;
+
     // Shared EGL context for HW-accelerated cores
     EGLDisplay eglDisplay = EGL_NO_DISPLAY;
     EGLSurface eglSurface = EGL_NO_SURFACE;
@@ -177,6 +214,12 @@ private:
     unsigned hwFBOHeight = 0;
     bool hwUseDepth = false;
     bool hwUseStencil = false;
+
+    // Core context owned by a dedicated thread, handing frames over through the ring.
+    bool threadedHWRendering = false;
+    HWFrameRing hwFrameRing;
+
+    FrameReadback frameReadback;
 };
 
 }
@@ -0,0 +1,60 @@
+/*
+ *     Copyright (C) 2026  Argosy
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+package com.swordfish.libretrodroid;
+
+/**
+ * Outcome of LibretroDroid.runBenchmark. Frame times cover retro_run only.
+ */
+public class CoreBenchmarkResult {
+    public int frames;
+    public double elapsedMs;
+    public double emulatedFps;
+    public double frameP50Us;
+    public double frameP95Us;
+    public double frameP99Us;
+    public double frameMaxUs;
+    public long peakRssKb;
+    /** Frame rate over consecutive equal slices of the run, to spot thermal throttling. */
+    public double[] windowFps;
+    /** Change from the first slice's frame rate to the last one's, in percent. */
+    public double driftPercent;
+
+    public CoreBenchmarkResult(
+        int frames,
+        double elapsedMs,
+        double emulatedFps,
+        double frameP50Us,
+        double frameP95Us,
+        double frameP99Us,
+        double frameMaxUs,
+        long peakRssKb,
+        double[] windowFps,
+        double driftPercent
+    ) {
+        this.frames = frames;
+        this.elapsedMs = elapsedMs;
+        this.emulatedFps = emulatedFps;
+        this.frameP50Us = frameP50Us;
+        this.frameP95Us = frameP95Us;
+        this.frameP99Us = frameP99Us;
+        this.frameMaxUs = frameMaxUs;
+        this.peakRssKb = peakRssKb;
+        this.windowFps = windowFps;
+        this.driftPercent = driftPercent;
+    }
+}
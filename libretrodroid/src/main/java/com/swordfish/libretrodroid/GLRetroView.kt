@@ -23,6 +23,7 @@ import android.graphics.Bitmap
 import android.graphics.PointF
 import android.graphics.RectF
 import android.opengl.GLSurfaceView
+import android.os.ParcelFileDescriptor
 import android.util.Log
 import android.view.InputDevice
 import android.view.KeyEvent
@@ -34,6 +35,8 @@ import androidx.lifecycle.LifecycleOwner
 import androidx.lifecycle.coroutineScope
 import com.swordfish.libretrodroid.KtUtils.awaitUninterruptibly
 import com.swordfish.libretrodroid.gamepad.GamepadsManager
+import java.io.File
+import java.nio.ByteBuffer
 import java.util.*
 import java.util.concurrent.CountDownLatch
 import javax.microedition.khronos.egl.EGLConfig
@@ -139,6 +142,9 @@ class GLRetroView(
 
     private var lifecycle: Lifecycle? = null
 
+    private val pendingFrameCaptures = LinkedHashMap<Int, (Bitmap?) -> Unit>()
+    private val pendingStateWrites = LinkedHashMap<Int, (Boolean) -> Unit>()
+
     init {
         openGLESVersion = getGLESVersion(context)
         preserveEGLContextOnPause = true
@@ -186,6 +192,8 @@ class GLRetroView(
             getDeviceLanguage()
         )
         LibretroDroid.setRumbleEnabled(data.rumbleEventsEnabled)
+        LibretroDroid.setThreadedHWRendering(data.threadedHWRendering)
+        LibretroDroid.setThreadedVideo(data.threadedVideo)
     }
 
     override fun onDestroy(owner: LifecycleOwner) {
@@ -248,6 +256,80 @@ class GLRetroView(
     fun getSerializeSize(): Long = runOnGLThread {
         LibretroDroid.getSerializeSize()
     }
+
+    fun getCompressedStateBound(): Long = runOnGLThread {
+        LibretroDroid.getCompressedStateBound()
+    }
+
+    fun serializeCompressedState(buffer: ByteBuffer): Int = runOnGLThread {
+        LibretroDroid.serializeCompressedState(buffer)
+    }
+
+    fun serializeCompressedState(fd: ParcelFileDescriptor): Boolean = runOnGLThread {
+        LibretroDroid.serializeCompressedStateToFd(fd.fd)
+    }
+
+    fun unserializeCompressedState(buffer: ByteBuffer, length: Int): Boolean = runOnGLThread {
+        LibretroDroid.unserializeCompressedState(buffer, length)
+    }
+
+    fun unserializeCompressedState(fd: ParcelFileDescriptor): Boolean = runOnGLThread {
+        LibretroDroid.unserializeCompressedStateFromFd(fd.fd)
+    }
+
+    /**
+     * Saves the state into [file] without holding emulation up on I/O. The core serializes on the
+     * GL thread, a native thread writes and syncs a temporary file, and once that has replaced
+     * [file] the callback runs on the GL thread, with false if anything failed. Every write gets
+     * its own temporary file, as a second save to the same file may start before the first ends.
+     */
+    fun serializeState(file: File, callback: (Boolean) -> Unit) = queueEvent {
+        val temporary = runCatching { File.createTempFile("${file.name}.write", ".tmp", file.parentFile) }
+            .getOrNull()
+        val mode = ParcelFileDescriptor.MODE_WRITE_ONLY or ParcelFileDescriptor.MODE_TRUNCATE
+        val ticket = runCatching {
+            ParcelFileDescriptor.open(temporary!!, mode).use { LibretroDroid.serializeStateToFd(it.fd) }
+        }.getOrDefault(-1)
+
+        if (temporary == null || ticket < 0) {
+            temporary?.delete()
+            callback(false)
+        } else {
+            pendingStateWrites[ticket] = { written ->
+                val replaced = written && temporary.renameTo(file)
+                if (!replaced) temporary.delete()
+                callback(replaced)
+            }
+        }
+    }
+
+    fun unserializeState(fd: ParcelFileDescriptor): Boolean = runOnGLThread {
+        LibretroDroid.unserializeStateFromFd(fd.fd)
+    }
+
+    fun startMovieRecording(fd: ParcelFileDescriptor): Boolean = runOnGLThread {
+        LibretroDroid.startMovieRecording(fd.fd)
+    }
+
+    fun stopMovieRecording(): Boolean = runOnGLThread {
+        LibretroDroid.stopMovieRecording()
+    }
+
+    fun startMoviePlayback(fd: ParcelFileDescriptor): Boolean = runOnGLThread {
+        LibretroDroid.startMoviePlayback(fd.fd)
+    }
+
+    fun stopMoviePlayback() = runOnGLThread {
+        LibretroDroid.stopMoviePlayback()
+    }
+
+    fun getMovieState(): Int = runOnGLThread {
+        LibretroDroid.getMovieState()
+    }
+
+    fun getMovieFrame(): Long = runOnGLThread {
+        LibretroDroid.getMovieFrame()
+    }
     fun setCheat(index : Int, enable : Boolean, code : String) = runOnGLThread {
         LibretroDroid.setCheat(index, enable, code)
     }
@@ -271,6 +353,44 @@ class GLRetroView(
         LibretroDroid.unserializeSRAM(data)
     }
 
+    fun setSRAMScanInterval(frames: Int) = runOnGLThread {
+        LibretroDroid.setSRAMScanInterval(frames)
+    }
+
+    fun getSRAMDirtyPageCount(): Int = LibretroDroid.getSRAMDirtyPageCount()
+
+    /**
+     * Write the save RAM changed since the last flush into [file]. In place only the dirty pages
+     * are written, so a crash in the middle can leave a save mixing old and new pages; with
+     * [atomic] the whole of it goes to a temporary file that replaces [file] once synced, so a
+     * crash never leaves a half written save. [file] is left alone when the core has no save RAM.
+     * @return The number of bytes written, or -1 on failure
+     */
+    fun flushSRAM(file: File, atomic: Boolean = false): Long {
+        if (isDestroyed) return -1
+
+        // Each atomic flush gets its own temporary file, as an autosave and an exit may overlap.
+        val target = if (atomic) File.createTempFile("${file.name}.flush", ".tmp", file.parentFile) else file
+        val mode = ParcelFileDescriptor.MODE_READ_WRITE or ParcelFileDescriptor.MODE_CREATE or
+            (if (atomic) ParcelFileDescriptor.MODE_TRUNCATE else 0)
+        val written = ParcelFileDescriptor.open(target, mode).use { fd ->
+            runOnGLThread { LibretroDroid.flushSRAM(fd.fd) }
+        }
+
+        if (!atomic) return written
+        if (written <= 0) {
+            target.delete()
+            return if (written == 0L) 0 else -1
+        }
+        if (!target.renameTo(file)) {
+            target.delete()
+            // The pages now count as flushed although file never got them.
+            runOnGLThread { LibretroDroid.markSRAMDirty() }
+            return -1
+        }
+        return written
+    }
+
     fun getMemoryData(memoryType: Int): ByteArray? = runOnGLThread {
         LibretroDroid.getMemoryData(memoryType)
     }
@@ -283,14 +403,106 @@ class GLRetroView(
 
     fun getSystemRamSize(): Int = getMemorySize(LibretroDroid.MEMORY_SYSTEM_RAM)
 
+    /** See LibretroDroid.getMemoryGeneration: a buffer is only good while this stays the same. */
+    fun getMemoryGeneration(): Int = LibretroDroid.getMemoryGeneration()
+
+    fun getMemoryBuffer(memoryType: Int): ByteBuffer? = runOnGLThread {
+        LibretroDroid.getMemoryBuffer(memoryType)
+    }
+
+    fun getMemoryMapDescriptors(): LongArray = runOnGLThread {
+        LibretroDroid.getMemoryMapDescriptors()
+    } ?: LongArray(0)
+
+    fun getMemoryMapBuffer(index: Int): ByteBuffer? = runOnGLThread {
+        LibretroDroid.getMemoryMapBuffer(index)
+    }
+
+    fun beginMemorySearch(memoryType: Int, width: Int): Long = runOnGLThread {
+        LibretroDroid.beginMemorySearch(memoryType, width)
+    } ?: -1L
+
+    fun beginMemoryMapSearch(index: Int, width: Int): Long = runOnGLThread {
+        LibretroDroid.beginMemoryMapSearch(index, width)
+    } ?: -1L
+
+    fun filterMemorySearch(comparison: Int, againstValue: Boolean = false, value: Int = 0): Long = runOnGLThread {
+        LibretroDroid.filterMemorySearch(comparison, againstValue, value)
+    } ?: -1L
+
+    fun getMemorySearchResults(first: Int, max: Int): IntArray = runOnGLThread {
+        LibretroDroid.getMemorySearchResults(first, max)
+    } ?: IntArray(0)
+
+    fun endMemorySearch() = runOnGLThreadVoid {
+        LibretroDroid.endMemorySearch()
+    }
+
     fun captureRawFrame(): Bitmap? = runOnGLThread {
-        val data = LibretroDroid.captureRawFrame()
-        if (data == null || data.size < 8) return@runOnGLThread null
+        decodeRawFrame(LibretroDroid.captureRawFrame())
+    }
+
+    /**
+     * Times each stage of every frame. The profiler is thread safe, so this and getFrameProfile
+     * do not go through the GL thread.
+     */
+    fun setFrameProfiling(enabled: Boolean, traceSections: Boolean = false) {
+        LibretroDroid.setFrameProfiling(enabled, traceSections)
+    }
+
+    fun getFrameProfile(reset: Boolean = false): String = LibretroDroid.getFrameProfile(reset)
+
+    /**
+     * Measures how fast the core runs the current game on this device. Rendering stalls for the
+     * duration of the run.
+     */
+    fun runBenchmark(frames: Int, state: ByteArray? = null): CoreBenchmarkResult = runOnGLThread {
+        LibretroDroid.runBenchmark(frames, state)
+    }
+
+    /**
+     * Captures the current frame without stalling rendering. The callback runs on the GL thread
+     * once the readback has landed, usually a frame or two later, with null if it failed.
+     */
+    fun captureRawFrameAsync(callback: (Bitmap?) -> Unit) = queueEvent {
+        val ticket = LibretroDroid.requestFrameCapture()
+        if (ticket < 0) {
+            callback(null)
+        } else {
+            pendingFrameCaptures[ticket] = callback
+        }
+    }
+
+    private fun deliverFrameCaptures() {
+        if (pendingFrameCaptures.isEmpty()) return
+        val iterator = pendingFrameCaptures.entries.iterator()
+        while (iterator.hasNext()) {
+            val (ticket, callback) = iterator.next()
+            val data = LibretroDroid.pollFrameCapture(ticket) ?: continue
+            iterator.remove()
+            callback(decodeRawFrame(data))
+        }
+    }
+
+    private fun deliverStateWrites() {
+        if (pendingStateWrites.isEmpty()) return
+        val iterator = pendingStateWrites.entries.iterator()
+        while (iterator.hasNext()) {
+            val (ticket, callback) = iterator.next()
+            val status = LibretroDroid.pollStateWrite(ticket)
+            if (status == LibretroDroid.STATE_WRITE_PENDING) continue
+            iterator.remove()
+            callback(status == LibretroDroid.STATE_WRITE_DONE)
+        }
+    }
+
+    private fun decodeRawFrame(data: ByteArray?): Bitmap? {
+        if (data == null || data.size < 8) return null
         val bb = java.nio.ByteBuffer.wrap(data, 0, 8)
             .order(java.nio.ByteOrder.LITTLE_ENDIAN)
         val w = bb.getInt()
         val h = bb.getInt()
-        if (w <= 0 || h <= 0) return@runOnGLThread null
+        if (w <= 0 || h <= 0) return null
         val pixels = IntArray(w * h)
         for (i in 0 until w * h) {
             val offset = 8 + i * 4
@@ -300,7 +512,7 @@ class GLRetroView(
             val a = data[offset + 3].toInt() and 0xFF
             pixels[i] = (a shl 24) or (r shl 16) or (g shl 8) or b
         }
-        Bitmap.createBitmap(pixels, w, h, Bitmap.Config.ARGB_8888)
+        return Bitmap.createBitmap(pixels, w, h, Bitmap.Config.ARGB_8888)
     }
 
     fun reset() = runOnGLThread {
@@ -526,6 +738,8 @@ class GLRetroView(
 
         override fun onDrawFrame(gl: GL10) = catchExceptions {
             if (isDestroyed) return@catchExceptions
+            deliverFrameCaptures()
+            deliverStateWrites()
             val tick = netplayTick
             if (tick != null) {
                 if (isEmulationReady) {
@@ -33,6 +33,8 @@ class GLRetroViewData(context: Context) {
     var preferLowLatencyAudio: Boolean = true
     var forceSoftwareTiming: Boolean = false
     var skipDuplicateFrames: Boolean = false
+    var threadedHWRendering: Boolean = false
+    var threadedVideo: Boolean = false
     var enableMicrophone: Boolean = false
     var immersiveMode: ImmersiveMode? = null
 }
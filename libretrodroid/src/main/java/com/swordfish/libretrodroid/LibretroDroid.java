@@ -17,6 +17,7 @@
 
 package com.swordfish.libretrodroid;
 
+import java.nio.ByteBuffer;
 import java.util.List;
 
 public class LibretroDroid {
@@ -136,7 +137,76 @@ public class LibretroDroid {
     public static native boolean unserializePersistedState(byte[] state);
     public static native long getSerializeSize();
 
+    /**
+     * Upper bound in bytes of a compressed state container for the running core.
+     */
+    public static native long getCompressedStateBound();
+
+    /**
+     * Serialize and compress the current state into a direct buffer.
+     * @return The number of bytes written
+     */
+    public static native int serializeCompressedState(ByteBuffer buffer);
+    public static native boolean serializeCompressedStateToFd(int fd);
+    public static native boolean unserializeCompressedState(ByteBuffer buffer, int length);
+    public static native boolean unserializeCompressedStateFromFd(int fd);
+
+    public static final int STATE_WRITE_PENDING = 0;
+    public static final int STATE_WRITE_DONE = 1;
+    public static final int STATE_WRITE_FAILED = 2;
+
+    /**
+     * Serialize the state and write it to fd, raw as serializeState returns it, on a native
+     * thread that syncs it once written. Emulation only waits for the core to serialize. The
+     * descriptor is duplicated, so the caller may close its copy.
+     * @return A ticket for pollStateWrite, or -1 if no state was taken
+     */
+    public static native int serializeStateToFd(int fd);
+
+    /**
+     * One of STATE_WRITE_PENDING, STATE_WRITE_DONE or STATE_WRITE_FAILED. A finished write is
+     * reported once.
+     */
+    public static native int pollStateWrite(int ticket);
+    public static native boolean unserializeStateFromFd(int fd);
+
+    public static final int MOVIE_IDLE = 0;
+    public static final int MOVIE_RECORDING = 1;
+    public static final int MOVIE_PLAYING = 2;
+
+    /**
+     * Start recording an input movie into fd: the current state, then the input of every frame
+     * that follows. The descriptor is duplicated, so the caller may close its copy. Frames run
+     * while rewinding are not recorded.
+     */
+    public static native boolean startMovieRecording(int fd);
+
+    /**
+     * Terminate and close the movie being recorded.
+     * @return False if the movie could not be written completely
+     */
+    public static native boolean stopMovieRecording();
+
+    /**
+     * Load the state a movie starts from and feed its input to the core from the next frame on.
+     * Live input is ignored until the movie ends or playback is stopped.
+     */
+    public static native boolean startMoviePlayback(int fd);
+    public static native void stopMoviePlayback();
+
+    /**
+     * One of MOVIE_IDLE, MOVIE_RECORDING or MOVIE_PLAYING.
+     */
+    public static native int getMovieState();
+
+    /**
+     * Frames recorded or played back so far.
+     */
+    public static native long getMovieFrame();
+
     public static native byte[] captureRawFrame();
+    public static native int requestFrameCapture();
+    public static native byte[] pollFrameCapture(int ticket);
 
     public static native void setCheat(int index, boolean enable, String code);
     public static native void resetCheat();
@@ -144,6 +214,30 @@ public class LibretroDroid {
     public static native byte[] serializeSRAM();
     public static native boolean unserializeSRAM(byte[] sram);
 
+    /**
+     * Compare save RAM with what was last flushed every given number of frames, so
+     * getSRAMDirtyPageCount stays current without waiting for the core. 0 disables it.
+     */
+    public static native void setSRAMScanInterval(int frames);
+
+    /**
+     * Save RAM pages changed since the last flush or load, as of the last scan.
+     */
+    public static native int getSRAMDirtyPageCount();
+
+    /**
+     * Write the save RAM pages changed since the last flush or load into fd and sync it. A file
+     * of any other size than the save RAM, such as an empty temporary one, gets all of it.
+     * @return The number of bytes written, or -1 on failure
+     */
+    public static native long flushSRAM(int fd);
+
+    /**
+     * Forget what earlier flushes wrote, so the next flushSRAM writes all of the save RAM. For
+     * when a flushed file did not end up where it was meant to.
+     */
+    public static native void markSRAMDirty();
+
     public static final int MEMORY_SAVE_RAM = 0;
     public static final int MEMORY_RTC = 1;
     public static final int MEMORY_SYSTEM_RAM = 2;
@@ -152,6 +246,54 @@ public class LibretroDroid {
     public static native byte[] getMemoryData(int memoryType);
     public static native int getMemorySize(int memoryType);
 
+    /**
+     * Changes whenever a game is loaded or unloaded. Buffers from getMemoryBuffer and
+     * getMemoryMapBuffer belong to the generation they were taken in and must not be read after.
+     */
+    public static native int getMemoryGeneration();
+
+    /**
+     * A read-only view of the core's memory, without copying. Values change as the game runs.
+     * @return null when the core does not expose memoryType
+     */
+    public static native ByteBuffer getMemoryBuffer(int memoryType);
+
+    /**
+     * The memory map the core set, as start address, length and flags for each descriptor.
+     * Descriptors the core gave no pointer for have length 0.
+     */
+    public static native long[] getMemoryMapDescriptors();
+
+    /** A read-only view of the memory behind the descriptor at index, or null. */
+    public static native ByteBuffer getMemoryMapBuffer(int index);
+
+    public static final int SEARCH_EQUAL = 0;
+    public static final int SEARCH_NOT_EQUAL = 1;
+    public static final int SEARCH_GREATER = 2;
+    public static final int SEARCH_LESS = 3;
+
+    /**
+     * Start a search over every aligned value of width 1, 2 or 4 bytes in memoryType,
+     * snapshotting it for the first filter.
+     * @return The number of candidates, or -1 if there is no such memory or width
+     */
+    public static native long beginMemorySearch(int memoryType, int width);
+
+    /** Like beginMemorySearch, over the memory map descriptor at index. */
+    public static native long beginMemoryMapSearch(int index, int width);
+
+    /**
+     * Keep the candidates whose value compares as asked with the previous pass, or with value
+     * when againstValue is set. Values are unsigned and in host byte order.
+     * @return The candidates left, or -1 if there is no search or the game changed since it began
+     */
+    public static native long filterMemorySearch(int comparison, boolean againstValue, int value);
+
+    /** Byte offsets of up to max candidates, starting with the first-th. */
+    public static native int[] getMemorySearchResults(int first, int max);
+
+    public static native void endMemorySearch();
+
     public static native void updateVariable(Variable variable);
     public static native Variable[] getVariables();
 
@@ -178,6 +320,37 @@ public class LibretroDroid {
     public static native float getRewindBufferUsage();
     public static native int getRewindBufferValidCount();
 
+    /**
+     * Run hardware-accelerated cores on a dedicated render thread, pipelining emulation of the
+     * next frame with presentation of the current one. Takes effect on the next surface creation.
+     */
+    public static native void setThreadedHWRendering(boolean enabled);
+
+    /**
+     * Run software cores on a dedicated emulation thread. Frames reach the GL thread through a
+     * triple buffer, so shader cost no longer adds to emulation time. Takes effect on the next
+     * surface creation.
+     */
+    public static native void setThreadedVideo(boolean enabled);
+
+    /**
+     * Start or stop timing the stages of every frame. Enabling clears previous samples. With
+     * traceSections the stages are also emitted as systrace sections.
+     */
+    public static native void setFrameProfiling(boolean enabled, boolean traceSections);
+
+    /**
+     * Per-stage frame-time histograms and the most recent samples, as JSON.
+     */
+    public static native String getFrameProfile(boolean reset);
+
+    /**
+     * Run the loaded game for the given number of frames as fast as possible, without presenting
+     * video or playing audio, optionally starting from a state. The game keeps the frames it ran.
+     * Blocks until done, so call it from the GL thread.
+     */
+    public static native CoreBenchmarkResult runBenchmark(int frames, byte[] state);
+
     public static native void setRewindEnabled(boolean enabled);
     public static native void setRewinding(boolean active);
     public static native void setRewindSpeed(int speed);
@@ -198,6 +371,48 @@ public class LibretroDroid {
      */
     public static native int runStateLoadPolicyTests();
 
+    /**
+     * Run native compressed save-state container tests.
+     * @return Number of tests that passed
+     */
+    public static native int runStateContainerTests();
+
+    /**
+     * Run native pixel format conversion tests.
+     * @return Number of tests that passed
+     */
+    public static native int runPixelConversionTests();
+
+    /**
+     * Run native input movie tests.
+     * @return Number of tests that passed
+     */
+    public static native int runInputMovieTests();
+
+    /**
+     * Run native save RAM dirty tracking tests.
+     * @return Number of tests that passed
+     */
+    public static native int runSramTrackerTests();
+
+    /**
+     * Run native background state writer tests.
+     * @return Number of tests that passed
+     */
+    public static native int runStateWriterTests();
+
+    /**
+     * Run native memory search tests.
+     * @return Number of tests that passed
+     */
+    public static native int runMemorySearchTests();
+
+    /**
+     * Run native immersive background blur schedule tests.
+     * @return Number of tests that passed
+     */
+    public static native int runBlurScheduleTests();
+
     /**
      * Compute the RetroAchievements hash for a ROM file.
      * @param romPath The path to the ROM file
@@ -205,4 +420,27 @@ public class LibretroDroid {
      * @return The 32-character MD5 hash, or null if hashing failed
      */
     public static native String computeRomHash(String romPath, int consoleId);
+
+    public interface RomHashProgressListener {
+        void onProgress(int completed, int total);
+    }
+
+    /**
+     * Compute RetroAchievements hashes for many ROM files on a bounded pool of native threads.
+     * Results are memoized in cachePath keyed by path, size, mtime and console, so unchanged files
+     * are not re-read. The listener is invoked on the calling thread.
+     * @param romPaths The paths of the ROM files
+     * @param consoleIds The RA console ID for each path
+     * @param cachePath File used to persist hashes between calls, or null to disable caching
+     * @param maxThreads Upper bound on worker threads, or 0 for the default
+     * @param listener Optional progress listener
+     * @return One hash per path, with null entries where hashing failed
+     */
+    public static native String[] computeRomHashes(
+        String[] romPaths,
+        int[] consoleIds,
+        String cachePath,
+        int maxThreads,
+        RomHashProgressListener listener
+    );
 }